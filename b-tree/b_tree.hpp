@@ -0,0 +1,754 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "utility/node_handle.hpp"
+
+// In-memory B-tree with the interface RbTree exposes to map/set. Each node keeps up to kSlots
+// values in one contiguous array, sized so a node spans about NodeBytes, so a lookup touches
+// log_B(n) nodes instead of log2(n) and in-order scans walk whole cache lines. Internal nodes
+// hold values too, followed by kSlots + 1 child pointers.
+//
+// Unlike RbTree, inserts and erases move other values between nodes, so they invalidate every
+// iterator; `erase` returns an iterator to the value that followed the erased one. Values are
+// relocated by move-construct + destroy, which is assumed not to throw.
+template <typename Value, typename KeyOfValue, typename Compare, bool Multi,
+          std::size_t NodeBytes = 256>
+class BTree {
+public:
+  class iterator;
+  class const_iterator;
+
+  using value_type = Value;
+  using size_type = std::size_t;
+  // Values live inside shared nodes, so a handle carries the value itself.
+  using node_type = value_handle<Value>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+  BTree() : root_(nullptr), size_(0), comp_(), key_of_() {}
+  explicit BTree(Compare comp) : root_(nullptr), size_(0), comp_(std::move(comp)), key_of_() {}
+
+  BTree(const BTree&) = delete;
+  BTree& operator=(const BTree&) = delete;
+
+  BTree(BTree&& other) noexcept
+      : root_(std::exchange(other.root_, nullptr)), size_(std::exchange(other.size_, 0)),
+        comp_(std::move(other.comp_)), key_of_() {}
+
+  BTree& operator=(BTree&& other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    root_ = std::exchange(other.root_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    comp_ = std::move(other.comp_);
+    return *this;
+  }
+
+  ~BTree() {
+    clear();
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  iterator begin() noexcept {
+    return iterator(leftmost(root_), 0, this);
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(leftmost(root_), 0, this);
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  iterator end() noexcept {
+    return iterator(nullptr, 0, this);
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(nullptr, 0, this);
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  void clear() noexcept {
+    destroy_subtree(root_);
+    root_ = nullptr;
+    size_ = 0;
+  }
+
+  template <typename Key> iterator find(const Key& key) noexcept {
+    const auto [node, i] = find_position(key);
+    return iterator(node, i, this);
+  }
+  template <typename Key> const_iterator find(const Key& key) const noexcept {
+    const auto [node, i] = find_position(key);
+    return const_iterator(node, i, this);
+  }
+
+  template <typename Key> iterator lower_bound(const Key& key) noexcept {
+    const auto [node, i] = lower_bound_position(key);
+    return iterator(node, i, this);
+  }
+  template <typename Key> const_iterator lower_bound(const Key& key) const noexcept {
+    const auto [node, i] = lower_bound_position(key);
+    return const_iterator(node, i, this);
+  }
+
+  template <typename Key> iterator upper_bound(const Key& key) noexcept {
+    const auto [node, i] = upper_bound_position(key);
+    return iterator(node, i, this);
+  }
+  template <typename Key> const_iterator upper_bound(const Key& key) const noexcept {
+    const auto [node, i] = upper_bound_position(key);
+    return const_iterator(node, i, this);
+  }
+
+  std::pair<iterator, bool> insert_unique(value_type value) {
+    if (!root_)
+      root_ = new_leaf();
+    Node* n = root_;
+    const auto& k = key_of_(value);
+    while (true) {
+      const size_type i = lower_index(n, k);
+      if (i < n->count && !comp_(k, key_of_(*n->slot(i))))
+        return {iterator(n, i, this), false};
+      if (n->leaf)
+        return {insert_leaf(n, i, std::move(value)), true};
+      n = child(n, i);
+    }
+  }
+
+  // Equal keys keep insertion order: the new value goes after every value equal to it.
+  iterator insert_multi(value_type value) {
+    if (!root_)
+      root_ = new_leaf();
+    Node* n = root_;
+    const auto& k = key_of_(value);
+    while (true) {
+      const size_type i = upper_index(n, k);
+      if (n->leaf)
+        return insert_leaf(n, i, std::move(value));
+      n = child(n, i);
+    }
+  }
+
+  // Replaces the contents with [first, last), which must already be sorted (strictly, unless
+  // Multi). Each value is appended to the rightmost leaf, so the cost is O(1) amortized per
+  // value and every leaf but the last ends up full. Throws std::invalid_argument, leaving the
+  // tree empty, on unsorted input.
+  template <std::forward_iterator It> void assign_sorted(It first, It last) {
+    clear();
+    Node* tail = nullptr;
+    try {
+      for (; first != last; ++first) {
+        value_type value(*first);
+        if (tail) {
+          const auto& prev = key_of_(*tail->slot(tail->count - 1));
+          if (Multi ? comp_(key_of_(value), prev) : !comp_(prev, key_of_(value)))
+            throw std::invalid_argument("BTree::assign_sorted: input is not sorted");
+        } else {
+          root_ = tail = new_leaf();
+        }
+        tail = insert_leaf(tail, tail->count, std::move(value)).node_;
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  // Moves the value at `pos` into a handle and erases its slot.
+  node_type extract(const_iterator pos) {
+    iterator it(pos.node_, pos.position_, this);
+    node_type nh(std::in_place, std::move(*it));
+    erase(it);
+    return nh;
+  }
+
+  insert_return_type insert_unique(node_type&& nh) {
+    if (nh.empty())
+      return {end(), false, node_type()};
+    if (auto it = find(key_of_(nh.element())); it != end())
+      return {it, false, std::move(nh)};
+    return {insert_unique(nh.take()).first, true, node_type()};
+  }
+
+  iterator insert_multi(node_type&& nh) {
+    return nh.empty() ? end() : insert_multi(nh.take());
+  }
+
+  // Moves each value of `source` (a BTree with the same value type) over, except, if keys are
+  // unique here, those whose key is already present. Values are moved one by one.
+  template <typename Tree>
+    requires std::same_as<typename Tree::node_type, node_type>
+  void merge(Tree& source) {
+    if (static_cast<const void*>(&source) == this)
+      return;
+    for (auto it = source.begin(); it != source.end();) {
+      if (!Multi && find(key_of_(*it)) != end()) {
+        ++it;
+        continue;
+      }
+      if constexpr (Multi)
+        insert_multi(std::move(*it));
+      else
+        insert_unique(std::move(*it));
+      it = source.erase(it);
+    }
+  }
+
+  iterator erase(iterator pos) {
+    Node* node = pos.node_;
+    size_type i = pos.position_;
+    const bool internal = !node->leaf;
+    if (internal) {
+      // Refill the slot with the in-order predecessor, the last value of the rightmost leaf in
+      // the left subtree, and remove that leaf slot instead.
+      Node* leaf = rightmost(child(node, i));
+      std::destroy_at(node->slot(i));
+      relocate(node->slot(i), leaf->slot(leaf->count - 1));
+      --leaf->count;
+      node = leaf;
+      i = leaf->count;
+    } else {
+      std::destroy_at(node->slot(i));
+      for (size_type j = i; j + 1 < node->count; ++j)
+        relocate(node->slot(j), node->slot(j + 1));
+      --node->count;
+    }
+    --size_;
+
+    // (node, i) now marks the gap the erased value left, so the next value in order is at or
+    // after it; rebalancing keeps it pointing there while values move between nodes.
+    rebalance_after_erase(node, i);
+    if (!root_)
+      return end();
+    while (node && i == node->count) {
+      i = node->position;
+      node = node->parent;
+    }
+    if (internal)
+      increment(node, i); // Step over the predecessor that took the erased value's place.
+    return iterator(node, node ? i : 0, this);
+  }
+
+private:
+  using count_type = std::uint16_t;
+
+  static constexpr size_type kHeaderBytes = 2 * sizeof(void*);
+  static constexpr size_type kSlots = std::clamp<size_type>(
+      NodeBytes > kHeaderBytes ? (NodeBytes - kHeaderBytes) / sizeof(Value) : 0, 3, 4096);
+  // Nodes other than the root hold at least this many values once an erase has rebalanced.
+  static constexpr size_type kMinCount = kSlots / 2;
+
+  struct Node {
+    Node* parent = nullptr;
+    count_type position = 0; // Index of this node in parent's children.
+    count_type count = 0;
+    bool leaf = true;
+    alignas(Value) std::byte storage[kSlots * sizeof(Value)];
+
+    Value* slot(size_type i) noexcept {
+      return reinterpret_cast<Value*>(storage + i * sizeof(Value));
+    }
+  };
+
+  struct InternalNode : Node {
+    Node* children[kSlots + 1];
+  };
+
+  Node* root_;
+  size_type size_;
+  Compare comp_;
+  KeyOfValue key_of_;
+
+  static Node* new_leaf() {
+    return new Node;
+  }
+  static Node* new_internal() {
+    auto* n = new InternalNode;
+    n->leaf = false;
+    return n;
+  }
+  static void delete_node(Node* n) noexcept {
+    if (n->leaf)
+      delete n;
+    else
+      delete static_cast<InternalNode*>(n);
+  }
+
+  static Node* child(Node* n, size_type i) noexcept {
+    return static_cast<InternalNode*>(n)->children[i];
+  }
+  static void set_child(Node* n, size_type i, Node* c) noexcept {
+    static_cast<InternalNode*>(n)->children[i] = c;
+    c->parent = n;
+    c->position = static_cast<count_type>(i);
+  }
+
+  static void relocate(Value* dst, Value* src) noexcept {
+    std::construct_at(dst, std::move(*src));
+    std::destroy_at(src);
+  }
+
+  static Node* leftmost(Node* n) noexcept {
+    if (!n)
+      return nullptr;
+    while (!n->leaf)
+      n = child(n, 0);
+    return n;
+  }
+  static Node* rightmost(Node* n) noexcept {
+    while (!n->leaf)
+      n = child(n, n->count);
+    return n;
+  }
+
+  static void increment(Node*& node, size_type& i) noexcept {
+    if (!node->leaf) {
+      node = leftmost(child(node, i + 1));
+      i = 0;
+      return;
+    }
+    if (++i < node->count)
+      return;
+    while (node && i == node->count) {
+      i = node->position;
+      node = node->parent;
+    }
+    if (!node)
+      i = 0;
+  }
+
+  static void decrement(Node*& node, size_type& i) noexcept {
+    if (!node->leaf) {
+      node = rightmost(child(node, i));
+      i = node->count - 1;
+      return;
+    }
+    while (i == 0 && node->parent) {
+      i = node->position;
+      node = node->parent;
+    }
+    --i;
+  }
+
+  template <typename Key> size_type lower_index(Node* n, const Key& key) const {
+    size_type lo = 0;
+    size_type hi = n->count;
+    while (lo < hi) {
+      const size_type mid = (lo + hi) / 2;
+      if (comp_(key_of_(*n->slot(mid)), key))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  template <typename Key> size_type upper_index(Node* n, const Key& key) const {
+    size_type lo = 0;
+    size_type hi = n->count;
+    while (lo < hi) {
+      const size_type mid = (lo + hi) / 2;
+      if (comp_(key, key_of_(*n->slot(mid))))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return lo;
+  }
+
+  // Deepest node whose separator satisfies the bound; values further down are smaller.
+  template <typename Key> std::pair<Node*, size_type> lower_bound_position(const Key& key) const {
+    Node* found = nullptr;
+    size_type found_at = 0;
+    for (Node* n = root_; n;) {
+      const size_type i = lower_index(n, key);
+      if (i < n->count) {
+        found = n;
+        found_at = i;
+      }
+      n = n->leaf ? nullptr : child(n, i);
+    }
+    return {found, found_at};
+  }
+
+  template <typename Key> std::pair<Node*, size_type> upper_bound_position(const Key& key) const {
+    Node* found = nullptr;
+    size_type found_at = 0;
+    for (Node* n = root_; n;) {
+      const size_type i = upper_index(n, key);
+      if (i < n->count) {
+        found = n;
+        found_at = i;
+      }
+      n = n->leaf ? nullptr : child(n, i);
+    }
+    return {found, found_at};
+  }
+
+  template <typename Key> std::pair<Node*, size_type> find_position(const Key& key) const {
+    if constexpr (Multi) {
+      const auto [node, i] = lower_bound_position(key);
+      if (node && !comp_(key, key_of_(*node->slot(i))))
+        return {node, i};
+      return {nullptr, 0};
+    } else {
+      for (Node* n = root_; n;) {
+        const size_type i = lower_index(n, key);
+        if (i < n->count && !comp_(key, key_of_(*n->slot(i))))
+          return {n, i};
+        n = n->leaf ? nullptr : child(n, i);
+      }
+      return {nullptr, 0};
+    }
+  }
+
+  // Shifts values [i, count) and, for internal nodes, children (i, count] up by one, leaving
+  // slot i unconstructed for the caller to fill.
+  static void open_slot(Node* n, size_type i) noexcept {
+    for (size_type j = n->count; j > i; --j)
+      relocate(n->slot(j), n->slot(j - 1));
+    if (!n->leaf) {
+      for (size_type j = n->count + 1; j > i + 1; --j)
+        set_child(n, j, child(n, j - 1));
+    }
+    ++n->count;
+  }
+
+  iterator insert_leaf(Node* n, size_type i, value_type value) {
+    if (n->count == kSlots)
+      split(n, i);
+    open_slot(n, i);
+    std::construct_at(n->slot(i), std::move(value));
+    ++size_;
+    return iterator(n, i, this);
+  }
+
+  // Splits a full node around a median that moves up into the parent (splitting that first if
+  // it is full too), then points (node, pos) at the half where position `pos` now lives.
+  void split(Node*& node, size_type& pos) {
+    Node* parent = node->parent;
+    if (!parent) {
+      parent = new_internal();
+      set_child(parent, 0, node);
+      root_ = parent;
+    } else if (parent->count == kSlots) {
+      size_type at = node->position;
+      split(parent, at);
+      parent = node->parent;
+    }
+
+    // Appending or prepending leaves the untouched half full, so sorted input packs nodes.
+    const size_type mid = pos == kSlots ? kSlots - 1 : pos == 0 ? 0 : kSlots / 2;
+    Node* right = node->leaf ? new_leaf() : new_internal();
+    const size_type moved = node->count - mid - 1;
+    for (size_type j = 0; j < moved; ++j)
+      relocate(right->slot(j), node->slot(mid + 1 + j));
+    if (!node->leaf) {
+      for (size_type j = 0; j <= moved; ++j)
+        set_child(right, j, child(node, mid + 1 + j));
+    }
+    right->count = static_cast<count_type>(moved);
+
+    const size_type at = node->position;
+    open_slot(parent, at);
+    relocate(parent->slot(at), node->slot(mid));
+    set_child(parent, at + 1, right);
+    node->count = static_cast<count_type>(mid);
+
+    if (pos > mid) {
+      node = right;
+      pos -= mid + 1;
+    }
+  }
+
+  // Restores the minimum fill from `node` upwards after one of its values was removed, and
+  // shrinks the root when it runs out of values. (node, pos) is updated to the same gap.
+  void rebalance_after_erase(Node*& node, size_type& pos) noexcept {
+    Node* n = node;
+    size_type p = pos;
+    bool first = true;
+    while (n != root_ && n->count < kMinCount) {
+      const bool merged = merge_or_borrow(n, p);
+      if (first) {
+        node = n;
+        pos = p;
+        first = false;
+      }
+      if (!merged)
+        break;
+      p = n->position;
+      n = n->parent;
+    }
+
+    if (root_->count == 0) {
+      Node* old = root_;
+      if (old->leaf) {
+        root_ = nullptr;
+      } else {
+        root_ = child(old, 0);
+        root_->parent = nullptr;
+        root_->position = 0;
+      }
+      delete_node(old);
+    }
+  }
+
+  // Merges an underfull node with a sibling when both fit in one node, else moves values over
+  // from the fuller sibling. Returns true on a merge, since the parent then lost a value.
+  bool merge_or_borrow(Node*& n, size_type& p) noexcept {
+    Node* parent = n->parent;
+    const size_type at = n->position;
+    if (at > 0) {
+      Node* left = child(parent, at - 1);
+      if (size_type{1} + left->count + n->count <= kSlots) {
+        p += 1 + left->count;
+        merge(left, n);
+        n = left;
+        return true;
+      }
+    }
+    if (at < parent->count) {
+      Node* right = child(parent, at + 1);
+      if (size_type{1} + n->count + right->count <= kSlots) {
+        merge(n, right);
+        return true;
+      }
+      if (right->count > kMinCount) {
+        borrow_from_right(n, right, std::max<size_type>((right->count - n->count) / 2, 1));
+        return false;
+      }
+    }
+    if (at > 0) {
+      Node* left = child(parent, at - 1);
+      const size_type k = std::max<size_type>((left->count - n->count) / 2, 1);
+      borrow_from_left(left, n, k);
+      p += k;
+    }
+    return false;
+  }
+
+  // Appends the separator and all of `right` to `left`, then drops both from the parent.
+  static void merge(Node* left, Node* right) noexcept {
+    Node* parent = left->parent;
+    const size_type at = left->position;
+    const size_type base = left->count;
+    relocate(left->slot(base), parent->slot(at));
+    for (size_type j = 0; j < right->count; ++j)
+      relocate(left->slot(base + 1 + j), right->slot(j));
+    if (!left->leaf) {
+      for (size_type j = 0; j <= right->count; ++j)
+        set_child(left, base + 1 + j, child(right, j));
+    }
+    left->count = static_cast<count_type>(base + 1 + right->count);
+
+    for (size_type j = at; j + 1 < parent->count; ++j)
+      relocate(parent->slot(j), parent->slot(j + 1));
+    for (size_type j = at + 1; j < parent->count; ++j)
+      set_child(parent, j, child(parent, j + 1));
+    --parent->count;
+    right->count = 0;
+    delete_node(right);
+  }
+
+  // Rotates k values from the front of `right` through the parent separator into `n`.
+  static void borrow_from_right(Node* n, Node* right, size_type k) noexcept {
+    Node* parent = n->parent;
+    const size_type at = n->position;
+    const size_type base = n->count;
+    relocate(n->slot(base), parent->slot(at));
+    for (size_type j = 0; j + 1 < k; ++j)
+      relocate(n->slot(base + 1 + j), right->slot(j));
+    relocate(parent->slot(at), right->slot(k - 1));
+    if (!n->leaf) {
+      for (size_type j = 0; j < k; ++j)
+        set_child(n, base + 1 + j, child(right, j));
+    }
+
+    const size_type rest = right->count - k;
+    for (size_type j = 0; j < rest; ++j)
+      relocate(right->slot(j), right->slot(j + k));
+    if (!right->leaf) {
+      for (size_type j = 0; j <= rest; ++j)
+        set_child(right, j, child(right, j + k));
+    }
+    n->count = static_cast<count_type>(base + k);
+    right->count = static_cast<count_type>(rest);
+  }
+
+  // Rotates k values from the back of `left` through the parent separator into `n`.
+  static void borrow_from_left(Node* left, Node* n, size_type k) noexcept {
+    Node* parent = n->parent;
+    const size_type at = left->position;
+    const size_type keep = left->count - k;
+    for (size_type j = n->count; j > 0; --j)
+      relocate(n->slot(j - 1 + k), n->slot(j - 1));
+    if (!n->leaf) {
+      for (size_type j = n->count + 1; j > 0; --j)
+        set_child(n, j - 1 + k, child(n, j - 1));
+    }
+    relocate(n->slot(k - 1), parent->slot(at));
+    for (size_type j = 0; j + 1 < k; ++j)
+      relocate(n->slot(j), left->slot(keep + 1 + j));
+    relocate(parent->slot(at), left->slot(keep));
+    if (!n->leaf) {
+      for (size_type j = 0; j < k; ++j)
+        set_child(n, j, child(left, keep + 1 + j));
+    }
+    n->count = static_cast<count_type>(n->count + k);
+    left->count = static_cast<count_type>(keep);
+  }
+
+  static void destroy_subtree(Node* n) noexcept {
+    if (!n)
+      return;
+    std::destroy_n(n->slot(0), n->count);
+    if (!n->leaf) {
+      for (size_type j = 0; j <= n->count; ++j)
+        destroy_subtree(child(n, j));
+    }
+    delete_node(n);
+  }
+
+public:
+  class iterator {
+  public:
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    iterator() noexcept : node_(nullptr), position_(0), tree_(nullptr) {}
+
+    reference operator*() const {
+      return *node_->slot(position_);
+    }
+    pointer operator->() const {
+      return node_->slot(position_);
+    }
+
+    iterator& operator++() {
+      increment(node_, position_);
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    iterator& operator--() {
+      if (!node_) {
+        node_ = rightmost(tree_->root_);
+        position_ = node_->count - 1;
+      } else {
+        decrement(node_, position_);
+      }
+      return *this;
+    }
+
+    iterator operator--(int) {
+      auto tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    bool operator==(const iterator& other) const {
+      return node_ == other.node_ && position_ == other.position_;
+    }
+    bool operator!=(const iterator& other) const {
+      return !(*this == other);
+    }
+
+  private:
+    friend class BTree;
+    friend class const_iterator;
+    iterator(Node* node, size_type position, BTree* tree) noexcept
+        : node_(node), position_(position), tree_(tree) {}
+    Node* node_;
+    size_type position_;
+    BTree* tree_;
+  };
+
+  class const_iterator {
+  public:
+    using value_type = const Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    const_iterator() noexcept : node_(nullptr), position_(0), tree_(nullptr) {}
+    const_iterator(iterator it) noexcept
+        : node_(it.node_), position_(it.position_), tree_(it.tree_) {}
+
+    reference operator*() const {
+      return *node_->slot(position_);
+    }
+    pointer operator->() const {
+      return node_->slot(position_);
+    }
+
+    const_iterator& operator++() {
+      increment(node_, position_);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    const_iterator& operator--() {
+      if (!node_) {
+        node_ = rightmost(tree_->root_);
+        position_ = node_->count - 1;
+      } else {
+        decrement(node_, position_);
+      }
+      return *this;
+    }
+
+    const_iterator operator--(int) {
+      auto tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return node_ == other.node_ && position_ == other.position_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+  private:
+    friend class BTree;
+    // Nodes are only reached through the tree, so the pointer stays non-const internally.
+    const_iterator(Node* node, size_type position, const BTree* tree) noexcept
+        : node_(node), position_(position), tree_(tree) {}
+    Node* node_;
+    size_type position_;
+    const BTree* tree_;
+  };
+};
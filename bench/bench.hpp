@@ -102,6 +102,22 @@ inline void report_samples(std::string_view name, std::size_t n,
   std::cout << "\n";
 }
 
+// Reports the distribution of per-operation latencies (one sample per operation).
+inline void report_latency(std::string_view name, std::vector<std::chrono::nanoseconds> samples) {
+  if (samples.empty())
+    return;
+  std::sort(samples.begin(), samples.end());
+
+  const auto percentile = [&](double p) {
+    const auto rank = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+    return samples[rank].count();
+  };
+
+  std::cout << name << " [n=" << samples.size() << "]: p50=" << percentile(0.50)
+            << " ns, p99=" << percentile(0.99) << " ns, p99.9=" << percentile(0.999)
+            << " ns, max=" << samples.back().count() << " ns\n";
+}
+
 template <typename Fn> inline void run_samples(std::string_view name, std::size_t n, Fn&& fn) {
   for (std::size_t i = 0; i < config().warmup; ++i)
     std::forward<Fn>(fn)();
@@ -0,0 +1,102 @@
+#include "bench.hpp"
+
+#include "concurrent-map/concurrent_map.hpp"
+#include "map/map.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A reader-writer lock around an ordered map: the setup concurrent_map replaces.
+struct locked_map {
+  mutable std::shared_mutex mutex;
+  map<std::uint64_t, std::uint64_t> entries;
+
+  bool find(std::uint64_t key) const {
+    std::shared_lock lock(mutex);
+    return entries.contains(key);
+  }
+  void insert(std::uint64_t key, std::uint64_t value) {
+    std::unique_lock lock(mutex);
+    entries[key] = value;
+  }
+};
+
+struct versioned_map {
+  concurrent_map<std::uint64_t, std::uint64_t> map;
+
+  bool find(std::uint64_t key) const {
+    return map.contains(key);
+  }
+  void insert(std::uint64_t key, std::uint64_t value) {
+    map.insert_or_assign(key, value);
+  }
+};
+
+std::uint64_t xorshift(std::uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// `readers` threads share `n` lookups over keys [0, n) while one writer overwrites random keys
+// until they finish. Reports the reads' wall time and how many writes landed meanwhile.
+template <typename Map>
+void run_readers(std::string_view label, std::size_t n, std::size_t readers) {
+  Map m;
+  for (std::uint64_t i = 0; i < n; i += 2)
+    m.insert(i, i);
+
+  std::size_t writes = 0;
+  const std::string name = std::string(label) + " (1 writer, " + std::to_string(readers) +
+                           " readers)";
+  stl_bench::run_samples(name, n, [&] {
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+      std::uint64_t state = 0x9e3779b97f4a7c15ull;
+      writes = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        m.insert(xorshift(state) % n, writes);
+        ++writes;
+      }
+    });
+
+    std::vector<std::thread> workers;
+    workers.reserve(readers);
+    std::atomic<std::size_t> hits{0};
+    for (std::size_t t = 0; t < readers; ++t) {
+      workers.emplace_back([&, t] {
+        std::uint64_t state = 0x2545f4914f6cdd1dull + t;
+        std::size_t found = 0;
+        for (std::size_t i = t; i < n; i += readers)
+          found += m.find(xorshift(state) % n);
+        hits += found;
+      });
+    }
+    for (auto& w : workers)
+      w.join();
+    done = true;
+    writer.join();
+    stl_bench::do_not_optimize(hits.load());
+  });
+  std::cout << "  " << name << ": " << writes << " writes during the last sample\n";
+}
+
+} // namespace
+
+BENCH_CASE("concurrent_map/one_writer") {
+  for (std::size_t readers : {1, 2, 4, 8}) {
+    run_readers<versioned_map>("concurrent_map", n, readers);
+    run_readers<locked_map>("shared_mutex+map", n, readers);
+  }
+}
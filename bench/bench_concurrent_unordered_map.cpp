@@ -0,0 +1,97 @@
+#include "bench.hpp"
+
+#include "concurrent-unordered-map/concurrent_unordered_map.hpp"
+#include "unordered-map/unordered_map.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One mutex around the whole map: the setup concurrent_unordered_map replaces.
+struct locked_map {
+  std::mutex mutex;
+  unordered_map<std::uint64_t, std::uint64_t> map;
+
+  bool find(std::uint64_t key) {
+    std::lock_guard lock(mutex);
+    return map.contains(key);
+  }
+  void insert(std::uint64_t key, std::uint64_t value) {
+    std::lock_guard lock(mutex);
+    map.emplace(key, value);
+  }
+};
+
+struct sharded_map {
+  concurrent_unordered_map<std::uint64_t, std::uint64_t> map;
+
+  bool find(std::uint64_t key) {
+    return map.contains(key);
+  }
+  void insert(std::uint64_t key, std::uint64_t value) {
+    map.insert_or_assign(key, value);
+  }
+};
+
+std::uint64_t xorshift(std::uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// Runs `n` operations split across `threads` threads over keys [0, n); `write_percent` of them
+// are inserts and the rest lookups.
+template <typename Map>
+void run_mix(std::string_view label, std::size_t n, std::size_t threads, unsigned write_percent) {
+  Map m;
+  for (std::uint64_t i = 0; i < n; i += 2)
+    m.insert(i, i);
+
+  const std::string name = std::string(label) + " (" + std::to_string(threads) + " threads)";
+  stl_bench::run_samples(name, n, [&] {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        std::uint64_t state = 0x9E3779B97F4A7C15ULL * (t + 1);
+        std::size_t hits = 0;
+        for (std::size_t i = t; i < n; i += threads) {
+          const std::uint64_t r = xorshift(state);
+          const std::uint64_t key = r % n;
+          if (r % 100 < write_percent)
+            m.insert(key, i);
+          else
+            hits += m.find(key) ? 1 : 0;
+        }
+        stl_bench::do_not_optimize(hits);
+      });
+    }
+    for (auto& w : workers)
+      w.join();
+  });
+}
+
+template <typename Map>
+void run_thread_sweep(std::string_view label, std::size_t n, unsigned write_percent) {
+  for (std::size_t threads : {1, 2, 4, 8, 16})
+    run_mix<Map>(label, n, threads, write_percent);
+}
+
+} // namespace
+
+BENCH_CASE("concurrent_unordered_map/read_heavy") {
+  run_thread_sweep<sharded_map>("concurrent_unordered_map 95% read", n, 5);
+  run_thread_sweep<locked_map>("mutex+unordered_map 95% read", n, 5);
+}
+
+BENCH_CASE("concurrent_unordered_map/write_heavy") {
+  run_thread_sweep<sharded_map>("concurrent_unordered_map 50% write", n, 50);
+  run_thread_sweep<locked_map>("mutex+unordered_map 50% write", n, 50);
+}
@@ -32,3 +32,32 @@ BENCH_CASE("deque/push_pop") {
     stl_bench::do_not_optimize(d.size());
   });
 }
+
+BENCH_CASE("deque/append_range") {
+  std::vector<int> values(n);
+  for (std::size_t i = 0; i < n; ++i)
+    values[i] = static_cast<int>(i);
+
+  stl_bench::run_samples("Deque<int>::push_back per element", n, [&] {
+    Deque<int> d;
+    d.push_back(-1);
+    d.pop_front(); // start off slot 0 so the copy wraps
+    for (int v : values)
+      d.push_back(v);
+    stl_bench::do_not_optimize(d.size());
+  });
+
+  stl_bench::run_samples("Deque<int>::append_range", n, [&] {
+    Deque<int> d;
+    d.push_back(-1);
+    d.pop_front();
+    d.append_range(values);
+    stl_bench::do_not_optimize(d.size());
+  });
+
+  stl_bench::run_samples("std::deque<int>::insert(end, first, last)", n, [&] {
+    std::deque<int> d;
+    d.insert(d.end(), values.begin(), values.end());
+    stl_bench::do_not_optimize(d.size());
+  });
+}
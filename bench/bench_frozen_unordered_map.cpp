@@ -0,0 +1,94 @@
+#include "bench.hpp"
+
+#include "frozen-unordered-map/frozen_unordered_map.hpp"
+#include "unordered-map/unordered_map.hpp"
+#include "utility/mapped_file.hpp"
+#include "vector/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> table_keys(std::size_t n) {
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    keys.push_back("symbol/" + std::to_string(i * 2654435761ULL) + "/v1");
+  return keys;
+}
+
+std::filesystem::path write_blob(const Vector<std::byte>& blob) {
+  auto path = std::filesystem::temp_directory_path() / "stl_bench_frozen_map.bin";
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+  return path;
+}
+
+} // namespace
+
+// Startup cost of a lookup table: rebuilding an unordered_map from its source keys versus mapping
+// a previously frozen blob. The blob file is freshly written, so this measures a warm page cache;
+// cold-disk loads add read I/O only for the pages lookups actually touch.
+BENCH_CASE("frozen_unordered_map/startup") {
+  const auto keys = table_keys(n);
+
+  stl_bench::run_samples("unordered_map<string,u64> build", n, [&] {
+    unordered_map<std::string, std::uint64_t> m;
+    m.reserve(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+      m.emplace(keys[i], i);
+    stl_bench::do_not_optimize(m.size());
+  });
+
+  unordered_map<std::string, std::uint64_t> m;
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    m.emplace(keys[i], i);
+  const auto path = write_blob(frozen_unordered_map<std::uint64_t>::freeze(m));
+
+  stl_bench::run_samples("frozen_unordered_map<u64> mmap load", n, [&] {
+    const mapped_file file(path.string());
+    const frozen_unordered_map<std::uint64_t> f(file.bytes());
+    stl_bench::do_not_optimize(f.size());
+  });
+
+  stl_bench::run_samples("frozen_unordered_map<u64> mmap load + first lookup", n, [&] {
+    const mapped_file file(path.string());
+    const frozen_unordered_map<std::uint64_t> f(file.bytes());
+    stl_bench::do_not_optimize(f.contains(keys.front()));
+  });
+
+  std::filesystem::remove(path);
+}
+
+BENCH_CASE("frozen_unordered_map/find") {
+  const auto keys = table_keys(n);
+  unordered_map<std::string, std::uint64_t> m;
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    m.emplace(keys[i], i);
+  const Vector<std::byte> blob = frozen_unordered_map<std::uint64_t>::freeze(m);
+  const frozen_unordered_map<std::uint64_t> f(blob);
+
+  std::vector<std::string> probes = keys;
+  std::shuffle(probes.begin(), probes.end(), std::mt19937(3));
+
+  stl_bench::run_samples("unordered_map<string,u64>::find", n, [&] {
+    std::uint64_t sum = 0;
+    for (const std::string& k : probes)
+      sum += m.find(k)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  stl_bench::run_samples("frozen_unordered_map<u64>::find", n, [&] {
+    std::uint64_t sum = 0;
+    for (const std::string& k : probes)
+      sum += f.find(k)->get();
+    stl_bench::do_not_optimize(sum);
+  });
+}
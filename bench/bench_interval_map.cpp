@@ -0,0 +1,84 @@
+#include "bench.hpp"
+
+#include "interval-map/interval_map.hpp"
+#include "map/map.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Time ranges over a day in milliseconds: mostly short, with one in 64 lasting up to an hour.
+std::vector<interval<std::int64_t>> random_ranges(std::size_t n, std::uint32_t seed) {
+  constexpr std::int64_t kDay = 86'400'000;
+  std::mt19937_64 rng(seed);
+  std::vector<interval<std::int64_t>> out(n);
+  for (auto& r : out) {
+    const auto length = rng() % 64 == 0 ? rng() % 3'600'000 : rng() % 60'000;
+    r.lo = static_cast<std::int64_t>(rng() % kDay);
+    r.hi = r.lo + 1 + static_cast<std::int64_t>(length);
+  }
+  return out;
+}
+
+void time_queries(std::size_t count, std::size_t queries) {
+  const auto ranges = random_ranges(count, 1);
+  const auto windows = random_ranges(queries, 2);
+
+  // The baseline: ranges keyed by start in a map, every query scanning all of them.
+  map<std::pair<std::int64_t, std::int64_t>, std::size_t> by_start;
+  interval_map<std::int64_t, std::size_t> tree;
+  for (std::size_t i = 0; i < ranges.size(); ++i) {
+    by_start.insert({{ranges[i].lo, ranges[i].hi}, i});
+    tree.insert(ranges[i].lo, ranges[i].hi, i);
+  }
+
+  stl_bench::run_samples("interval_map/overlap map linear scan", queries, [&] {
+    std::size_t sum = 0;
+    for (const auto& w : windows) {
+      for (const auto& [range, id] : by_start) {
+        if (range.first < w.hi && w.lo < range.second)
+          sum += id;
+      }
+    }
+    stl_bench::do_not_optimize(sum);
+  });
+  stl_bench::run_samples("interval_map/overlap interval_map", queries, [&] {
+    std::size_t sum = 0;
+    for (const auto& w : windows) {
+      for (const auto& [range, id] : tree.overlapping(w.lo, w.hi))
+        sum += id;
+    }
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+} // namespace
+
+BENCH_CASE("interval_map/overlap_1m") {
+  // 1M stored ranges; n queries, each a window drawn like the stored ranges.
+  time_queries(1'000'000, n / 1000 + 1);
+}
+
+BENCH_CASE("interval_map/insert_erase") {
+  const auto ranges = random_ranges(n, 3);
+  stl_bench::run_samples("interval_map/insert_erase interval_map", n, [&] {
+    interval_map<std::int64_t, std::size_t> tree;
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+      tree.insert(ranges[i].lo, ranges[i].hi, i);
+    for (const auto& r : ranges)
+      tree.erase(tree.find(r));
+    stl_bench::do_not_optimize(tree.size());
+  });
+  stl_bench::run_samples("interval_map/insert_erase map", n, [&] {
+    map<std::pair<std::int64_t, std::int64_t>, std::size_t> by_start;
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+      by_start.insert({{ranges[i].lo, ranges[i].hi}, i});
+    for (const auto& r : ranges)
+      by_start.erase({r.lo, r.hi});
+    stl_bench::do_not_optimize(by_start.size());
+  });
+}
@@ -5,9 +5,15 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iostream>
 #include <map>
 #include <numeric>
 #include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -20,6 +26,66 @@ std::vector<int> shuffled_keys(std::size_t n) {
   return keys;
 }
 
+// Build, shuffled finds and an in-order scan over one container type. The map under test is
+// rebuilt for the find and scan phases so only one large tree is alive at a time.
+template <typename Map> void time_backend(std::string_view label, const std::vector<int>& keys) {
+  const std::string prefix(label);
+  const std::size_t size = keys.size();
+  stl_bench::run_samples(prefix + " build", size, [&] {
+    Map m;
+    for (int k : keys)
+      m.insert({k, k});
+    stl_bench::do_not_optimize(m.size());
+  });
+
+  std::vector<int> probes = keys;
+  std::shuffle(probes.begin(), probes.end(), std::mt19937(777));
+  Map m;
+  for (int k : keys)
+    m.insert({k, k});
+  stl_bench::run_samples(prefix + " find", size, [&] {
+    std::int64_t sum = 0;
+    for (int k : probes)
+      sum += m.find(k)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+  stl_bench::run_samples(prefix + " iterate", size, [&] {
+    std::int64_t sum = 0;
+    for (const auto& kv : m)
+      sum += kv.second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+// Fixed sizes rather than --n: at 1M keys an RbTree already outgrows L2, at 10M every level
+// below the top few is a DRAM miss.
+void compare_backends(std::size_t size) {
+  const auto keys = shuffled_keys(size);
+  time_backend<map<int, int>>("map<int,int> RbTree", keys);
+  time_backend<map<int, int, std::less<int>, BTree>>("map<int,int> BTree", keys);
+  time_backend<std::map<int, int>>("std::map<int,int>", keys);
+}
+
+// Sorted input built by repeated insert versus the O(n) bulk constructor, plus one scan of the
+// result so layout differences between the two trees show up too.
+template <typename Map> void time_from_sorted(std::string_view label, std::size_t size) {
+  const std::string prefix(label);
+  std::vector<std::pair<int, int>> pairs(size);
+  for (std::size_t i = 0; i < size; ++i)
+    pairs[i] = {static_cast<int>(i), static_cast<int>(i)};
+
+  stl_bench::run_samples(prefix + " insert loop", size, [&] {
+    Map m;
+    for (const auto& kv : pairs)
+      m.insert(kv);
+    stl_bench::do_not_optimize(m.size());
+  });
+  stl_bench::run_samples(prefix + " from_sorted", size, [&] {
+    auto m = Map::from_sorted(pairs.begin(), pairs.end());
+    stl_bench::do_not_optimize(m.size());
+  });
+}
+
 } // namespace
 
 BENCH_CASE("map/build+find") {
@@ -53,3 +119,183 @@ BENCH_CASE("map/build+find") {
     stl_bench::do_not_optimize(sum);
   });
 }
+
+BENCH_CASE("map/find_string_view") {
+  // Keys longer than the SSO buffer, so building a temporary std::string allocates.
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    keys.push_back("session-token-" + std::to_string(i) + "-0123456789abcdef");
+  std::vector<std::string_view> views(keys.begin(), keys.end());
+  std::shuffle(views.begin(), views.end(), std::mt19937(12345));
+
+  map<std::string, int> exact;
+  map<std::string, int, std::less<>> transparent;
+  for (std::size_t i = 0; i < n; ++i) {
+    exact.insert({keys[i], static_cast<int>(i)});
+    transparent.insert({keys[i], static_cast<int>(i)});
+  }
+
+  stl_bench::run_samples("map<string,int>::find (string temporary)", n, [&] {
+    std::int64_t sum = 0;
+    for (std::string_view v : views)
+      sum += exact.find(std::string(v))->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  stl_bench::run_samples("map<string,int>::find (transparent string_view)", n, [&] {
+    std::int64_t sum = 0;
+    for (std::string_view v : views)
+      sum += transparent.find(v)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+BENCH_CASE("map/backends_1m") {
+  static_cast<void>(n);
+  compare_backends(1'000'000);
+}
+
+BENCH_CASE("map/backends_10m") {
+  static_cast<void>(n);
+  compare_backends(10'000'000);
+}
+
+BENCH_CASE("map/from_sorted") {
+  static_cast<void>(n);
+  time_from_sorted<map<int, int>>("map<int,int> RbTree", 1'000'000);
+  time_from_sorted<map<int, int, std::less<int>, BTree>>("map<int,int> BTree", 1'000'000);
+}
+
+BENCH_CASE("map/move_between") {
+  // Moves every other element of one map into another, as a partitioning job would: by copying
+  // the value and erasing it, then by extracting and inserting the node. Values are longer than
+  // the SSO buffer, so a copy allocates. Both samples include building the source map.
+  const auto keys = shuffled_keys(n);
+  auto fill = [&] {
+    map<int, std::string> m;
+    for (int k : keys)
+      m.insert({k, std::string(40, 'v') + std::to_string(k)});
+    return m;
+  };
+  auto run = [&](std::string_view label, auto move_one) {
+    stl_bench::run_samples(label, n, [&] {
+      auto from = fill();
+      map<int, std::string> to;
+      for (auto it = from.begin(); it != from.end();) {
+        auto next = std::next(it);
+        if (it->first % 2 == 0)
+          move_one(from, to, it);
+        it = next;
+      }
+      stl_bench::do_not_optimize(to.size());
+    });
+  };
+  run("map/move_between insert+erase", [](auto& from, auto& to, auto it) {
+    to.insert(*it);
+    from.erase(it);
+  });
+  run("map/move_between extract+insert", [](auto& from, auto& to, auto it) {
+    to.insert(from.extract(it));
+  });
+}
+
+BENCH_CASE("map/split_join") {
+  // A sharding step: split an n-element map at a random key, then concatenate the halves again.
+  // The baseline moves the upper half node by node with extract/insert. Plain RbTree recounts
+  // the smaller half after a split; OrderStatisticRbTree reads the sizes off the root.
+  constexpr std::size_t kRounds = 64;
+  const auto keys = shuffled_keys(n);
+  auto time_rounds = [&](std::string_view label, auto& m, auto split_join) {
+    std::mt19937 rng(11);
+    stl_bench::run_samples(label, kRounds, [&] {
+      for (std::size_t r = 0; r < kRounds; ++r)
+        split_join(m, static_cast<int>(rng() % n));
+      stl_bench::do_not_optimize(m.size());
+    });
+  };
+  auto fill = [&](auto& m) {
+    for (int k : keys)
+      m.insert({k, k});
+  };
+
+  map<int, int> by_nodes;
+  fill(by_nodes);
+  time_rounds("map/split_join extract+insert", by_nodes, [](auto& m, int key) {
+    map<int, int> upper;
+    for (auto it = m.lower_bound(key); it != m.end();)
+      upper.insert(m.extract(it++));
+    m.merge(upper);
+  });
+
+  map<int, int> plain;
+  fill(plain);
+  time_rounds("map/split_join RbTree", plain, [](auto& m, int key) {
+    auto upper = m.split(key);
+    m.join(std::move(upper));
+  });
+
+  map<int, int, std::less<int>, OrderStatisticRbTree> counted;
+  fill(counted);
+  time_rounds("map/split_join OrderStatisticRbTree", counted, [](auto& m, int key) {
+    auto upper = m.split(key);
+    m.join(std::move(upper));
+  });
+}
+
+BENCH_CASE("map/snapshot") {
+  // A writer that publishes a snapshot after every update, as a reader-facing version history
+  // would. The baseline copies the whole RbTree map (RbTree is move-only, so through the O(n)
+  // from_sorted); PersistentRbTree shares all but the O(log n) nodes on the updated path.
+  constexpr std::size_t kRounds = 256;
+  const auto keys = shuffled_keys(n);
+  auto time_rounds = [&](std::string_view label, auto& m, auto publish) {
+    std::mt19937 rng(13);
+    stl_bench::run_samples(label, kRounds, [&] {
+      for (std::size_t r = 0; r < kRounds; ++r) {
+        auto published = publish(m);
+        m[static_cast<int>(rng() % n)] += 1;
+        stl_bench::do_not_optimize(published.size());
+      }
+    });
+  };
+
+  map<int, int> copied;
+  for (int k : keys)
+    copied.insert({k, k});
+  time_rounds("map/snapshot RbTree copy+update", copied, [](const auto& m) {
+    return map<int, int>::from_sorted(m.begin(), m.end());
+  });
+
+  map<int, int, std::less<int>, PersistentRbTree> persistent;
+  for (int k : keys)
+    persistent.insert({k, k});
+  time_rounds("map/snapshot PersistentRbTree snapshot+update", persistent,
+              [](const auto& m) { return m.snapshot(); });
+
+  // Memory held by kRounds live snapshots: distinct nodes across all of them, against the
+  // kRounds * n nodes that full copies would hold.
+  std::vector<map<int, int, std::less<int>, PersistentRbTree>> history;
+  std::mt19937 rng(17);
+  for (std::size_t r = 0; r < kRounds; ++r) {
+    history.push_back(persistent.snapshot());
+    persistent[static_cast<int>(rng() % n)] += 1;
+  }
+  std::unordered_set<const void*> nodes;
+  for (const auto& version : history) {
+    for (const auto& element : version)
+      nodes.insert(&element);
+  }
+  struct first_of {
+    const int& operator()(const std::pair<const int, int>& v) const noexcept {
+      return v.first;
+    }
+  };
+  const std::size_t node_bytes =
+      PersistentRbTree<std::pair<const int, int>, first_of, std::less<int>, false>::node_bytes;
+  std::cout << "map/snapshot memory [snapshots=" << kRounds << ", n=" << n
+            << "]: " << nodes.size() * node_bytes << " bytes shared vs "
+            << kRounds * n * node_bytes << " bytes copied ("
+            << static_cast<double>(nodes.size() - n) / static_cast<double>(kRounds)
+            << " new nodes per snapshot)\n";
+}
@@ -0,0 +1,80 @@
+#include "bench.hpp"
+
+#include "flat-map/flat_map.hpp"
+#include "perfect-hash-map/perfect_hash_map.hpp"
+#include "unordered-map/unordered_map.hpp"
+#include "vector/vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <typename K> K make_key(std::size_t i);
+
+template <> std::uint64_t make_key<std::uint64_t>(std::size_t i) {
+  return i * 0x9E3779B97F4A7C15ULL;
+}
+template <> std::string make_key<std::string>(std::size_t i) {
+  return "config." + std::to_string(i) + ".enabled";
+}
+
+// Builds the same n-key table three ways and times shuffled hits against each.
+template <typename K> void run_lookups(std::string_view label, std::size_t n) {
+  Vector<std::pair<K, std::uint64_t>> items;
+  items.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    items.push_back({make_key<K>(i), i});
+
+  std::vector<K> lookups;
+  lookups.reserve(n);
+  for (const auto& kv : items)
+    lookups.push_back(kv.first);
+  std::shuffle(lookups.begin(), lookups.end(), std::mt19937(7));
+
+  const std::string prefix(label);
+  stl_bench::run_samples(prefix + " perfect_hash_map build", n, [&] {
+    perfect_hash_map<K, std::uint64_t> m(items);
+    stl_bench::do_not_optimize(m.size());
+  });
+
+  const perfect_hash_map<K, std::uint64_t> phm(items);
+  unordered_map<K, std::uint64_t> um;
+  for (const auto& kv : items)
+    um.emplace(kv.first, kv.second);
+  // Sorted inserts append, keeping the FlatMap build O(n log n).
+  std::vector<std::pair<K, std::uint64_t>> sorted(items.begin(), items.end());
+  std::sort(sorted.begin(), sorted.end());
+  FlatMap<K, std::uint64_t> fm;
+  fm.reserve(n);
+  for (const auto& kv : sorted)
+    fm.insert(kv);
+
+  auto time_find = [&](std::string_view name, const auto& m) {
+    stl_bench::run_samples(prefix + " " + std::string(name) + "::find", n, [&] {
+      std::uint64_t sum = 0;
+      for (const K& k : lookups)
+        sum += m.find(k)->second;
+      stl_bench::do_not_optimize(sum);
+    });
+  };
+  time_find("perfect_hash_map", phm);
+  time_find("unordered_map", um);
+  time_find("FlatMap", fm);
+}
+
+} // namespace
+
+BENCH_CASE("perfect_hash_map/find_u64") {
+  run_lookups<std::uint64_t>("u64", n);
+}
+
+BENCH_CASE("perfect_hash_map/find_string") {
+  run_lookups<std::string>("string", n);
+}
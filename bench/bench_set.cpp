@@ -5,9 +5,11 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iostream>
 #include <numeric>
 #include <random>
 #include <set>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -20,6 +22,49 @@ std::vector<int> shuffled_keys(std::size_t n) {
   return keys;
 }
 
+// Shuffled inserts, shuffled finds and an in-order scan of a set<uint32_t> on one tree layout,
+// then the bytes each element takes, which is the node size (blocks add under one node each).
+template <template <typename, typename, typename, bool> class Tree>
+void time_layout(std::string_view label, std::size_t n, std::size_t node_bytes) {
+  const std::string prefix(label);
+  std::vector<std::uint32_t> keys(n);
+  std::iota(keys.begin(), keys.end(), 0u);
+  std::mt19937 rng(99);
+  std::shuffle(keys.begin(), keys.end(), rng);
+
+  set<std::uint32_t, std::less<std::uint32_t>, Tree> s;
+  stl_bench::run_samples(prefix + " insert", n, [&] {
+    s.clear();
+    for (auto k : keys)
+      s.insert(k);
+    stl_bench::do_not_optimize(s.size());
+  });
+  stl_bench::run_samples(prefix + " find", n, [&] {
+    std::uint64_t sum = 0;
+    for (auto k : keys)
+      sum += *s.find(k);
+    stl_bench::do_not_optimize(sum);
+  });
+  stl_bench::run_samples(prefix + " scan", n, [&] {
+    std::uint64_t sum = 0;
+    for (auto k : s)
+      sum += k;
+    stl_bench::do_not_optimize(sum);
+  });
+  std::cout << prefix << " bytes/element: " << node_bytes << " (payload "
+            << sizeof(std::uint32_t) << ")\n";
+}
+
+struct identity_key {
+  const std::uint32_t& operator()(const std::uint32_t& v) const noexcept {
+    return v;
+  }
+};
+
+template <template <typename, typename, typename, bool> class Tree>
+constexpr std::size_t node_bytes_of =
+    Tree<std::uint32_t, identity_key, std::less<std::uint32_t>, false>::node_bytes;
+
 } // namespace
 
 BENCH_CASE("set/build+find") {
@@ -53,3 +98,9 @@ BENCH_CASE("set/build+find") {
     stl_bench::do_not_optimize(sum);
   });
 }
+
+BENCH_CASE("set/node_layout") {
+  // The same set<uint32_t> on pointer-linked RbTree nodes and on CompactRbTree's 32-bit links.
+  time_layout<RbTree>("set/node_layout RbTree", n, node_bytes_of<RbTree>);
+  time_layout<CompactRbTree>("set/node_layout CompactRbTree", n, node_bytes_of<CompactRbTree>);
+}
@@ -0,0 +1,85 @@
+#include "bench.hpp"
+
+#include "flat-set/flat_set.hpp"
+#include "set-ops/set_ops.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// About n sorted, duplicate-free keys drawn from [0, universe).
+Vector<std::uint64_t> random_keys(std::size_t n, std::uint64_t universe, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::uint64_t> keys(n);
+  for (auto& k : keys)
+    k = rng() % universe;
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  Vector<std::uint64_t> out;
+  out.reserve(keys.size());
+  for (auto k : keys)
+    out.push_back(k);
+  return out;
+}
+
+// Both inputs span the same key range, so the smaller one's keys are spread through the larger.
+void time_intersection(const std::string& label, std::size_t n_a, std::size_t n_b) {
+  const std::uint64_t universe = 4 * std::max(n_a, n_b);
+  const auto a = random_keys(n_a, universe, 1);
+  const auto b = random_keys(n_b, universe, 2);
+  const std::size_t n = a.size() + b.size();
+  const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+  stl_bench::run_samples(label + " std::set_intersection", n, [&] {
+    std::vector<std::uint64_t> out;
+    out.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    stl_bench::do_not_optimize(out.size());
+  });
+  stl_bench::run_samples(label + " sorted_intersection", n, [&] {
+    stl_bench::do_not_optimize(sorted_intersection(a, b).size());
+  });
+  stl_bench::run_samples(label + " sorted_intersection threads=" + std::to_string(threads), n,
+                         [&] {
+                           stl_bench::do_not_optimize(
+                               sorted_intersection(a, b, std::less<>(), threads).size());
+                         });
+}
+
+} // namespace
+
+BENCH_CASE("set_ops/intersection_1m_x_1m") {
+  static_cast<void>(n);
+  time_intersection("set_ops/intersection 1M x 1M", 1'000'000, 1'000'000);
+}
+
+BENCH_CASE("set_ops/intersection_1k_x_10m") {
+  static_cast<void>(n);
+  time_intersection("set_ops/intersection 1K x 10M", 1'000, 10'000'000);
+}
+
+BENCH_CASE("set_ops/difference") {
+  const auto a = random_keys(n, 4 * n, 3);
+  const auto b = random_keys(n, 4 * n, 4);
+  FlatSet<std::uint64_t> flat;
+  flat.reserve(b.size());
+  for (auto k : b)
+    flat.insert(k);
+
+  stl_bench::run_samples("set_ops/difference std::set_difference", a.size() + b.size(), [&] {
+    std::vector<std::uint64_t> out;
+    out.reserve(a.size());
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    stl_bench::do_not_optimize(out.size());
+  });
+  stl_bench::run_samples("set_ops/difference sorted_difference (Vector, FlatSet)",
+                         a.size() + b.size(),
+                         [&] { stl_bench::do_not_optimize(sorted_difference(a, flat).size()); });
+}
@@ -1,10 +1,19 @@
 #include "bench.hpp"
 
 #include "unordered-map/unordered_map.hpp"
+#include "unordered-multimap/unordered_multimap.hpp"
+#include "vector/vector.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <random>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 std::vector<std::string> make_keys(std::size_t n) {
@@ -34,3 +43,318 @@ BENCH_CASE("unordered_map/emplace_reserve") {
     stl_bench::do_not_optimize(m.size());
   });
 }
+
+BENCH_CASE("unordered_map/find_hit") {
+  auto keys = make_keys(n);
+  std::vector<std::size_t> order(n);
+  for (std::size_t i = 0; i < n; ++i)
+    order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+  unordered_map<std::string, int> mine;
+  std::unordered_map<std::string, int> ref;
+  for (std::size_t i = 0; i < n; ++i) {
+    mine.emplace(keys[i], static_cast<int>(i));
+    ref.emplace(keys[i], static_cast<int>(i));
+  }
+
+  stl_bench::run_samples("unordered_map<string,int>::find (hit)", n, [&] {
+    long long sum = 0;
+    for (std::size_t i : order)
+      sum += mine.find(keys[i])->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  stl_bench::run_samples("std::unordered_map<string,int>::find (hit)", n, [&] {
+    long long sum = 0;
+    for (std::size_t i : order)
+      sum += ref.find(keys[i])->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+BENCH_CASE("unordered_map/find_miss") {
+  auto keys = make_keys(n);
+  std::vector<std::string> misses;
+  misses.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    misses.push_back("m" + std::to_string(i));
+
+  unordered_map<std::string, int> mine;
+  std::unordered_map<std::string, int> ref;
+  for (std::size_t i = 0; i < n; ++i) {
+    mine.emplace(keys[i], static_cast<int>(i));
+    ref.emplace(keys[i], static_cast<int>(i));
+  }
+
+  stl_bench::run_samples("unordered_map<string,int>::find (miss)", n, [&] {
+    std::size_t found = 0;
+    for (const auto& k : misses)
+      found += mine.find(k) != mine.end() ? 1 : 0;
+    stl_bench::do_not_optimize(found);
+  });
+
+  stl_bench::run_samples("std::unordered_map<string,int>::find (miss)", n, [&] {
+    std::size_t found = 0;
+    for (const auto& k : misses)
+      found += ref.find(k) != ref.end() ? 1 : 0;
+    stl_bench::do_not_optimize(found);
+  });
+}
+
+namespace {
+
+template <typename Policy>
+void run_int_policy(std::string_view label, const std::vector<std::uint64_t>& keys) {
+  const std::size_t n = keys.size();
+  stl_bench::run_samples(label, n, [&] {
+    unordered_map<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>,
+                  std::equal_to<std::uint64_t>, Policy>
+        m;
+    for (std::size_t i = 0; i < n; ++i)
+      m.emplace(keys[i], i);
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      sum += m.find(keys[i])->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+void run_int_std(std::string_view label, const std::vector<std::uint64_t>& keys) {
+  const std::size_t n = keys.size();
+  stl_bench::run_samples(label, n, [&] {
+    std::unordered_map<std::uint64_t, std::uint64_t> m;
+    for (std::size_t i = 0; i < n; ++i)
+      m.emplace(keys[i], i);
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      sum += m.find(keys[i])->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+} // namespace
+
+BENCH_CASE("unordered_map/int_keys_policy") {
+  std::mt19937_64 rng(7);
+  std::vector<std::uint64_t> keys(n);
+  for (auto& k : keys)
+    k = rng();
+
+  run_int_policy<power_of_two_bucket_policy>("unordered_map<u64,u64> random (pow2+mix)", keys);
+  run_int_policy<prime_bucket_policy>("unordered_map<u64,u64> random (prime fastmod)", keys);
+  run_int_policy<modulo_bucket_policy>("unordered_map<u64,u64> random (modulo)", keys);
+  run_int_std("std::unordered_map<u64,u64> random", keys);
+}
+
+BENCH_CASE("unordered_map/sequential_keys_policy") {
+  std::vector<std::uint64_t> keys(n);
+  for (std::size_t i = 0; i < n; ++i)
+    keys[i] = i;
+
+  run_int_policy<power_of_two_bucket_policy>("unordered_map<u64,u64> sequential (pow2+mix)", keys);
+  run_int_policy<prime_bucket_policy>("unordered_map<u64,u64> sequential (prime fastmod)", keys);
+  run_int_policy<modulo_bucket_policy>("unordered_map<u64,u64> sequential (modulo)", keys);
+  run_int_std("std::unordered_map<u64,u64> sequential", keys);
+}
+
+namespace {
+
+// Same hash as std::hash<std::string>, but opted out of hash caching below.
+struct uncached_string_hash : std::hash<std::string> {};
+
+} // namespace
+
+template <> struct cache_hash_code<std::string, uncached_string_hash> : std::false_type {};
+
+namespace {
+
+template <typename Map>
+void run_rehash(std::string_view label, const std::vector<std::string>& keys) {
+  Map m;
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    m.insert({keys[i], static_cast<int>(i)});
+  const std::size_t base = m.bucket_count();
+  bool grow = true;
+
+  stl_bench::run_samples(label, keys.size(), [&] {
+    m.rehash(grow ? base * 2 : base);
+    grow = !grow;
+    stl_bench::do_not_optimize(m.bucket_count());
+  });
+}
+
+} // namespace
+
+BENCH_CASE("unordered_map/rehash_cached_hash") {
+  const auto keys = make_keys(n);
+
+  run_rehash<unordered_map<std::string, int>>("unordered_map<string,int>::rehash (cached hash)",
+                                              keys);
+  run_rehash<unordered_map<std::string, int, uncached_string_hash>>(
+      "unordered_map<string,int>::rehash (no cached hash)", keys);
+  run_rehash<unordered_multimap<std::string, int>>(
+      "unordered_multimap<string,int>::rehash (cached hash)", keys);
+  run_rehash<unordered_multimap<std::string, int, uncached_string_hash>>(
+      "unordered_multimap<string,int>::rehash (no cached hash)", keys);
+}
+
+namespace {
+
+struct transparent_string_hash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+} // namespace
+
+BENCH_CASE("unordered_map/find_string_view") {
+  // Keys longer than the SSO buffer, so building a temporary std::string allocates.
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    keys.push_back("session-token-" + std::to_string(i) + "-0123456789abcdef");
+  std::vector<std::string_view> views(keys.begin(), keys.end());
+  std::shuffle(views.begin(), views.end(), std::mt19937(42));
+
+  unordered_map<std::string, int> exact;
+  unordered_map<std::string, int, transparent_string_hash, std::equal_to<>> transparent;
+  for (std::size_t i = 0; i < n; ++i) {
+    exact.emplace(keys[i], static_cast<int>(i));
+    transparent.emplace(keys[i], static_cast<int>(i));
+  }
+
+  stl_bench::run_samples("unordered_map<string,int>::find (string temporary)", n, [&] {
+    long long sum = 0;
+    for (std::string_view v : views)
+      sum += exact.find(std::string(v))->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  stl_bench::run_samples("unordered_map<string,int>::find (transparent string_view)", n, [&] {
+    long long sum = 0;
+    for (std::string_view v : views)
+      sum += transparent.find(v)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
+
+namespace {
+
+template <typename Map> void run_insert_latency(std::string_view label, Map& m, std::size_t n) {
+  std::mt19937_64 rng(7);
+  std::vector<std::chrono::nanoseconds> samples;
+  samples.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t key = rng();
+    const auto start = stl_bench::clock::now();
+    m.emplace(key, i);
+    const auto end = stl_bench::clock::now();
+    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+  }
+  stl_bench::do_not_optimize(m.size());
+  stl_bench::report_latency(label, std::move(samples));
+}
+
+} // namespace
+
+// Tail latency of individual inserts while the map grows from empty. A full rehash shows up as a
+// max in the milliseconds at large n; incremental mode spreads that work across later inserts.
+BENCH_CASE("unordered_map/insert_latency") {
+  {
+    unordered_map<std::uint64_t, std::size_t> m;
+    run_insert_latency("unordered_map<u64,size_t>::emplace (full rehash)", m, n);
+  }
+  {
+    unordered_map<std::uint64_t, std::size_t> m;
+    m.incremental_rehash(true);
+    run_insert_latency("unordered_map<u64,size_t>::emplace (incremental rehash)", m, n);
+  }
+}
+
+namespace {
+
+// 4M u64 pairs fill a 128 MiB slot array, well past a typical last-level cache, so random probes
+// miss to DRAM unless something overlaps them. Pass a larger --n on hosts with bigger caches.
+constexpr std::size_t kBeyondLlc = std::size_t{1} << 22;
+
+std::vector<std::pair<std::uint64_t, std::uint64_t>> random_pairs(std::size_t n) {
+  std::mt19937_64 rng(99);
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> pairs(n);
+  for (std::size_t i = 0; i < n; ++i)
+    pairs[i] = {rng(), i};
+  return pairs;
+}
+
+} // namespace
+
+BENCH_CASE("unordered_map/insert_range_large") {
+  const std::size_t size = std::max(n, kBeyondLlc);
+  const auto pairs = random_pairs(size);
+
+  stl_bench::run_samples("unordered_map<u64,u64>::emplace loop (reserve)", size, [&] {
+    unordered_map<std::uint64_t, std::uint64_t> m;
+    m.reserve(size);
+    for (const auto& [k, v] : pairs)
+      m.emplace(k, v);
+    stl_bench::do_not_optimize(m.size());
+  });
+
+  stl_bench::run_samples("unordered_map<u64,u64>::insert_range", size, [&] {
+    unordered_map<std::uint64_t, std::uint64_t> m;
+    m.insert_range(pairs.begin(), pairs.end());
+    stl_bench::do_not_optimize(m.size());
+  });
+}
+
+BENCH_CASE("unordered_map/find_batch_large") {
+  const std::size_t size = std::max(n, kBeyondLlc);
+  const auto pairs = random_pairs(size);
+  unordered_map<std::uint64_t, std::uint64_t> m;
+  unordered_multimap<std::uint64_t, std::uint64_t> mm;
+  m.insert_range(pairs.begin(), pairs.end());
+  mm.insert_range(pairs.begin(), pairs.end());
+
+  Vector<std::uint64_t> keys;
+  keys.reserve(size);
+  for (const auto& kv : pairs)
+    keys.push_back(kv.first);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+
+  stl_bench::run_samples("unordered_map<u64,u64>::find loop", size, [&] {
+    std::uint64_t sum = 0;
+    for (std::uint64_t k : keys)
+      sum += m.find(k)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  Vector<unordered_map<std::uint64_t, std::uint64_t>::iterator> out;
+  out.resize(keys.size());
+  stl_bench::run_samples("unordered_map<u64,u64>::find_batch", size, [&] {
+    m.find_batch(keys, out);
+    std::uint64_t sum = 0;
+    for (const auto& it : out)
+      sum += it->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  stl_bench::run_samples("unordered_multimap<u64,u64>::find loop", size, [&] {
+    std::uint64_t sum = 0;
+    for (std::uint64_t k : keys)
+      sum += mm.find(k)->second;
+    stl_bench::do_not_optimize(sum);
+  });
+
+  Vector<unordered_multimap<std::uint64_t, std::uint64_t>::iterator> mm_out;
+  mm_out.resize(keys.size());
+  stl_bench::run_samples("unordered_multimap<u64,u64>::find_batch", size, [&] {
+    mm.find_batch(keys, mm_out);
+    std::uint64_t sum = 0;
+    for (const auto& it : mm_out)
+      sum += it->second;
+    stl_bench::do_not_optimize(sum);
+  });
+}
@@ -1,11 +1,34 @@
 #include "bench.hpp"
 
+#include "string/string.hpp"
+#include "vector/expandable_allocator.hpp"
+#include "vector/huge_page_allocator.hpp"
 #include "vector/vector.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <list>
 #include <random>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+namespace {
+
+// The same string without the relocation opt-in, so Vector moves it element by element.
+struct moved_string {
+  string s;
+
+  explicit moved_string(const char* text) : s(text) {}
+};
+static_assert(!is_trivially_relocatable_v<moved_string>);
+
+constexpr const char* kLongText = "a string too long for the short-string buffer";
+
+} // namespace
+
 BENCH_CASE("vector/push_back_no_reserve") {
   std::mt19937 rng(123);
   std::uniform_int_distribution<int> dist(0, 1'000'000);
@@ -51,3 +74,207 @@ BENCH_CASE("vector/push_back_reserve") {
     stl_bench::do_not_optimize(xs.size());
   });
 }
+
+BENCH_CASE("vector/string_growth") {
+  stl_bench::run_samples("Vector<string>::push_back (relocate)", n, [&] {
+    Vector<string> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.emplace_back(i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+
+  stl_bench::run_samples("Vector<string>::push_back (move each)", n, [&] {
+    Vector<moved_string> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.emplace_back(i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+
+  stl_bench::run_samples("std::vector<std::string>::push_back", n, [&] {
+    std::vector<std::string> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.emplace_back(i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+}
+
+// Inserts at the middle shift half the elements each time, so this runs a tenth of n inserts.
+BENCH_CASE("vector/string_middle_insert") {
+  const std::size_t inserts = n / 10;
+
+  stl_bench::run_samples("Vector<string>::insert middle (relocate)", inserts, [&] {
+    Vector<string> xs;
+    for (std::size_t i = 0; i < inserts; ++i)
+      xs.emplace(xs.begin() + xs.size() / 2, i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+
+  stl_bench::run_samples("Vector<string>::insert middle (move each)", inserts, [&] {
+    Vector<moved_string> xs;
+    for (std::size_t i = 0; i < inserts; ++i)
+      xs.emplace(xs.begin() + xs.size() / 2, i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+
+  stl_bench::run_samples("std::vector<std::string>::insert middle", inserts, [&] {
+    std::vector<std::string> xs;
+    for (std::size_t i = 0; i < inserts; ++i)
+      xs.emplace(xs.begin() + static_cast<std::ptrdiff_t>(xs.size() / 2),
+                 i % 2 ? "short" : kLongText);
+    stl_bench::do_not_optimize(xs.size());
+  });
+}
+
+// Inserts a batch of 1024 ints into the middle of an n-element vector, then erases it again.
+// One insert per element shifts the tail 1024 times; insert_range shifts it once.
+BENCH_CASE("vector/insert_range") {
+  constexpr std::size_t kBatch = 1024;
+  std::vector<int> batch(kBatch);
+  for (std::size_t i = 0; i < kBatch; ++i)
+    batch[i] = static_cast<int>(i);
+
+  Vector<int> xs;
+  xs.resize(n);
+  stl_bench::run_samples("Vector<int>::insert per element (middle)", kBatch, [&] {
+    const std::size_t mid = xs.size() / 2;
+    for (std::size_t i = 0; i < kBatch; ++i)
+      xs.insert(xs.begin() + mid + i, batch[i]);
+    xs.erase(xs.begin() + mid, xs.begin() + mid + kBatch);
+    stl_bench::do_not_optimize(xs.data());
+  });
+
+  stl_bench::run_samples("Vector<int>::insert_range (middle)", kBatch, [&] {
+    const std::size_t mid = xs.size() / 2;
+    xs.insert_range(xs.begin() + mid, batch);
+    xs.erase(xs.begin() + mid, xs.begin() + mid + kBatch);
+    stl_bench::do_not_optimize(xs.data());
+  });
+
+  std::vector<int> ys(n);
+  stl_bench::run_samples("std::vector<int>::insert(pos, first, last) (middle)", kBatch, [&] {
+    const auto mid = static_cast<std::ptrdiff_t>(ys.size() / 2);
+    ys.insert(ys.begin() + mid, batch.begin(), batch.end());
+    ys.erase(ys.begin() + mid, ys.begin() + mid + static_cast<std::ptrdiff_t>(kBatch));
+    stl_bench::do_not_optimize(ys.data());
+  });
+
+  std::list<string> names(kBatch, string(kLongText));
+  stl_bench::run_samples("Vector<string>::push_back per element (from list)", kBatch, [&] {
+    Vector<string> out;
+    for (const auto& s : names)
+      out.push_back(s);
+    stl_bench::do_not_optimize(out.data());
+  });
+
+  stl_bench::run_samples("Vector<string>::append_range (from list)", kBatch, [&] {
+    Vector<string> out;
+    out.append_range(names);
+    stl_bench::do_not_optimize(out.data());
+  });
+}
+
+// Meant for large n (e.g. --n 1000000000, 4 GB of ints): with std::allocator every growth copies
+// the whole buffer and briefly holds both copies; expandable_allocator remaps it in place.
+BENCH_CASE("vector/push_back_huge") {
+  stl_bench::run_samples("Vector<int>::push_back (no reserve)", n, [&] {
+    Vector<int> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.push_back(static_cast<int>(i));
+    stl_bench::do_not_optimize(xs.data());
+  });
+
+  stl_bench::run_samples("Vector<int, expandable_allocator>::push_back (no reserve)", n, [&] {
+    Vector<int, expandable_allocator<int>> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.push_back(static_cast<int>(i));
+    stl_bench::do_not_optimize(xs.data());
+  });
+
+  stl_bench::run_samples("std::vector<int>::push_back (no reserve)", n, [&] {
+    std::vector<int> xs;
+    for (std::size_t i = 0; i < n; ++i)
+      xs.push_back(static_cast<int>(i));
+    stl_bench::do_not_optimize(xs.data());
+  });
+}
+
+// Random gathers from an n-element uint64 array, sized past the TLB's reach (e.g. --n 134217728,
+// 1 GB): with 4 KB pages nearly every load also misses the TLB and walks the page table.
+BENCH_CASE("vector/huge_page_gather") {
+  constexpr std::size_t kLookups = std::size_t{1} << 22;
+  std::mt19937_64 rng(123);
+  std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+  Vector<std::size_t> at;
+  at.resize_uninitialized(kLookups);
+  for (auto& i : at)
+    i = dist(rng);
+
+  auto gather = [&](const auto& xs) {
+    std::uint64_t sum = 0;
+    for (std::size_t i : at)
+      sum += xs[i];
+    stl_bench::do_not_optimize(sum);
+  };
+  const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  auto fill = [](std::size_t i) { return std::uint64_t{i}; };
+
+  {
+    Vector<std::uint64_t> xs;
+    xs.resize_uninitialized(n);
+    first_touch_parallel(xs.data(), n, threads, fill);
+    stl_bench::run_samples("Vector<uint64_t> random gather (4 KB pages)", kLookups,
+                           [&] { gather(xs); });
+  }
+  {
+    Vector<std::uint64_t, huge_page_allocator<std::uint64_t>> xs;
+    xs.resize_uninitialized(n);
+    first_touch_parallel(xs.data(), n, threads, fill);
+    stl_bench::run_samples("Vector<uint64_t, huge_page_allocator> random gather", kLookups,
+                           [&] { gather(xs); });
+  }
+}
+
+// Reads an n-byte file into a fresh buffer, as an I/O path does per request. resize(n) zeroes
+// the buffer before read overwrites it; the other variants leave it unwritten.
+BENCH_CASE("vector/read_into_buffer") {
+  std::FILE* file = std::tmpfile();
+  if (!file)
+    return;
+  {
+    Vector<char> fill;
+    fill.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+      fill[i] = static_cast<char>(i);
+    std::fwrite(fill.data(), 1, n, file);
+  }
+
+  stl_bench::run_samples("Vector<char>::resize + fread", n, [&] {
+    Vector<char> buf;
+    buf.resize(n);
+    std::rewind(file);
+    stl_bench::do_not_optimize(std::fread(buf.data(), 1, n, file));
+  });
+
+  stl_bench::run_samples("Vector<char>::resize_uninitialized + fread", n, [&] {
+    Vector<char> buf;
+    buf.resize_uninitialized(n);
+    std::rewind(file);
+    stl_bench::do_not_optimize(std::fread(buf.data(), 1, n, file));
+  });
+
+  stl_bench::run_samples("string::resize_and_overwrite with fread", n, [&] {
+    string buf;
+    std::rewind(file);
+    buf.resize_and_overwrite(n, [&](char* p, std::size_t cap) {
+      return std::fread(p, 1, cap, file);
+    });
+    stl_bench::do_not_optimize(buf.size());
+  });
+
+  stl_bench::run_samples("std::vector<char>(n) + fread", n, [&] {
+    std::vector<char> buf(n);
+    std::rewind(file);
+    stl_bench::do_not_optimize(std::fread(buf.data(), 1, n, file));
+  });
+  std::fclose(file);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "map/map.hpp"
+#include "utility/ebr.hpp"
+
+// Ordered map for read-mostly data shared between threads: any number of readers take no locks,
+// while writers, one at a time, publish new versions. The map is a `map` on PersistentRbTree
+// behind an atomic pointer. A write copies the published version in O(1), applies its change,
+// which copies only the O(log n) nodes on the changed path, and swaps the result in.
+//
+// Readers hold an ebr_guard and see whichever version was published when they loaded the
+// pointer. A replaced version goes to ebr_retire() and is destroyed once no reader can still be
+// on it, which frees the nodes no later version shares. Readers write only their own epoch
+// record, so they share no cache line with each other or with the writer. Writers never wait for
+// readers; they wait only for each other, on a mutex.
+//
+// Callbacks run while the version they see is pinned. They must not keep references into it
+// past their return; snapshot() hands out a version to keep.
+template <typename K, typename V, typename Compare = std::less<K>> class concurrent_map {
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = std::size_t;
+  using map_type = map<K, V, Compare, PersistentRbTree>;
+
+  concurrent_map() : current_(new map_type()) {}
+  concurrent_map(const concurrent_map&) = delete;
+  concurrent_map& operator=(const concurrent_map&) = delete;
+
+  // Readers must be done; versions retired earlier are freed by later collections.
+  ~concurrent_map() {
+    delete current_.load();
+    ebr_collect();
+  }
+
+  // Calls `fn(const map_type&)` on the current version and returns what it returns.
+  template <typename Fn> decltype(auto) read(Fn&& fn) const {
+    ebr_guard guard;
+    return std::forward<Fn>(fn)(std::as_const(*current_.load()));
+  }
+
+  // Calls `fn(const K&, const V&)` on the element for `key`; returns whether it was found.
+  template <typename Fn> bool cvisit(const K& key, Fn&& fn) const {
+    return read([&](const map_type& m) {
+      auto it = m.find(key);
+      if (it == m.end())
+        return false;
+      std::forward<Fn>(fn)(it->first, it->second);
+      return true;
+    });
+  }
+
+  std::optional<V> find(const K& key) const {
+    return read([&](const map_type& m) -> std::optional<V> {
+      auto it = m.find(key);
+      return it == m.end() ? std::nullopt : std::optional<V>(it->second);
+    });
+  }
+
+  bool contains(const K& key) const {
+    return read([&](const map_type& m) { return m.contains(key); });
+  }
+
+  size_type size() const {
+    return read([](const map_type& m) { return m.size(); });
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // The current version as a map of its own, in O(1). It stays valid, and unchanged, however
+  // long it is kept. Unlike read(), this updates a count shared with other readers.
+  map_type snapshot() const {
+    return read([](const map_type& m) { return m.snapshot(); });
+  }
+
+  // Inserts when `key` is absent; returns whether an insert happened.
+  bool insert(K key, V value) {
+    return write([&](map_type& m) {
+      return m.insert({std::move(key), std::move(value)}).second;
+    });
+  }
+
+  // Inserts or overwrites; returns whether an insert happened.
+  bool insert_or_assign(K key, V value) {
+    bool inserted = false;
+    write([&](map_type& m) {
+      inserted = !m.contains(key);
+      m[std::move(key)] = std::move(value);
+      return true;
+    });
+    return inserted;
+  }
+
+  // Returns whether `key` was present.
+  bool erase(const K& key) {
+    return write([&](map_type& m) {
+      const size_type before = m.size();
+      m.erase(key);
+      return m.size() != before;
+    });
+  }
+
+  // Calls `fn(map_type&)` on a private copy of the current version and publishes the result
+  // as one version, so readers see all of its changes or none. If `fn` throws, nothing is
+  // published.
+  template <typename Fn> void update(Fn&& fn) {
+    write([&](map_type& m) {
+      std::forward<Fn>(fn)(m);
+      return true;
+    });
+  }
+
+private:
+  std::atomic<map_type*> current_;
+  std::mutex write_mutex_;
+
+  // Applies `change` to a copy of the current version and publishes it if `change` returns
+  // true. Returns what `change` returned.
+  template <typename Change> bool write(Change&& change) {
+    std::lock_guard lock(write_mutex_);
+    auto next = std::make_unique<map_type>(*current_.load(std::memory_order_relaxed));
+    if (!change(*next))
+      return false;
+    ebr_retire(current_.exchange(next.release()));
+    return true;
+  }
+};
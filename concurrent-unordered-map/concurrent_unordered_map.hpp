@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+
+#include "unordered-map/hash_policy.hpp"
+#include "unordered-map/unordered_map.hpp"
+#include "vector/vector.hpp"
+
+// Hash map shared between threads. Keys are partitioned by the high bits of their mixed hash
+// into `Shards` independent `unordered_map`s, each guarded by its own reader-writer lock and
+// padded to a cache line so neighbouring shards never false-share. Operations on different
+// shards do not contend, and read-only visits of one shard share its lock.
+//
+// There are no iterators or references into the map: elements are reached through callbacks
+// that run while the owning shard is locked. Callbacks must not re-enter the same map.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>, std::size_t Shards = 64>
+class concurrent_unordered_map {
+  static_assert(std::has_single_bit(Shards),
+                "concurrent_unordered_map: Shards must be a power of two");
+
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = std::size_t;
+  using map_type = unordered_map<K, V, Hash, KeyEqual>;
+
+  static constexpr size_type shard_count = Shards;
+
+  concurrent_unordered_map() = default;
+  concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+  concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+  // Inserts when `key` is absent; returns whether an insert happened.
+  bool insert(K key, V value) {
+    shard& s = shard_for(key);
+    std::unique_lock lock(s.mutex);
+    if (s.map.contains(key))
+      return false;
+    s.map.emplace(std::move(key), std::move(value));
+    return true;
+  }
+
+  // Inserts or overwrites; returns whether an insert happened.
+  bool insert_or_assign(K key, V value) {
+    shard& s = shard_for(key);
+    std::unique_lock lock(s.mutex);
+    const size_type before = s.map.size();
+    s.map.emplace(std::move(key), std::move(value));
+    return s.map.size() != before;
+  }
+
+  // Inserts when `key` is absent, otherwise calls `fn(const K&, V&)` on the existing element
+  // under the shard's exclusive lock. Returns whether an insert happened.
+  template <typename Fn> bool insert_or_visit(K key, V value, Fn&& fn) {
+    shard& s = shard_for(key);
+    std::unique_lock lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it != s.map.end()) {
+      std::forward<Fn>(fn)(std::as_const(it->first), it->second);
+      return false;
+    }
+    s.map.emplace(std::move(key), std::move(value));
+    return true;
+  }
+
+  // Calls `fn(const K&, V&)` under the shard's exclusive lock; returns whether `key` was found.
+  template <typename Fn> bool visit(const K& key, Fn&& fn) {
+    shard& s = shard_for(key);
+    std::unique_lock lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it == s.map.end())
+      return false;
+    std::forward<Fn>(fn)(std::as_const(it->first), it->second);
+    return true;
+  }
+
+  // Calls `fn(const K&, const V&)` under the shard's shared lock; returns whether `key` was found.
+  template <typename Fn> bool cvisit(const K& key, Fn&& fn) const {
+    const shard& s = shard_for(key);
+    std::shared_lock lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it == s.map.end())
+      return false;
+    std::forward<Fn>(fn)(it->first, it->second);
+    return true;
+  }
+
+  bool contains(const K& key) const {
+    const shard& s = shard_for(key);
+    std::shared_lock lock(s.mutex);
+    return s.map.contains(key);
+  }
+
+  bool erase(const K& key) {
+    return erase_if(key, [](const K&, const V&) { return true; });
+  }
+
+  // Erases `key` if `pred(const K&, const V&)` accepts it; returns whether it was erased.
+  template <typename Pred> bool erase_if(const K& key, Pred pred) {
+    shard& s = shard_for(key);
+    std::unique_lock lock(s.mutex);
+    auto it = s.map.find(key);
+    if (it == s.map.end() || !pred(std::as_const(it->first), std::as_const(it->second)))
+      return false;
+    s.map.erase(key);
+    return true;
+  }
+
+  // Erases every element `pred(const K&, const V&)` accepts, locking one shard at a time.
+  template <typename Pred> size_type erase_if(Pred pred) {
+    size_type erased = 0;
+    for (shard& s : shards_) {
+      std::unique_lock lock(s.mutex);
+      erased += s.map.erase_if([&](const auto& kv) { return pred(kv.first, kv.second); });
+    }
+    return erased;
+  }
+
+  // Calls `fn(const K&, const V&)` on every element, holding one shard's shared lock at a time.
+  // Elements inserted or erased concurrently may or may not be seen.
+  template <typename Fn> void for_each(Fn&& fn) const {
+    for (const shard& s : shards_)
+      visit_shard(s, fn);
+  }
+
+  // Parallel for_each: up to `threads` threads (the caller included) claim shards from a shared
+  // counter. `fn` is called concurrently for elements of different shards and must not throw.
+  template <typename Fn> void for_each(Fn&& fn, size_type threads) const {
+    threads = std::clamp<size_type>(threads, 1, Shards);
+    std::atomic<size_type> next{0};
+    auto worker = [&] {
+      for (size_type i = next.fetch_add(1, std::memory_order_relaxed); i < Shards;
+           i = next.fetch_add(1, std::memory_order_relaxed))
+        visit_shard(shards_[i], fn);
+    };
+
+    Vector<std::jthread> pool;
+    pool.reserve(threads - 1);
+    for (size_type t = 1; t < threads; ++t)
+      pool.emplace_back(worker);
+    worker();
+  }
+
+  // Sums the shard sizes; only a snapshot while other threads are writing.
+  size_type size() const {
+    size_type total = 0;
+    for (const shard& s : shards_) {
+      std::shared_lock lock(s.mutex);
+      total += s.map.size();
+    }
+    return total;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  void clear() {
+    for (shard& s : shards_) {
+      std::unique_lock lock(s.mutex);
+      s.map.clear();
+    }
+  }
+
+  // Reserves room for `n` elements spread evenly across shards.
+  void reserve(size_type n) {
+    for (shard& s : shards_) {
+      std::unique_lock lock(s.mutex);
+      s.map.reserve(n / Shards + 1);
+    }
+  }
+
+private:
+  static constexpr int kShardBits = std::countr_zero(Shards);
+
+  // Aligned to a cache line so one shard's lock traffic does not invalidate its neighbours.
+  struct alignas(64) shard {
+    mutable std::shared_mutex mutex;
+    map_type map;
+  };
+
+  shard shards_[Shards];
+
+  // The inner maps index with the low bits of the same mixed hash, so shards use the high bits.
+  static size_type shard_index(const K& key) {
+    if constexpr (kShardBits == 0) {
+      (void)key;
+      return 0;
+    } else {
+      const std::size_t mixed = power_of_two_bucket_policy{}.mix(Hash{}(key));
+      return mixed >> (std::numeric_limits<std::size_t>::digits - kShardBits);
+    }
+  }
+
+  shard& shard_for(const K& key) {
+    return shards_[shard_index(key)];
+  }
+  const shard& shard_for(const K& key) const {
+    return shards_[shard_index(key)];
+  }
+
+  template <typename Fn> static void visit_shard(const shard& s, Fn& fn) {
+    std::shared_lock lock(s.mutex);
+    for (const auto& kv : s.map)
+      fn(kv.first, kv.second);
+  }
+};
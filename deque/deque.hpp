@@ -1,28 +1,43 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
 
-template <typename T> class Deque {
+#include "utility/ranges.hpp"
+#include "utility/relocate.hpp"
+
+// `Allocator` is used through std::allocator_traits, so a `huge_page_allocator` (see
+// vector/huge_page_allocator.hpp) or any other standard allocator can supply the ring buffer.
+// As with Vector it supplies storage only: elements are built with std::construct_at, not
+// alloc_traits::construct, so there is no uses-allocator construction.
+template <typename T, typename Allocator = std::allocator<T>> class Deque {
 public:
   using value_type = T;
+  using allocator_type = Allocator;
   using size_type = std::size_t;
   using difference_type = std::ptrdiff_t;
 
   class iterator;
   class const_iterator;
 
-  Deque() noexcept;
+  Deque() noexcept(noexcept(Allocator()));
+  explicit Deque(const Allocator& alloc) noexcept;
   Deque(const Deque& other);
   Deque(Deque&& other) noexcept;
   ~Deque();
 
   Deque& operator=(const Deque& other);
-  Deque& operator=(Deque&& other) noexcept;
+  Deque& operator=(Deque&& other) noexcept(
+      std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+      std::allocator_traits<Allocator>::is_always_equal::value);
+
+  allocator_type get_allocator() const noexcept;
 
   bool empty() const noexcept;
   size_type size() const noexcept;
@@ -48,6 +63,14 @@ public:
   void pop_back();
   void pop_front();
 
+  // C++23 range insertion. Sized and forward ranges grow the buffer at most once; contiguous
+  // ranges of trivially copyable T are copied in at most two memcpy runs, one on each side of the
+  // wrap point. insert_range shifts whichever side of `pos` is shorter, once.
+  template <container_compatible_range<T> R> void append_range(R&& rg);
+  template <container_compatible_range<T> R> void prepend_range(R&& rg);
+  template <container_compatible_range<T> R> iterator insert_range(const_iterator pos, R&& rg);
+  template <container_compatible_range<T> R> void assign_range(R&& rg);
+
   iterator begin() noexcept;
   iterator end() noexcept;
   const_iterator begin() const noexcept;
@@ -56,7 +79,9 @@ public:
   const_iterator cend() const noexcept;
 
 private:
-  std::allocator<T> alloc_{};
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  [[no_unique_address]] Allocator alloc_;
   T* data_;
   size_type size_;
   size_type capacity_;
@@ -64,12 +89,14 @@ private:
 
   size_type phys_index(size_type i) const noexcept;
   void ensure_capacity_for_one_more();
+  void reserve_for(size_type n);
+  template <typename R> void copy_range_at(size_type start, size_type n, R&& rg);
   void grow(size_type new_capacity);
   void destroy_all() noexcept;
   void deallocate() noexcept;
 };
 
-template <typename T> class Deque<T>::iterator {
+template <typename T, typename Allocator> class Deque<T, Allocator>::iterator {
 public:
   using value_type = T;
   using difference_type = std::ptrdiff_t;
@@ -156,7 +183,7 @@ private:
   size_type index_;
 };
 
-template <typename T> class Deque<T>::const_iterator {
+template <typename T, typename Allocator> class Deque<T, Allocator>::const_iterator {
 public:
   using value_type = const T;
   using difference_type = std::ptrdiff_t;
@@ -1,7 +1,13 @@
-template <typename T>
-Deque<T>::Deque() noexcept : data_(nullptr), size_(0), capacity_(0), head_(0) {}
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque() noexcept(noexcept(Allocator())) : Deque(Allocator()) {}
 
-template <typename T> Deque<T>::Deque(const Deque& other) : Deque() {
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(const Allocator& alloc) noexcept
+    : alloc_(alloc), data_(nullptr), size_(0), capacity_(0), head_(0) {}
+
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(const Deque& other)
+    : Deque(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
   if (other.size_ == 0)
     return;
   grow(other.size_);
@@ -9,128 +15,161 @@ template <typename T> Deque<T>::Deque(const Deque& other) : Deque() {
     push_back(other[i]);
 }
 
-template <typename T>
-Deque<T>::Deque(Deque&& other) noexcept
-    : alloc_(), data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
-      capacity_(std::exchange(other.capacity_, 0)), head_(std::exchange(other.head_, 0)) {}
+template <typename T, typename Allocator>
+Deque<T, Allocator>::Deque(Deque&& other) noexcept
+    : alloc_(std::move(other.alloc_)), data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)),
+      head_(std::exchange(other.head_, 0)) {}
 
-template <typename T> Deque<T>::~Deque() {
+template <typename T, typename Allocator> Deque<T, Allocator>::~Deque() {
   destroy_all();
   deallocate();
 }
 
-template <typename T> Deque<T>& Deque<T>::operator=(const Deque& other) {
+template <typename T, typename Allocator>
+Deque<T, Allocator>& Deque<T, Allocator>::operator=(const Deque& other) {
   if (this == &other)
     return *this;
-  Deque tmp(other);
-  *this = std::move(tmp);
+  // Copy into a buffer from the allocator this deque ends up with, then take it over.
+  constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+  Deque tmp(propagate ? other.alloc_ : alloc_);
+  tmp.append_range(other);
+  clear();
+  deallocate();
+  if constexpr (propagate)
+    alloc_ = other.alloc_;
+  data_ = std::exchange(tmp.data_, nullptr);
+  size_ = std::exchange(tmp.size_, 0);
+  capacity_ = std::exchange(tmp.capacity_, 0);
+  head_ = std::exchange(tmp.head_, 0);
   return *this;
 }
 
-template <typename T> Deque<T>& Deque<T>::operator=(Deque&& other) noexcept {
+template <typename T, typename Allocator>
+Deque<T, Allocator>& Deque<T, Allocator>::operator=(Deque&& other) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value) {
   if (this == &other)
     return *this;
-  destroy_all();
-  deallocate();
-  data_ = std::exchange(other.data_, nullptr);
-  size_ = std::exchange(other.size_, 0);
-  capacity_ = std::exchange(other.capacity_, 0);
-  head_ = std::exchange(other.head_, 0);
+  clear();
+  constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+  if (propagate || alloc_traits::is_always_equal::value || alloc_ == other.alloc_) {
+    deallocate();
+    if constexpr (propagate)
+      alloc_ = std::move(other.alloc_);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    head_ = std::exchange(other.head_, 0);
+  } else {
+    // The buffer belongs to an allocator that cannot free it here; move the elements instead.
+    append_range(std::ranges::subrange(std::make_move_iterator(other.begin()),
+                                       std::make_move_iterator(other.end())));
+    other.clear();
+  }
   return *this;
 }
 
-template <typename T> bool Deque<T>::empty() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::allocator_type Deque<T, Allocator>::get_allocator() const noexcept {
+  return alloc_;
+}
+
+template <typename T, typename Allocator> bool Deque<T, Allocator>::empty() const noexcept {
   return size_ == 0;
 }
 
-template <typename T> typename Deque<T>::size_type Deque<T>::size() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::size_type Deque<T, Allocator>::size() const noexcept {
   return size_;
 }
 
-template <typename T>
-typename Deque<T>::size_type Deque<T>::phys_index(size_type i) const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::size_type
+Deque<T, Allocator>::phys_index(size_type i) const noexcept {
   return capacity_ == 0 ? 0 : (head_ + i) % capacity_;
 }
 
-template <typename T> T& Deque<T>::operator[](size_type i) noexcept {
+template <typename T, typename Allocator> T& Deque<T, Allocator>::operator[](size_type i) noexcept {
   return data_[phys_index(i)];
 }
 
-template <typename T> const T& Deque<T>::operator[](size_type i) const noexcept {
+template <typename T, typename Allocator>
+const T& Deque<T, Allocator>::operator[](size_type i) const noexcept {
   return data_[phys_index(i)];
 }
 
-template <typename T> T& Deque<T>::at(size_type i) {
+template <typename T, typename Allocator> T& Deque<T, Allocator>::at(size_type i) {
   if (i >= size_)
     throw std::out_of_range("Deque::at out of range");
   return (*this)[i];
 }
 
-template <typename T> const T& Deque<T>::at(size_type i) const {
+template <typename T, typename Allocator> const T& Deque<T, Allocator>::at(size_type i) const {
   if (i >= size_)
     throw std::out_of_range("Deque::at out of range");
   return (*this)[i];
 }
 
-template <typename T> T& Deque<T>::front() {
+template <typename T, typename Allocator> T& Deque<T, Allocator>::front() {
   if (empty())
     throw std::out_of_range("Deque::front on empty");
   return (*this)[0];
 }
 
-template <typename T> const T& Deque<T>::front() const {
+template <typename T, typename Allocator> const T& Deque<T, Allocator>::front() const {
   if (empty())
     throw std::out_of_range("Deque::front on empty");
   return (*this)[0];
 }
 
-template <typename T> T& Deque<T>::back() {
+template <typename T, typename Allocator> T& Deque<T, Allocator>::back() {
   if (empty())
     throw std::out_of_range("Deque::back on empty");
   return (*this)[size_ - 1];
 }
 
-template <typename T> const T& Deque<T>::back() const {
+template <typename T, typename Allocator> const T& Deque<T, Allocator>::back() const {
   if (empty())
     throw std::out_of_range("Deque::back on empty");
   return (*this)[size_ - 1];
 }
 
-template <typename T> void Deque<T>::clear() noexcept {
+template <typename T, typename Allocator> void Deque<T, Allocator>::clear() noexcept {
   destroy_all();
   size_ = 0;
   head_ = 0;
 }
 
-template <typename T> void Deque<T>::push_back(const T& value) {
+template <typename T, typename Allocator> void Deque<T, Allocator>::push_back(const T& value) {
   ensure_capacity_for_one_more();
   const size_type pos = phys_index(size_);
   std::construct_at(data_ + pos, value);
   ++size_;
 }
 
-template <typename T> void Deque<T>::push_back(T&& value) {
+template <typename T, typename Allocator> void Deque<T, Allocator>::push_back(T&& value) {
   ensure_capacity_for_one_more();
   const size_type pos = phys_index(size_);
   std::construct_at(data_ + pos, std::move(value));
   ++size_;
 }
 
-template <typename T> void Deque<T>::push_front(const T& value) {
+template <typename T, typename Allocator> void Deque<T, Allocator>::push_front(const T& value) {
   ensure_capacity_for_one_more();
   head_ = (head_ + capacity_ - 1) % capacity_;
   std::construct_at(data_ + head_, value);
   ++size_;
 }
 
-template <typename T> void Deque<T>::push_front(T&& value) {
+template <typename T, typename Allocator> void Deque<T, Allocator>::push_front(T&& value) {
   ensure_capacity_for_one_more();
   head_ = (head_ + capacity_ - 1) % capacity_;
   std::construct_at(data_ + head_, std::move(value));
   ++size_;
 }
 
-template <typename T> void Deque<T>::pop_back() {
+template <typename T, typename Allocator> void Deque<T, Allocator>::pop_back() {
   if (empty())
     throw std::out_of_range("Deque::pop_back on empty");
   const size_type pos = phys_index(size_ - 1);
@@ -140,7 +179,7 @@ template <typename T> void Deque<T>::pop_back() {
     head_ = 0;
 }
 
-template <typename T> void Deque<T>::pop_front() {
+template <typename T, typename Allocator> void Deque<T, Allocator>::pop_front() {
   if (empty())
     throw std::out_of_range("Deque::pop_front on empty");
   std::destroy_at(data_ + head_);
@@ -150,64 +189,185 @@ template <typename T> void Deque<T>::pop_front() {
     head_ = 0;
 }
 
-template <typename T> typename Deque<T>::iterator Deque<T>::begin() noexcept {
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+void Deque<T, Allocator>::append_range(R&& rg) {
+  if constexpr (sized_or_forward_range<R>) {
+    const size_type n = range_length(rg);
+    if (n == 0)
+      return;
+    reserve_for(n);
+    copy_range_at(phys_index(size_), n, rg);
+    size_ += n;
+  } else {
+    for (auto&& v : rg) {
+      ensure_capacity_for_one_more();
+      std::construct_at(data_ + phys_index(size_), std::forward<decltype(v)>(v));
+      ++size_;
+    }
+  }
+}
+
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+void Deque<T, Allocator>::prepend_range(R&& rg) {
+  if constexpr (sized_or_forward_range<R>) {
+    const size_type n = range_length(rg);
+    if (n == 0)
+      return;
+    reserve_for(n);
+    const size_type start = (head_ + capacity_ - n) % capacity_;
+    copy_range_at(start, n, rg);
+    head_ = start;
+    size_ += n;
+  } else {
+    // Pushed one at a time onto the front, the elements come out reversed.
+    size_type count = 0;
+    for (auto&& v : rg) {
+      ensure_capacity_for_one_more();
+      head_ = (head_ + capacity_ - 1) % capacity_;
+      std::construct_at(data_ + head_, std::forward<decltype(v)>(v));
+      ++size_;
+      ++count;
+    }
+    std::reverse(begin(), begin() + static_cast<difference_type>(count));
+  }
+}
+
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+typename Deque<T, Allocator>::iterator
+Deque<T, Allocator>::insert_range(const_iterator pos, R&& rg) {
+  const size_type index = static_cast<size_type>(pos - cbegin());
+  if (index > size_)
+    throw std::out_of_range("Deque::insert_range position out of range");
+
+  const size_type old_size = size_;
+  const auto at = static_cast<difference_type>(index);
+  if (index < old_size - index) {
+    // Nearer the front: prepend, then rotate the elements before `pos` ahead of the new ones.
+    prepend_range(std::forward<R>(rg));
+    const auto n = static_cast<difference_type>(size_ - old_size);
+    std::rotate(begin(), begin() + n, begin() + n + at);
+  } else {
+    append_range(std::forward<R>(rg));
+    std::rotate(begin() + at, begin() + static_cast<difference_type>(old_size), end());
+  }
+  return begin() + at;
+}
+
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+void Deque<T, Allocator>::assign_range(R&& rg) {
+  clear();
+  append_range(std::forward<R>(rg));
+}
+
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::iterator Deque<T, Allocator>::begin() noexcept {
   return iterator(this, 0);
 }
 
-template <typename T> typename Deque<T>::iterator Deque<T>::end() noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::iterator Deque<T, Allocator>::end() noexcept {
   return iterator(this, size_);
 }
 
-template <typename T> typename Deque<T>::const_iterator Deque<T>::begin() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::begin() const noexcept {
   return const_iterator(this, 0);
 }
 
-template <typename T> typename Deque<T>::const_iterator Deque<T>::end() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::end() const noexcept {
   return const_iterator(this, size_);
 }
 
-template <typename T> typename Deque<T>::const_iterator Deque<T>::cbegin() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cbegin() const noexcept {
   return const_iterator(this, 0);
 }
 
-template <typename T> typename Deque<T>::const_iterator Deque<T>::cend() const noexcept {
+template <typename T, typename Allocator>
+typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cend() const noexcept {
   return const_iterator(this, size_);
 }
 
-template <typename T> void Deque<T>::ensure_capacity_for_one_more() {
+template <typename T, typename Allocator> void Deque<T, Allocator>::ensure_capacity_for_one_more() {
   if (size_ < capacity_)
     return;
   const size_type next = capacity_ == 0 ? 1 : (capacity_ * 2);
   grow(next);
 }
 
-template <typename T> void Deque<T>::grow(size_type new_capacity) {
-  T* next = alloc_.allocate(new_capacity);
+template <typename T, typename Allocator> void Deque<T, Allocator>::reserve_for(size_type n) {
+  if (n <= capacity_ - size_)
+    return;
+  grow(std::max(capacity_ * 2, size_ + n));
+}
+
+// Builds rg's `n` elements in the free slots starting at physical index `start`, which the
+// caller has reserved. On exception nothing is left constructed there.
+template <typename T, typename Allocator>
+template <typename R>
+void Deque<T, Allocator>::copy_range_at(size_type start, size_type n, R&& rg) {
+  const size_type first_run = std::min(n, capacity_ - start);
+  if constexpr (memcpy_range_v<R, T>) {
+    const T* src = std::ranges::data(rg);
+    std::memcpy(static_cast<void*>(data_ + start), static_cast<const void*>(src),
+                first_run * sizeof(T));
+    std::memcpy(static_cast<void*>(data_), static_cast<const void*>(src + first_run),
+                (n - first_run) * sizeof(T));
+  } else {
+    size_type built = 0;
+    try {
+      for (auto&& v : rg) {
+        const size_type slot = built < first_run ? start + built : built - first_run;
+        std::construct_at(data_ + slot, std::forward<decltype(v)>(v));
+        ++built;
+      }
+    } catch (...) {
+      for (size_type i = 0; i < built; ++i)
+        std::destroy_at(data_ + (i < first_run ? start + i : i - first_run));
+      throw;
+    }
+  }
+}
+
+template <typename T, typename Allocator> void Deque<T, Allocator>::grow(size_type new_capacity) {
+  T* next = alloc_traits::allocate(alloc_, new_capacity);
 
-  if constexpr (std::is_nothrow_move_constructible_v<T>) {
-    for (size_type i = 0; i < size_; ++i)
-      std::construct_at(next + i, std::move((*this)[i]));
+  if constexpr (is_trivially_relocatable_v<T>) {
+    // At most two runs: head_ to the end of the buffer, then the part that wrapped around.
+    const size_type first_run = std::min(size_, capacity_ - head_);
+    trivially_relocate(data_ + head_, data_ + head_ + first_run, next);
+    trivially_relocate(data_, data_ + (size_ - first_run), next + first_run);
   } else {
-    for (size_type i = 0; i < size_; ++i)
-      std::construct_at(next + i, (*this)[i]);
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      for (size_type i = 0; i < size_; ++i)
+        std::construct_at(next + i, std::move((*this)[i]));
+    } else {
+      for (size_type i = 0; i < size_; ++i)
+        std::construct_at(next + i, (*this)[i]);
+    }
+    destroy_all();
   }
 
-  destroy_all();
   deallocate();
   data_ = next;
   capacity_ = new_capacity;
   head_ = 0;
 }
 
-template <typename T> void Deque<T>::destroy_all() noexcept {
+template <typename T, typename Allocator> void Deque<T, Allocator>::destroy_all() noexcept {
   for (size_type i = 0; i < size_; ++i)
     std::destroy_at(data_ + phys_index(i));
 }
 
-template <typename T> void Deque<T>::deallocate() noexcept {
+template <typename T, typename Allocator> void Deque<T, Allocator>::deallocate() noexcept {
   if (!data_)
     return;
-  alloc_.deallocate(data_, capacity_);
+  alloc_traits::deallocate(alloc_, data_, capacity_);
   data_ = nullptr;
   capacity_ = 0;
 }
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "utility/transparent.hpp"
 #include "vector/vector.hpp"
 
 #include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 template <typename Key, typename T, typename Compare = std::less<Key>> class FlatMap {
@@ -64,6 +66,14 @@ public:
   bool contains(const Key& key) const noexcept {
     return find(key) != end();
   }
+  size_type count(const Key& key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+
+  iterator lower_bound(const Key& key) noexcept;
+  const_iterator lower_bound(const Key& key) const noexcept;
+  std::pair<iterator, iterator> equal_range(const Key& key) noexcept;
+  std::pair<const_iterator, const_iterator> equal_range(const Key& key) const noexcept;
 
   T& at(const Key& key);
   const T& at(const Key& key) const;
@@ -76,14 +86,44 @@ public:
     return data_.erase(pos);
   }
 
+  // Heterogeneous lookup, enabled when Compare is transparent (e.g. `std::less<>`).
+  template <typename Q>
+    requires transparent<Compare>
+  iterator find(const Q& key) noexcept;
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator find(const Q& key) const noexcept;
+  template <typename Q>
+    requires transparent<Compare>
+  bool contains(const Q& key) const noexcept {
+    return find(key) != end();
+  }
+  template <typename Q>
+    requires transparent<Compare>
+  size_type count(const Q& key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+  template <typename Q>
+    requires transparent<Compare>
+  iterator lower_bound(const Q& key) noexcept;
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator lower_bound(const Q& key) const noexcept;
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<iterator, iterator> equal_range(const Q& key) noexcept;
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<const_iterator, const_iterator> equal_range(const Q& key) const noexcept;
+  template <typename Q>
+    requires transparent<Compare> && (!std::is_convertible_v<const Q&, const_iterator>)
+  size_type erase(const Q& key);
+
 private:
   static bool keys_equal(const Compare& comp, const Key& a, const Key& b) {
     return !comp(a, b) && !comp(b, a);
   }
 
-  iterator lower_bound(const Key& key) noexcept;
-  const_iterator lower_bound(const Key& key) const noexcept;
-
   Vector<value_type> data_;
   Compare comp_{};
 };
@@ -168,3 +168,98 @@ typename FlatMap<Key, T, Compare>::size_type FlatMap<Key, T, Compare>::erase(con
   data_.erase(it);
   return 1;
 }
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename FlatMap<Key, T, Compare>::iterator,
+          typename FlatMap<Key, T, Compare>::iterator>
+FlatMap<Key, T, Compare>::equal_range(const Key& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && keys_equal(comp_, it->first, key))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename T, typename Compare>
+std::pair<typename FlatMap<Key, T, Compare>::const_iterator,
+          typename FlatMap<Key, T, Compare>::const_iterator>
+FlatMap<Key, T, Compare>::equal_range(const Key& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && keys_equal(comp_, it->first, key))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatMap<Key, T, Compare>::iterator
+FlatMap<Key, T, Compare>::lower_bound(const Q& key) noexcept {
+  return std::lower_bound(data_.begin(), data_.end(), key,
+                          [this](const value_type& v, const Q& k) { return comp_(v.first, k); });
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatMap<Key, T, Compare>::const_iterator
+FlatMap<Key, T, Compare>::lower_bound(const Q& key) const noexcept {
+  return std::lower_bound(data_.begin(), data_.end(), key,
+                          [this](const value_type& v, const Q& k) { return comp_(v.first, k); });
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatMap<Key, T, Compare>::iterator FlatMap<Key, T, Compare>::find(const Q& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, it->first))
+    return it;
+  return end();
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatMap<Key, T, Compare>::const_iterator
+FlatMap<Key, T, Compare>::find(const Q& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, it->first))
+    return it;
+  return end();
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+std::pair<typename FlatMap<Key, T, Compare>::iterator,
+          typename FlatMap<Key, T, Compare>::iterator>
+FlatMap<Key, T, Compare>::equal_range(const Q& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, it->first))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+std::pair<typename FlatMap<Key, T, Compare>::const_iterator,
+          typename FlatMap<Key, T, Compare>::const_iterator>
+FlatMap<Key, T, Compare>::equal_range(const Q& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, it->first))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename Q>
+  requires transparent<Compare> &&
+           (!std::is_convertible_v<const Q&, typename FlatMap<Key, T, Compare>::const_iterator>)
+typename FlatMap<Key, T, Compare>::size_type FlatMap<Key, T, Compare>::erase(const Q& key) {
+  auto it = find(key);
+  if (it == end())
+    return 0;
+  data_.erase(it);
+  return 1;
+}
@@ -82,3 +82,97 @@ typename FlatSet<Key, Compare>::size_type FlatSet<Key, Compare>::erase(const Key
   data_.erase(it);
   return 1;
 }
+
+template <typename Key, typename Compare>
+std::pair<typename FlatSet<Key, Compare>::iterator,
+          typename FlatSet<Key, Compare>::iterator>
+FlatSet<Key, Compare>::equal_range(const Key& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && keys_equal(comp_, *it, key))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename Compare>
+std::pair<typename FlatSet<Key, Compare>::const_iterator,
+          typename FlatSet<Key, Compare>::const_iterator>
+FlatSet<Key, Compare>::equal_range(const Key& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && keys_equal(comp_, *it, key))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatSet<Key, Compare>::iterator FlatSet<Key, Compare>::lower_bound(const Q& key) noexcept {
+  return std::lower_bound(data_.begin(), data_.end(), key,
+                          [this](const value_type& v, const Q& k) { return comp_(v, k); });
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatSet<Key, Compare>::const_iterator
+FlatSet<Key, Compare>::lower_bound(const Q& key) const noexcept {
+  return std::lower_bound(data_.begin(), data_.end(), key,
+                          [this](const value_type& v, const Q& k) { return comp_(v, k); });
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatSet<Key, Compare>::iterator FlatSet<Key, Compare>::find(const Q& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, *it))
+    return it;
+  return end();
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+typename FlatSet<Key, Compare>::const_iterator
+FlatSet<Key, Compare>::find(const Q& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, *it))
+    return it;
+  return end();
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+std::pair<typename FlatSet<Key, Compare>::iterator,
+          typename FlatSet<Key, Compare>::iterator>
+FlatSet<Key, Compare>::equal_range(const Q& key) noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, *it))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare>
+std::pair<typename FlatSet<Key, Compare>::const_iterator,
+          typename FlatSet<Key, Compare>::const_iterator>
+FlatSet<Key, Compare>::equal_range(const Q& key) const noexcept {
+  auto it = lower_bound(key);
+  if (it != end() && !comp_(key, *it))
+    return {it, it + 1};
+  return {it, it};
+}
+
+template <typename Key, typename Compare>
+template <typename Q>
+  requires transparent<Compare> &&
+           (!std::is_convertible_v<const Q&, typename FlatSet<Key, Compare>::const_iterator>)
+typename FlatSet<Key, Compare>::size_type FlatSet<Key, Compare>::erase(const Q& key) {
+  auto it = find(key);
+  if (it == end())
+    return 0;
+  data_.erase(it);
+  return 1;
+}
@@ -58,6 +58,26 @@ private:
     T value;
   };
 
+public:
+  // Heap bytes behind each element, for containers that account for their memory use.
+  static constexpr std::size_t node_size = sizeof(Node);
+
+  // Whole-node moves, for containers that relink elements between lists instead of copying them
+  // (see unordered_multimap::extract). A detached node belongs to the caller until it is linked
+  // into a list again or passed to destroy_node.
+  using node_pointer = Node*;
+
+  node_pointer unlink_after(iterator pos) noexcept;
+  iterator link_after(iterator pos, node_pointer node) noexcept;
+
+  static T& node_value(node_pointer node) noexcept {
+    return node->value;
+  }
+  static void destroy_node(node_pointer node) noexcept {
+    delete node;
+  }
+
+private:
   NodeBase head_;
 
   static Node* as_node(NodeBase* p) {
@@ -114,6 +114,24 @@ template <typename T> typename ForwardList<T>::iterator ForwardList<T>::erase_af
   return iterator(before->next);
 }
 
+template <typename T>
+typename ForwardList<T>::node_pointer ForwardList<T>::unlink_after(iterator pos) noexcept {
+  NodeBase* before = pos.node_;
+  NodeBase* node = before->next;
+  before->next = node->next;
+  node->next = nullptr;
+  return as_node(node);
+}
+
+template <typename T>
+typename ForwardList<T>::iterator ForwardList<T>::link_after(iterator pos,
+                                                             node_pointer node) noexcept {
+  NodeBase* before = pos.node_;
+  node->next = before->next;
+  before->next = node;
+  return iterator(node);
+}
+
 template <typename T>
 typename ForwardList<T>::iterator ForwardList<T>::insert_after(iterator pos, const T& value) {
   return insert_after(pos, T(value));
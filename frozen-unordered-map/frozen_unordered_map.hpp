@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "span/span.hpp"
+#include "vector/vector.hpp"
+
+// An offset/length pair addressing bytes in a frozen blob's arena.
+struct frozen_extent {
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+// How frozen_unordered_map stores a value of type V and what lookups hand back for it.
+// Trivially copyable values live inline in their slot; `std::string` and `Vector<T>` values
+// are copied into the arena and viewed as `std::string_view` / `Span<const T>`.
+template <typename V> struct frozen_value_traits {
+  static_assert(std::is_trivially_copyable_v<V>,
+                "frozen_unordered_map: values must be trivially copyable, std::string, or Vector");
+  static_assert(alignof(V) <= alignof(std::max_align_t));
+
+  static constexpr std::uint32_t kind = 0;
+  using stored_type = V;
+  using view_type = std::reference_wrapper<const V>;
+
+  static std::size_t arena_bytes(const V&, std::size_t) noexcept {
+    return 0;
+  }
+  static V store(const V& value, std::byte*, std::size_t&) noexcept {
+    return value;
+  }
+  static view_type view(const V& stored, const std::byte*) noexcept {
+    return std::cref(stored);
+  }
+};
+
+template <> struct frozen_value_traits<std::string> {
+  static constexpr std::uint32_t kind = 1;
+  using stored_type = frozen_extent;
+  using view_type = std::string_view;
+
+  static std::size_t arena_bytes(const std::string& value, std::size_t) noexcept {
+    return value.size();
+  }
+  static frozen_extent store(const std::string& value, std::byte* arena, std::size_t& used) {
+    const frozen_extent e{used, value.size()};
+    std::memcpy(arena + used, value.data(), value.size());
+    used += value.size();
+    return e;
+  }
+  static view_type view(const frozen_extent& e, const std::byte* arena) noexcept {
+    return {reinterpret_cast<const char*>(arena + e.offset), static_cast<std::size_t>(e.size)};
+  }
+};
+
+template <typename T> struct frozen_value_traits<Vector<T>> {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "frozen_unordered_map: Vector values need trivially copyable elements");
+  static_assert(alignof(T) <= alignof(std::max_align_t));
+
+  static constexpr std::uint32_t kind = 2;
+  using stored_type = frozen_extent;
+  using view_type = Span<const T>;
+
+  static std::size_t arena_bytes(const Vector<T>& value, std::size_t used) noexcept {
+    return padding(used) + value.size() * sizeof(T);
+  }
+  static frozen_extent store(const Vector<T>& value, std::byte* arena, std::size_t& used) {
+    used += padding(used);
+    const frozen_extent e{used, value.size()};
+    if (!value.empty())
+      std::memcpy(arena + used, value.data(), value.size() * sizeof(T));
+    used += value.size() * sizeof(T);
+    return e;
+  }
+  static view_type view(const frozen_extent& e, const std::byte* arena) noexcept {
+    return {reinterpret_cast<const T*>(arena + e.offset), static_cast<std::size_t>(e.size)};
+  }
+
+private:
+  static std::size_t padding(std::size_t used) noexcept {
+    return (alignof(T) - used % alignof(T)) % alignof(T);
+  }
+};
+
+// Immutable string-keyed hash map that lives entirely inside one contiguous, position-independent
+// byte blob: a header, an open-addressing slot array, and an arena holding key bytes (and
+// out-of-line values). Every reference inside the blob is an offset, so `freeze` can write it to
+// a file once and later processes can mmap it (see `utility/mapped_file.hpp`) and query it in
+// place, with no parsing and no allocation.
+//
+// The map only views its blob; the blob must outlive it. Blobs record byte order and layout and
+// are rejected on mismatch, but the slots and arena themselves are trusted.
+template <typename V> class frozen_unordered_map {
+  using traits = frozen_value_traits<V>;
+  using stored_type = typename traits::stored_type;
+
+public:
+  using key_type = std::string_view;
+  using mapped_type = V;
+  using value_view = typename traits::view_type;
+  using size_type = std::size_t;
+
+  frozen_unordered_map() noexcept = default;
+
+  // Views an existing blob; throws std::invalid_argument if it was not produced by `freeze` for
+  // this value type on a machine with the same byte order.
+  explicit frozen_unordered_map(Span<const std::byte> blob) {
+    if (blob.size() < sizeof(header))
+      fail("blob too small");
+    if (reinterpret_cast<std::uintptr_t>(blob.data()) % kBlobAlign != 0)
+      fail("blob misaligned");
+
+    header h;
+    std::memcpy(&h, blob.data(), sizeof(h));
+    if (std::memcmp(h.magic, kMagic, sizeof(h.magic)) != 0)
+      fail("bad magic");
+    if (h.version != kVersion || h.byte_order != kByteOrder || h.value_kind != traits::kind ||
+        h.slot_size != sizeof(slot))
+      fail("incompatible layout");
+    if (!std::has_single_bit(h.capacity) || h.size >= h.capacity ||
+        h.slots_offset % alignof(slot) != 0 || h.arena_offset < h.slots_offset ||
+        (h.arena_offset - h.slots_offset) / sizeof(slot) < h.capacity ||
+        h.arena_offset > blob.size() || h.arena_size > blob.size() - h.arena_offset)
+      fail("corrupt header");
+
+    slots_ = reinterpret_cast<const slot*>(blob.data() + h.slots_offset);
+    arena_ = blob.data() + h.arena_offset;
+    size_ = static_cast<size_type>(h.size);
+    mask_ = static_cast<size_type>(h.capacity - 1);
+  }
+  // Would view a blob that dies at the end of the full-expression.
+  explicit frozen_unordered_map(Vector<std::byte>&&) = delete;
+
+  // Serializes `map`, any range of pairs with string-like keys and unique V values such as an
+  // `unordered_map<std::string, V>`, into a blob. Throws std::invalid_argument on a duplicate key.
+  template <typename Map> static Vector<std::byte> freeze(const Map& map) {
+    size_type n = 0;
+    size_type arena_size = 0;
+    for (const auto& [key, value] : map) {
+      arena_size += std::string_view(key).size();
+      arena_size += traits::arena_bytes(value, arena_size);
+      ++n;
+    }
+
+    const size_type capacity = std::bit_ceil(std::max<size_type>(2 * n, 1));
+    const size_type slots_offset = align_up(sizeof(header), alignof(slot));
+    const size_type arena_offset = align_up(slots_offset + capacity * sizeof(slot), kBlobAlign);
+
+    Vector<std::byte> blob;
+    blob.resize(arena_offset + arena_size);
+
+    header h{};
+    std::memcpy(h.magic, kMagic, sizeof(h.magic));
+    h.version = kVersion;
+    h.byte_order = kByteOrder;
+    h.slot_size = sizeof(slot);
+    h.value_kind = traits::kind;
+    h.size = n;
+    h.capacity = capacity;
+    h.slots_offset = slots_offset;
+    h.arena_offset = arena_offset;
+    h.arena_size = arena_size;
+    std::memcpy(blob.data(), &h, sizeof(h));
+
+    // Tags and key extents are mirrored here so probing never reads back partially built slots.
+    Vector<std::uint64_t> tags;
+    Vector<frozen_extent> keys;
+    tags.resize(capacity);
+    keys.resize(capacity);
+
+    std::byte* slots = blob.data() + slots_offset;
+    std::byte* arena = blob.data() + arena_offset;
+    size_type used = 0;
+    for (const auto& [key, value] : map) {
+      const std::string_view k(key);
+      const frozen_extent key_extent{used, k.size()};
+      if (!k.empty())
+        std::memcpy(arena + used, k.data(), k.size());
+      used += k.size();
+
+      const std::uint64_t tag = tag_of(k);
+      size_type pos = home(tag, capacity - 1);
+      for (; tags[pos] != 0; pos = (pos + 1) & (capacity - 1)) {
+        if (tags[pos] == tag && key_at(keys[pos], arena) == k)
+          throw std::invalid_argument("frozen_unordered_map::freeze duplicate key");
+      }
+      tags[pos] = tag;
+      keys[pos] = key_extent;
+
+      const slot s{tag, key_extent, traits::store(value, arena, used)};
+      std::memcpy(slots + pos * sizeof(slot), &s, sizeof(s));
+    }
+    return blob;
+  }
+
+  std::optional<value_view> find(std::string_view key) const noexcept {
+    const slot* s = find_slot(key);
+    if (!s)
+      return std::nullopt;
+    return traits::view(s->value, arena_);
+  }
+
+  bool contains(std::string_view key) const noexcept {
+    return find_slot(key) != nullptr;
+  }
+
+  value_view at(std::string_view key) const {
+    const slot* s = find_slot(key);
+    if (!s)
+      throw std::out_of_range("frozen_unordered_map::at key not found");
+    return traits::view(s->value, arena_);
+  }
+
+  // Calls `fn(std::string_view, value_view)` for every element, in slot order.
+  template <typename Fn> void for_each(Fn&& fn) const {
+    if (!slots_)
+      return;
+    for (size_type i = 0; i <= mask_; ++i) {
+      const slot& s = slots_[i];
+      if (s.tag != 0)
+        fn(key_at(s.key, arena_), traits::view(s.value, arena_));
+    }
+  }
+
+  size_type size() const noexcept {
+    return size_;
+  }
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+
+private:
+  static constexpr char kMagic[8] = {'S', 'T', 'L', 'F', 'R', 'O', 'Z', '\0'};
+  static constexpr std::uint32_t kVersion = 1;
+  static constexpr std::uint32_t kByteOrder = 0x01020304;
+  static constexpr size_type kBlobAlign = alignof(std::max_align_t);
+
+  struct header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t slot_size;
+    std::uint32_t value_kind;
+    std::uint64_t size;
+    std::uint64_t capacity;
+    std::uint64_t slots_offset;
+    std::uint64_t arena_offset;
+    std::uint64_t arena_size;
+  };
+
+  // `tag` is the key's hash with the low bit forced on, so a zeroed slot reads as empty.
+  struct slot {
+    std::uint64_t tag;
+    frozen_extent key;
+    stored_type value;
+  };
+
+  const slot* slots_ = nullptr;
+  const std::byte* arena_ = nullptr;
+  size_type size_ = 0;
+  size_type mask_ = 0;
+
+  [[noreturn]] static void fail(const char* what) {
+    throw std::invalid_argument(std::string("frozen_unordered_map: ") + what);
+  }
+
+  static size_type align_up(size_type n, size_type align) noexcept {
+    return (n + align - 1) / align * align;
+  }
+
+  static std::string_view key_at(const frozen_extent& e, const std::byte* arena) noexcept {
+    return {reinterpret_cast<const char*>(arena + e.offset), static_cast<std::size_t>(e.size)};
+  }
+
+  // The hash is part of the file format, so it is fixed here rather than taken from std::hash:
+  // 8-byte words folded with a multiply/xor-shift round, then a splitmix64 finalizer.
+  static std::uint64_t tag_of(std::string_view key) noexcept {
+    constexpr std::uint64_t kMul = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t h = kMul ^ key.size();
+    std::size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) {
+      std::uint64_t w;
+      std::memcpy(&w, key.data() + i, 8);
+      h = (h ^ w) * kMul;
+      h ^= h >> 29;
+    }
+    if (i < key.size()) {
+      std::uint64_t w = 0;
+      std::memcpy(&w, key.data() + i, key.size() - i);
+      h = (h ^ w) * kMul;
+      h ^= h >> 29;
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h | 1;
+  }
+
+  // Skips the forced low bit, which would otherwise leave every even slot without a home.
+  static size_type home(std::uint64_t tag, size_type mask) noexcept {
+    return static_cast<size_type>(tag >> 1) & mask;
+  }
+
+  const slot* find_slot(std::string_view key) const noexcept {
+    if (!slots_)
+      return nullptr;
+    const std::uint64_t tag = tag_of(key);
+    for (size_type pos = home(tag, mask_);; pos = (pos + 1) & mask_) {
+      const slot& s = slots_[pos];
+      if (s.tag == 0)
+        return nullptr;
+      if (s.tag == tag && key_at(s.key, arena_) == key)
+        return &s;
+    }
+  }
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "rb-tree/rb_tree.hpp"
+
+// Half-open range of keys, [lo, hi).
+template <typename K> struct interval {
+  K lo;
+  K hi;
+
+  friend bool operator==(const interval&, const interval&) = default;
+};
+
+// Map from intervals [lo, hi) to values that finds the intervals overlapping a query without a
+// full scan. Elements are ordered by lo, then by hi, and equal intervals may be stored more than
+// once, as in a multimap. The tree is an RbTree whose nodes also keep the largest hi in their
+// subtree, so overlapping() skips every subtree that ends at or before the query starts and
+// stops at the first interval that starts at or after the query ends.
+//
+// The subtree maximum is kept by a policy with no access to the map, so Compare is
+// default-constructed wherever it is needed.
+template <typename K, typename V, typename Compare = std::less<K>> class interval_map {
+public:
+  using key_type = interval<K>;
+  using mapped_type = V;
+  using value_type = std::pair<const interval<K>, V>;
+  using size_type = std::size_t;
+
+private:
+  struct key_of_value {
+    const interval<K>& operator()(const value_type& v) const noexcept {
+      return v.first;
+    }
+  };
+
+  struct interval_less {
+    bool operator()(const interval<K>& a, const interval<K>& b) const {
+      Compare comp;
+      if (comp(a.lo, b.lo))
+        return true;
+      if (comp(b.lo, a.lo))
+        return false;
+      return comp(a.hi, b.hi);
+    }
+  };
+
+  // Summary policy for RbTree: the largest hi in a subtree.
+  struct max_hi {
+    using type = K;
+    static K of(const value_type& v) noexcept {
+      return v.first.hi;
+    }
+    static void add(K& into, const K& child) noexcept {
+      if (Compare()(into, child))
+        into = child;
+    }
+  };
+
+  using tree_type = RbTree<value_type, key_of_value, interval_less, true, false, max_hi>;
+  tree_type tree_{};
+
+  // An interval [a, b) overlaps the query [lo, hi) when a < hi and lo < b. Subtrees whose
+  // largest b is not past lo hold none, and once a reaches hi no later interval can overlap.
+  template <typename Tree, typename It>
+  static auto next_overlap(Tree& tree, const interval<K>& q, const It* after) {
+    Compare comp;
+    auto reach = [&](const K& hi) { return comp(q.lo, hi); };
+    auto past = [&](const value_type& v) { return !comp(v.first.lo, q.hi); };
+    auto hit = [&](const value_type& v) { return comp(q.lo, v.first.hi); };
+    return after ? tree.next_where(*after, reach, past, hit) : tree.first_where(reach, past, hit);
+  }
+
+public:
+  using iterator = typename tree_type::iterator;
+  using const_iterator = typename tree_type::const_iterator;
+
+  // Forward iterator over the intervals overlapping one query, in map order. It finds each next
+  // overlap when advanced, so nothing is collected up front. base() is the element's position
+  // in the map, for erase(). Inserting or erasing invalidates it, as erase(base()) does.
+  template <bool Const> class overlap_iterator {
+    using map_type = std::conditional_t<Const, const interval_map, interval_map>;
+    using base_type = std::conditional_t<Const, const_iterator, iterator>;
+
+  public:
+    using value_type = interval_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+    using iterator_category = std::forward_iterator_tag;
+
+    overlap_iterator() = default;
+
+    reference operator*() const {
+      return *it_;
+    }
+    pointer operator->() const {
+      return std::addressof(*it_);
+    }
+
+    overlap_iterator& operator++() {
+      const const_iterator at = it_;
+      it_ = next_overlap(map_->tree_, query_, &at);
+      return *this;
+    }
+    overlap_iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    base_type base() const noexcept {
+      return it_;
+    }
+
+    bool operator==(const overlap_iterator& other) const {
+      return it_ == other.it_;
+    }
+    bool operator!=(const overlap_iterator& other) const {
+      return it_ != other.it_;
+    }
+
+  private:
+    friend class interval_map;
+    overlap_iterator(map_type* map, const interval<K>& query)
+        : map_(map), query_(query),
+          it_(next_overlap(map->tree_, query, static_cast<const const_iterator*>(nullptr))) {}
+
+    map_type* map_ = nullptr;
+    interval<K> query_{};
+    base_type it_{};
+  };
+
+  // What overlapping() returns: a view of the overlapping intervals, found one at a time as it
+  // is iterated. The first is located when the range is made, in O(log n).
+  template <bool Const> class overlap_range {
+  public:
+    overlap_iterator<Const> begin() const noexcept {
+      return first_;
+    }
+    overlap_iterator<Const> end() const noexcept {
+      return {};
+    }
+    bool empty() const noexcept {
+      return first_ == end();
+    }
+
+  private:
+    friend class interval_map;
+    explicit overlap_range(overlap_iterator<Const> first) : first_(std::move(first)) {}
+    overlap_iterator<Const> first_;
+  };
+
+  interval_map() = default;
+
+  bool empty() const noexcept {
+    return tree_.empty();
+  }
+  size_type size() const noexcept {
+    return tree_.size();
+  }
+
+  iterator begin() noexcept {
+    return tree_.begin();
+  }
+  const_iterator begin() const noexcept {
+    return tree_.begin();
+  }
+  iterator end() noexcept {
+    return tree_.end();
+  }
+  const_iterator end() const noexcept {
+    return tree_.end();
+  }
+
+  void clear() noexcept {
+    tree_.clear();
+  }
+
+  // Throws std::invalid_argument, inserting nothing, unless lo orders before hi.
+  iterator insert(value_type value) {
+    if (!Compare()(value.first.lo, value.first.hi))
+      throw std::invalid_argument("interval_map::insert: empty interval");
+    return tree_.insert_multi(std::move(value));
+  }
+  iterator insert(const K& lo, const K& hi, V value) {
+    return insert(value_type(interval<K>{lo, hi}, std::move(value)));
+  }
+
+  // The first element stored under an interval equivalent to `key` under Compare, or end().
+  iterator find(const interval<K>& key) {
+    auto it = tree_.lower_bound(key);
+    return it != end() && !interval_less{}(key, it->first) ? it : end();
+  }
+  const_iterator find(const interval<K>& key) const {
+    auto it = tree_.lower_bound(key);
+    return it != end() && !interval_less{}(key, it->first) ? it : end();
+  }
+
+  iterator erase(iterator pos) {
+    return tree_.erase(pos);
+  }
+
+  // Erases every element stored under an interval equivalent to `key` and returns how many there
+  // were.
+  size_type erase(const interval<K>& key) {
+    size_type erased = 0;
+    for (auto it = find(key); it != end() && !interval_less{}(key, it->first); ++erased)
+      it = tree_.erase(it);
+    return erased;
+  }
+
+  // Every element whose interval [a, b) has a < hi and lo < b: for lo before hi, those sharing
+  // at least one point with [lo, hi). O(log n) per element visited at worst, and O(log n) to
+  // find that there are none.
+  overlap_range<false> overlapping(const K& lo, const K& hi) {
+    return overlap_range<false>(overlap_iterator<false>(this, interval<K>{lo, hi}));
+  }
+  overlap_range<true> overlapping(const K& lo, const K& hi) const {
+    return overlap_range<true>(overlap_iterator<true>(this, interval<K>{lo, hi}));
+  }
+};
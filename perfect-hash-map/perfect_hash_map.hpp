@@ -0,0 +1,464 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "unordered-map/hash_policy.hpp"
+#include "utility/transparent.hpp"
+#include "vector/vector.hpp"
+
+// A hash usable in constant expressions (std::hash is not): integers and enums hash to their
+// value, anything convertible to std::string_view to its FNV-1a hash. The default hasher of
+// static_perfect_hash_map; transparent so `const char*` and `std::string` probe string_view keys.
+struct constexpr_hash {
+  using is_transparent = void;
+
+  template <typename T>
+    requires std::is_integral_v<T> || std::is_enum_v<T>
+  constexpr std::size_t operator()(T value) const noexcept {
+    return static_cast<std::size_t>(value);
+  }
+
+  constexpr std::size_t operator()(std::string_view s) const noexcept {
+    std::uint64_t h = 0xCBF29CE484222325ULL;
+    for (char c : s) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001B3ULL;
+    }
+    return static_cast<std::size_t>(h);
+  }
+};
+
+// Hash-and-displace (CHD-style) construction shared by perfect_hash_map and
+// static_perfect_hash_map.
+//
+// Keys are hashed to 64 bits (the user hash, finalized by `BucketPolicy::mix`, then reseeded) and
+// split into buckets of about kBucketLoad keys. Buckets are placed largest first: each gets the
+// smallest "pilot" that sends all of its keys to free slots, slot = reduce(remix(hash ^ pilot), n).
+// A lookup recomputes the key's bucket, reads its pilot, and lands on exactly one of n slots: one
+// probe, no empty slots, and 16 bits of pilot per key. Larger buckets would shrink the pilot
+// array but multiply the tries needed to place the last buckets into a nearly full table.
+//
+// Everything here is constexpr and allocation-free; callers supply the arrays.
+template <typename Hash, typename BucketPolicy> struct perfect_hash_core {
+  static constexpr std::size_t kBucketLoad = 2;
+  static constexpr std::size_t kMaxSeeds = 8;
+
+  static constexpr std::size_t bucket_count(std::size_t n) noexcept {
+    return (n + kBucketLoad - 1) / kBucketLoad;
+  }
+  static constexpr std::size_t scratch_size(std::size_t n) noexcept {
+    return 3 * bucket_count(n) + 3 * n + 3;
+  }
+  static constexpr std::uint64_t seed(std::size_t attempt) noexcept {
+    return attempt * 0xD1B54A32D192ED03ULL;
+  }
+
+  template <typename Q>
+  static constexpr std::uint64_t hash(const Hash& hasher, const Q& key, std::uint64_t seed) {
+    const std::size_t mixed = BucketPolicy{}.mix(hasher(key));
+    return remix(static_cast<std::uint64_t>(mixed) + seed);
+  }
+  static constexpr std::size_t bucket(std::uint64_t h, std::size_t buckets) noexcept {
+    return static_cast<std::size_t>(reduce(h, buckets));
+  }
+  static constexpr std::size_t slot(std::uint64_t h, std::uint32_t pilot, std::size_t n) noexcept {
+    return static_cast<std::size_t>(reduce(remix(h ^ (pilot * 0x9E3779B97F4A7C15ULL)), n));
+  }
+
+  // Fills pilots[bucket_count(n)] and positions[n] (the slot of key i) from the keys' hashes,
+  // using scratch[scratch_size(n)]. Returns bucket_count(n) on success. Otherwise returns a bucket
+  // no pilot can place because two of its keys share a full hash: the caller either reports them
+  // as duplicates or retries with another seed.
+  static constexpr std::size_t build(const std::uint64_t* hashes, std::size_t n,
+                                     std::uint32_t* pilots, std::uint32_t* positions,
+                                     std::uint32_t* scratch) {
+    const std::size_t buckets = bucket_count(n);
+    std::uint32_t* start = scratch;               // [buckets + 1] bucket offsets into members
+    std::uint32_t* members = start + buckets + 1; // [n] key indices grouped by bucket
+    std::uint32_t* order = members + n;           // [buckets] bucket ids, largest first
+    std::uint32_t* by_size = order + buckets;     // [n + 2] counting-sort cursors per size
+    std::uint32_t* taken = by_size + n + 2;       // [n] bucket fill cursors, then slot bitmap
+
+    for (std::size_t b = 0; b <= buckets; ++b)
+      start[b] = 0;
+    for (std::size_t i = 0; i < n; ++i)
+      ++start[bucket(hashes[i], buckets) + 1];
+
+    for (std::size_t s = 0; s < n + 2; ++s)
+      by_size[s] = 0;
+    for (std::size_t b = 0; b < buckets; ++b)
+      ++by_size[start[b + 1]];
+    std::uint32_t offset = 0;
+    for (std::size_t s = n + 2; s-- > 0;) {
+      const std::uint32_t count = by_size[s];
+      by_size[s] = offset;
+      offset += count;
+    }
+    for (std::size_t b = 0; b < buckets; ++b)
+      order[by_size[start[b + 1]]++] = static_cast<std::uint32_t>(b);
+
+    for (std::size_t b = 0; b < buckets; ++b)
+      start[b + 1] += start[b];
+    for (std::size_t b = 0; b < buckets; ++b)
+      taken[b] = start[b];
+    for (std::size_t i = 0; i < n; ++i)
+      members[taken[bucket(hashes[i], buckets)]++] = static_cast<std::uint32_t>(i);
+    for (std::size_t i = 0; i < n; ++i)
+      taken[i] = 0;
+    // One bit per slot keeps the randomly probed occupancy map cache-resident.
+    auto is_taken = [taken](std::size_t s) { return (taken[s / 32] >> (s % 32)) & 1U; };
+    auto flip = [taken](std::size_t s) { taken[s / 32] ^= std::uint32_t{1} << (s % 32); };
+
+    // A lone key among f free slots needs about n / f tries, so the final singletons dominate;
+    // the cap only guards against a broken hash.
+    const std::uint64_t max_pilot = std::min<std::uint64_t>(
+        64 * static_cast<std::uint64_t>(n) + 1024, std::numeric_limits<std::uint32_t>::max());
+    for (std::size_t k = 0; k < buckets; ++k) {
+      const std::uint32_t b = order[k];
+      const std::uint32_t first = start[b];
+      const std::uint32_t last = start[b + 1];
+      pilots[b] = 0;
+      for (std::uint32_t i = first; i < last; ++i)
+        for (std::uint32_t j = i + 1; j < last; ++j)
+          if (hashes[members[i]] == hashes[members[j]])
+            return b;
+
+      for (std::uint64_t pilot = 0; first != last; ++pilot) {
+        if (pilot == max_pilot)
+          return b;
+        std::uint32_t placed = first;
+        for (; placed < last; ++placed) {
+          const std::uint32_t key = members[placed];
+          const std::size_t s = slot(hashes[key], static_cast<std::uint32_t>(pilot), n);
+          if (is_taken(s))
+            break;
+          flip(s);
+          positions[key] = static_cast<std::uint32_t>(s);
+        }
+        if (placed == last) {
+          pilots[b] = static_cast<std::uint32_t>(pilot);
+          break;
+        }
+        while (placed-- > first)
+          flip(positions[members[placed]]);
+      }
+    }
+    return buckets;
+  }
+
+private:
+  static constexpr std::uint64_t remix(std::uint64_t h) noexcept {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+  }
+
+  // Lemire's multiply-shift range reduction: (h * n) >> 64 maps h onto [0, n) without division.
+  static constexpr std::uint64_t reduce(std::uint64_t h, std::uint64_t n) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;
+    return static_cast<std::uint64_t>((static_cast<u128>(h) * n) >> 64);
+#else
+    const std::uint64_t h_lo = h & 0xFFFFFFFFULL;
+    const std::uint64_t h_hi = h >> 32;
+    const std::uint64_t n_lo = n & 0xFFFFFFFFULL;
+    const std::uint64_t n_hi = n >> 32;
+    const std::uint64_t lo_lo = h_lo * n_lo;
+    const std::uint64_t hi_lo = h_hi * n_lo;
+    const std::uint64_t lo_hi = h_lo * n_hi;
+    const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    return h_hi * n_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+  }
+};
+
+// Read-only map over a key set fixed at construction, backed by a minimal perfect hash: exactly
+// size() slots, and every lookup hashes once and compares against exactly one slot. Built from a
+// Vector of pairs in expected O(n); duplicate keys throw std::invalid_argument.
+template <typename K, typename V, typename Hash = std::hash<K>,
+          typename KeyEqual = std::equal_to<K>,
+          typename BucketPolicy = power_of_two_bucket_policy>
+class perfect_hash_map {
+  using core = perfect_hash_core<Hash, BucketPolicy>;
+
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using iterator = typename Vector<value_type>::iterator;
+  using const_iterator = typename Vector<value_type>::const_iterator;
+
+  perfect_hash_map() = default;
+
+  explicit perfect_hash_map(Vector<value_type> items, Hash hash = Hash{},
+                            KeyEqual equal = KeyEqual{})
+      : hash_(std::move(hash)), equal_(std::move(equal)) {
+    build(std::move(items));
+  }
+
+  // Slot order, which is unrelated to insertion order.
+  iterator begin() noexcept {
+    return slots_.begin();
+  }
+  const_iterator begin() const noexcept {
+    return slots_.begin();
+  }
+  const_iterator cbegin() const noexcept {
+    return slots_.cbegin();
+  }
+  iterator end() noexcept {
+    return slots_.end();
+  }
+  const_iterator end() const noexcept {
+    return slots_.end();
+  }
+  const_iterator cend() const noexcept {
+    return slots_.cend();
+  }
+
+  size_type size() const noexcept {
+    return slots_.size();
+  }
+  bool empty() const noexcept {
+    return slots_.empty();
+  }
+
+  iterator find(const K& key) {
+    return find_impl(key);
+  }
+  const_iterator find(const K& key) const {
+    return find_impl(key);
+  }
+  bool contains(const K& key) const {
+    return find(key) != end();
+  }
+  size_type count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
+  V& at(const K& key) {
+    return at_impl(key);
+  }
+  const V& at(const K& key) const {
+    return at_impl(key);
+  }
+
+  // Heterogeneous lookup, enabled when both Hash and KeyEqual are transparent.
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  iterator find(const Q& key) {
+    return find_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  const_iterator find(const Q& key) const {
+    return find_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool contains(const Q& key) const {
+    return find(key) != end();
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type count(const Q& key) const {
+    return contains(key) ? 1 : 0;
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  V& at(const Q& key) {
+    return at_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  const V& at(const Q& key) const {
+    return at_impl(key);
+  }
+
+private:
+  Vector<value_type> slots_;
+  Vector<std::uint32_t> pilots_;
+  std::uint64_t seed_ = 0;
+  Hash hash_{};
+  KeyEqual equal_{};
+
+  void build(Vector<value_type> items) {
+    const size_type n = items.size();
+    if (n == 0)
+      return;
+    if (n > std::numeric_limits<std::uint32_t>::max())
+      throw std::length_error("perfect_hash_map: too many keys");
+
+    Vector<std::uint64_t> hashes;
+    Vector<std::uint32_t> positions;
+    Vector<std::uint32_t> scratch;
+    hashes.resize(n);
+    positions.resize(n);
+    scratch.resize(core::scratch_size(n));
+    pilots_.resize(core::bucket_count(n));
+
+    for (size_type attempt = 0;; ++attempt) {
+      if (attempt == core::kMaxSeeds)
+        throw std::runtime_error("perfect_hash_map: no perfect hash found");
+      seed_ = core::seed(attempt);
+      for (size_type i = 0; i < n; ++i)
+        hashes[i] = core::hash(hash_, items[i].first, seed_);
+      const size_type failed =
+          core::build(hashes.data(), n, pilots_.data(), positions.data(), scratch.data());
+      if (failed == pilots_.size())
+        break;
+      check_duplicates(items, hashes, failed);
+    }
+
+    // Permute each item into its slot by following cycles, so nothing is copied.
+    for (size_type i = 0; i < n; ++i) {
+      while (positions[i] != i) {
+        const std::uint32_t j = positions[i];
+        std::swap(items[i], items[j]);
+        std::swap(positions[i], positions[j]);
+      }
+    }
+    slots_ = std::move(items);
+  }
+
+  // Keys of bucket `b` with equal hashes are either duplicates or a genuine 64-bit collision.
+  void check_duplicates(const Vector<value_type>& items, const Vector<std::uint64_t>& hashes,
+                        size_type b) const {
+    for (size_type i = 0; i < items.size(); ++i) {
+      if (core::bucket(hashes[i], pilots_.size()) != b)
+        continue;
+      for (size_type j = i + 1; j < items.size(); ++j)
+        if (hashes[j] == hashes[i] && equal_(items[i].first, items[j].first))
+          throw std::invalid_argument("perfect_hash_map: duplicate key");
+    }
+  }
+
+  template <typename Q> size_type slot_of(const Q& key) const {
+    const std::uint64_t h = core::hash(hash_, key, seed_);
+    const std::uint32_t pilot = pilots_[core::bucket(h, pilots_.size())];
+    return core::slot(h, pilot, slots_.size());
+  }
+
+  template <typename Q> iterator find_impl(const Q& key) {
+    if (slots_.empty())
+      return end();
+    const size_type s = slot_of(key);
+    return equal_(slots_[s].first, key) ? begin() + s : end();
+  }
+  template <typename Q> const_iterator find_impl(const Q& key) const {
+    if (slots_.empty())
+      return end();
+    const size_type s = slot_of(key);
+    return equal_(slots_[s].first, key) ? begin() + s : end();
+  }
+
+  template <typename Q> V& at_impl(const Q& key) {
+    auto it = find_impl(key);
+    if (it == end())
+      throw std::out_of_range("perfect_hash_map::at key not found");
+    return it->second;
+  }
+  template <typename Q> const V& at_impl(const Q& key) const {
+    auto it = find_impl(key);
+    if (it == end())
+      throw std::out_of_range("perfect_hash_map::at key not found");
+    return it->second;
+  }
+};
+
+// Fixed-size perfect hash map whose table can be built in a constant expression, for literal
+// lookup tables. K and V must be literal, default-constructible types and Hash must be
+// constexpr-callable (hence constexpr_hash). A duplicate key fails compilation.
+//
+//   constexpr auto colors =
+//       make_perfect_hash_map<std::string_view, int>({{"red", 1}, {"blue", 2}});
+//   static_assert(colors.at("blue") == 2);
+template <typename K, typename V, std::size_t N, typename Hash = constexpr_hash,
+          typename KeyEqual = std::equal_to<>,
+          typename BucketPolicy = power_of_two_bucket_policy>
+class static_perfect_hash_map {
+  static_assert(N > 0, "static_perfect_hash_map: needs at least one key");
+
+  using core = perfect_hash_core<Hash, BucketPolicy>;
+  static constexpr std::size_t kBuckets = core::bucket_count(N);
+
+public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = std::pair<K, V>;
+  using size_type = std::size_t;
+  using const_iterator = const value_type*;
+
+  constexpr explicit static_perfect_hash_map(const value_type (&items)[N]) {
+    std::array<std::uint64_t, N> hashes{};
+    std::array<std::uint32_t, N> positions{};
+    std::array<std::uint32_t, core::scratch_size(N)> scratch{};
+    for (std::size_t attempt = 0;; ++attempt) {
+      if (attempt == core::kMaxSeeds)
+        throw std::runtime_error("static_perfect_hash_map: no perfect hash found");
+      seed_ = core::seed(attempt);
+      for (std::size_t i = 0; i < N; ++i)
+        hashes[i] = core::hash(Hash{}, items[i].first, seed_);
+      const std::size_t failed =
+          core::build(hashes.data(), N, pilots_.data(), positions.data(), scratch.data());
+      if (failed == kBuckets)
+        break;
+      for (std::size_t i = 0; i < N; ++i)
+        for (std::size_t j = i + 1; j < N; ++j)
+          if (KeyEqual{}(items[i].first, items[j].first))
+            throw std::invalid_argument("static_perfect_hash_map: duplicate key");
+    }
+    for (std::size_t i = 0; i < N; ++i)
+      slots_[positions[i]] = items[i];
+  }
+
+  constexpr const_iterator begin() const noexcept {
+    return slots_.data();
+  }
+  constexpr const_iterator end() const noexcept {
+    return slots_.data() + N;
+  }
+  constexpr size_type size() const noexcept {
+    return N;
+  }
+
+  template <typename Q> constexpr const_iterator find(const Q& key) const {
+    const std::uint64_t h = core::hash(Hash{}, key, seed_);
+    const std::size_t s = core::slot(h, pilots_[core::bucket(h, kBuckets)], N);
+    return KeyEqual{}(slots_[s].first, key) ? begin() + s : end();
+  }
+  template <typename Q> constexpr bool contains(const Q& key) const {
+    return find(key) != end();
+  }
+  template <typename Q> constexpr const V& at(const Q& key) const {
+    const_iterator it = find(key);
+    if (it == end())
+      throw std::out_of_range("static_perfect_hash_map::at key not found");
+    return it->second;
+  }
+
+private:
+  std::array<value_type, N> slots_{};
+  std::array<std::uint32_t, kBuckets> pilots_{};
+  std::uint64_t seed_ = 0;
+};
+
+template <typename K, typename V, std::size_t N>
+constexpr static_perfect_hash_map<K, V, N>
+make_perfect_hash_map(const std::pair<K, V> (&items)[N]) {
+  return static_perfect_hash_map<K, V, N>(items);
+}
@@ -0,0 +1,768 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rb-tree/rb_tree.hpp"
+#include "utility/node_handle.hpp"
+
+// Red-black tree with 32-bit links, for `map<K, V, Compare, CompactRbTree>` and
+// `set<K, Compare, CompactRbTree>`. Nodes live in blocks owned by the tree and refer to each
+// other by index: two child indices and the parent index, whose low bit holds the colour, add 12
+// bytes to the value where RbTree adds three pointers and a colour byte. A set<uint32_t> node
+// takes 16 bytes instead of 40. Following a link costs one extra load, of the block address.
+//
+// An index means nothing outside the tree that owns the block, so nodes never move between
+// trees. Node handles carry the value, as with BTree, merge() moves values one at a time, and
+// there is no split() or join(). Iterators hold the tree and an index: they stay valid across
+// inserts and other erases, but not across a move of the tree. At most 2^31 - 1 elements.
+template <typename Value, typename KeyOfValue, typename Compare, bool Multi>
+class CompactRbTree {
+  using Index = std::uint32_t;
+  static constexpr Index kNull = 0;
+
+  struct Node {
+    explicit Node(Value v) : value(std::move(v)) {}
+    Index left = kNull;
+    Index right = kNull;
+    // Parent index shifted up by one, with the colour (rb_color's value) in the low bit.
+    Index parent_color = 0;
+    Value value;
+  };
+
+  // Blocks hold a power of two of nodes, so an index splits into block and slot with a shift.
+  static constexpr std::size_t kBlockNodes =
+      std::bit_floor(std::max<std::size_t>(64, 16384 / sizeof(Node)));
+  static constexpr unsigned kBlockShift = std::countr_zero(kBlockNodes);
+  // Parent indices lose their top bit to the colour.
+  static constexpr std::size_t kMaxNodes = std::size_t{1} << 31;
+
+public:
+  class iterator;
+  class const_iterator;
+
+  using value_type = Value;
+  using size_type = std::size_t;
+  // Nodes cannot leave their tree, so a handle carries the value itself.
+  using node_type = value_handle<Value>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+  // Bytes per node, for comparing layouts.
+  static constexpr std::size_t node_bytes = sizeof(Node);
+
+  CompactRbTree() = default;
+  explicit CompactRbTree(Compare comp) : comp_(std::move(comp)) {}
+
+  CompactRbTree(const CompactRbTree&) = delete;
+  CompactRbTree& operator=(const CompactRbTree&) = delete;
+
+  CompactRbTree(CompactRbTree&& other) noexcept
+      : root_(std::exchange(other.root_, kNull)), size_(std::exchange(other.size_, 0)),
+        comp_(std::move(other.comp_)), blocks_(std::exchange(other.blocks_, {})),
+        free_(std::exchange(other.free_, kNull)) {}
+
+  CompactRbTree& operator=(CompactRbTree&& other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    release_blocks();
+    root_ = std::exchange(other.root_, kNull);
+    size_ = std::exchange(other.size_, 0);
+    comp_ = std::move(other.comp_);
+    blocks_ = std::exchange(other.blocks_, {});
+    free_ = std::exchange(other.free_, kNull);
+    return *this;
+  }
+
+  ~CompactRbTree() {
+    clear();
+    release_blocks();
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  iterator begin() noexcept {
+    return iterator(minimum(root_), this);
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(minimum(root_), this);
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  iterator end() noexcept {
+    return iterator(kNull, this);
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(kNull, this);
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  void clear() noexcept {
+    destroy_subtree(root_);
+    root_ = kNull;
+    size_ = 0;
+  }
+
+  template <typename Key> iterator find(const Key& key) noexcept {
+    return iterator(find_index(key), this);
+  }
+  template <typename Key> const_iterator find(const Key& key) const noexcept {
+    return const_iterator(find_index(key), this);
+  }
+
+  template <typename Key> iterator lower_bound(const Key& key) noexcept {
+    return iterator(bound<false>(key), this);
+  }
+  template <typename Key> const_iterator lower_bound(const Key& key) const noexcept {
+    return const_iterator(bound<false>(key), this);
+  }
+
+  template <typename Key> iterator upper_bound(const Key& key) noexcept {
+    return iterator(bound<true>(key), this);
+  }
+  template <typename Key> const_iterator upper_bound(const Key& key) const noexcept {
+    return const_iterator(bound<true>(key), this);
+  }
+
+  std::pair<iterator, bool> insert_unique(value_type value) {
+    const Position pos = unique_position(key_of_(value));
+    if (pos.match != kNull)
+      return {iterator(pos.match, this), false};
+    const Index n = create_node(std::move(value));
+    attach_node(pos, n);
+    return {iterator(n, this), true};
+  }
+
+  iterator insert_multi(value_type value) {
+    const Position pos = multi_position(key_of_(value));
+    const Index n = create_node(std::move(value));
+    attach_node(pos, n);
+    return iterator(n, this);
+  }
+
+  // Moves the value at `pos` into a handle and erases its node.
+  node_type extract(const_iterator pos) {
+    node_type nh(std::in_place, std::move(node(pos.node_).value));
+    erase_node(pos.node_);
+    return nh;
+  }
+
+  insert_return_type insert_unique(node_type&& nh) {
+    if (nh.empty())
+      return {end(), false, node_type()};
+    if (auto it = find(key_of_(nh.element())); it != end())
+      return {it, false, std::move(nh)};
+    return {insert_unique(nh.take()).first, true, node_type()};
+  }
+
+  iterator insert_multi(node_type&& nh) {
+    return nh.empty() ? end() : insert_multi(nh.take());
+  }
+
+  // Moves each value of `source` (a tree with the same value type) over, except, if keys are
+  // unique here, those whose key is already present. Values are moved one by one.
+  template <typename Tree>
+    requires std::same_as<typename Tree::node_type, node_type>
+  void merge(Tree& source) {
+    if (static_cast<const void*>(&source) == this)
+      return;
+    for (auto it = source.begin(); it != source.end();) {
+      if (!Multi && find(key_of_(*it)) != end()) {
+        ++it;
+        continue;
+      }
+      if constexpr (Multi)
+        insert_multi(std::move(*it));
+      else
+        insert_unique(std::move(*it));
+      it = source.erase(it);
+    }
+  }
+
+  // Replaces the contents with [first, last), which must already be sorted (strictly, unless
+  // Multi), in O(n), as RbTree does. Throws std::invalid_argument, leaving the tree empty, on
+  // unsorted input.
+  template <std::forward_iterator It> void assign_sorted(It first, It last) {
+    clear();
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    if (n == 0)
+      return;
+    size_type red_depth = 0;
+    while ((size_type{2} << red_depth) <= n)
+      ++red_depth;
+    Index prev = kNull;
+    root_ = build_sorted(first, n, 0, red_depth, prev);
+    set_parent(root_, kNull);
+    set_color(root_, rb_color::Black);
+    size_ = n;
+  }
+
+  iterator erase(iterator pos) {
+    const Index z = pos.node_;
+    const Index next = successor(z);
+    erase_node(z);
+    return iterator(next, this);
+  }
+
+private:
+  struct FreeSlot {
+    Index next = kNull;
+  };
+
+  Index root_ = kNull;
+  size_type size_ = 0;
+  Compare comp_{};
+  KeyOfValue key_of_{};
+  std::vector<std::byte*> blocks_;
+  Index free_ = kNull;
+
+  void* slot(Index i) const noexcept {
+    return blocks_[i >> kBlockShift] + (i & (kBlockNodes - 1)) * sizeof(Node);
+  }
+  Node& node(Index i) const noexcept {
+    return *reinterpret_cast<Node*>(slot(i));
+  }
+
+  Index left(Index i) const noexcept {
+    return node(i).left;
+  }
+  Index right(Index i) const noexcept {
+    return node(i).right;
+  }
+  Index parent(Index i) const noexcept {
+    return node(i).parent_color >> 1;
+  }
+  void set_parent(Index i, Index p) noexcept {
+    Index& pc = node(i).parent_color;
+    pc = (p << 1) | (pc & 1);
+  }
+  rb_color color(Index i) const noexcept {
+    return i == kNull ? rb_color::Black : static_cast<rb_color>(node(i).parent_color & 1);
+  }
+  void set_color(Index i, rb_color c) noexcept {
+    Index& pc = node(i).parent_color;
+    pc = (pc & ~Index{1}) | static_cast<Index>(c);
+  }
+
+  template <typename Key> Index find_index(const Key& key) const noexcept {
+    Index n = root_;
+    while (n != kNull) {
+      const Node& at = node(n);
+      if (comp_(key, key_of_(at.value)))
+        n = at.left;
+      else if (comp_(key_of_(at.value), key))
+        n = at.right;
+      else
+        return n;
+    }
+    return kNull;
+  }
+
+  // First node whose key does not order before `key` or, for Upper, orders after it.
+  template <bool Upper, typename Key> Index bound(const Key& key) const noexcept {
+    Index n = root_;
+    Index result = kNull;
+    while (n != kNull) {
+      const Node& at = node(n);
+      if (Upper ? comp_(key, key_of_(at.value)) : !comp_(key_of_(at.value), key)) {
+        result = n;
+        n = at.left;
+      } else {
+        n = at.right;
+      }
+    }
+    return result;
+  }
+
+  Index minimum(Index n) const noexcept {
+    if (n == kNull)
+      return kNull;
+    while (left(n) != kNull)
+      n = left(n);
+    return n;
+  }
+
+  Index maximum(Index n) const noexcept {
+    if (n == kNull)
+      return kNull;
+    while (right(n) != kNull)
+      n = right(n);
+    return n;
+  }
+
+  Index successor(Index n) const noexcept {
+    if (n == kNull)
+      return kNull;
+    if (right(n) != kNull)
+      return minimum(right(n));
+    Index p = parent(n);
+    while (p != kNull && n == right(p)) {
+      n = p;
+      p = parent(p);
+    }
+    return p;
+  }
+
+  Index predecessor(Index n) const noexcept {
+    if (n == kNull)
+      return kNull;
+    if (left(n) != kNull)
+      return maximum(left(n));
+    Index p = parent(n);
+    while (p != kNull && n == left(p)) {
+      n = p;
+      p = parent(p);
+    }
+    return p;
+  }
+
+  // Slots are pushed last-to-first so consecutive allocations get ascending addresses. Index 0
+  // is the null link, so the first block's first slot is never handed out.
+  void allocate_block() {
+    if ((blocks_.size() + 1) * kBlockNodes > kMaxNodes)
+      throw std::length_error("CompactRbTree: too many elements");
+    blocks_.reserve(blocks_.size() + 1);
+    auto* block = static_cast<std::byte*>(
+        ::operator new(kBlockNodes * sizeof(Node), std::align_val_t{alignof(Node)}));
+    blocks_.push_back(block);
+    const auto base = static_cast<Index>((blocks_.size() - 1) * kBlockNodes);
+    for (auto i = static_cast<Index>(kBlockNodes); i > (base == 0 ? 1 : 0); --i)
+      free_ = push_free(base + i - 1);
+  }
+
+  Index push_free(Index i) noexcept {
+    std::construct_at(static_cast<FreeSlot*>(slot(i)), FreeSlot{free_});
+    return i;
+  }
+
+  Index create_node(value_type value) {
+    if (free_ == kNull)
+      allocate_block();
+    const Index i = free_;
+    auto* free_slot = static_cast<FreeSlot*>(slot(i));
+    free_ = free_slot->next;
+    std::destroy_at(free_slot);
+    try {
+      std::construct_at(reinterpret_cast<Node*>(free_slot), std::move(value));
+    } catch (...) {
+      free_ = push_free(i);
+      throw;
+    }
+    return i;
+  }
+
+  void destroy_node(Index i) noexcept {
+    std::destroy_at(&node(i));
+    free_ = push_free(i);
+  }
+
+  // Expects clear() first, so every slot this tree holds is free.
+  void release_blocks() noexcept {
+    for (auto* block : blocks_)
+      ::operator delete(block, kBlockNodes * sizeof(Node), std::align_val_t{alignof(Node)});
+    blocks_.clear();
+    free_ = kNull;
+  }
+
+  // Where a new key goes: below `parent` (the root if null), on the `left` side or the right.
+  // For unique keys, `match` is instead set when the key is already present.
+  struct Position {
+    Index parent = kNull;
+    bool left = false;
+    Index match = kNull;
+  };
+
+  template <typename Key> Position unique_position(const Key& k) const {
+    Position pos;
+    Index curr = root_;
+    while (curr != kNull) {
+      const Node& at = node(curr);
+      pos.parent = curr;
+      pos.left = comp_(k, key_of_(at.value));
+      if (pos.left)
+        curr = at.left;
+      else if (comp_(key_of_(at.value), k))
+        curr = at.right;
+      else
+        return {kNull, false, curr};
+    }
+    return pos;
+  }
+
+  // With duplicates allowed a new key goes after every equal key.
+  template <typename Key> Position multi_position(const Key& k) const {
+    Position pos;
+    Index curr = root_;
+    while (curr != kNull) {
+      const Node& at = node(curr);
+      pos.parent = curr;
+      pos.left = comp_(k, key_of_(at.value));
+      curr = pos.left ? at.left : at.right;
+    }
+    return pos;
+  }
+
+  void attach_node(const Position& pos, Index n) noexcept {
+    Node& at = node(n);
+    at.left = kNull;
+    at.right = kNull;
+    at.parent_color = pos.parent << 1 | static_cast<Index>(rb_color::Red);
+    if (pos.parent == kNull)
+      root_ = n;
+    else if (pos.left)
+      node(pos.parent).left = n;
+    else
+      node(pos.parent).right = n;
+    insert_fixup(n);
+    ++size_;
+  }
+
+  // Points whichever link led to `old` (its parent's, or the root) at `replacement`.
+  void replace_child(Index old, Index replacement) noexcept {
+    const Index p = parent(old);
+    if (p == kNull)
+      root_ = replacement;
+    else if (old == left(p))
+      node(p).left = replacement;
+    else
+      node(p).right = replacement;
+  }
+
+  void rotate_left(Index x) noexcept {
+    const Index y = right(x);
+    node(x).right = left(y);
+    if (left(y) != kNull)
+      set_parent(left(y), x);
+    set_parent(y, parent(x));
+    replace_child(x, y);
+    node(y).left = x;
+    set_parent(x, y);
+  }
+
+  void rotate_right(Index x) noexcept {
+    const Index y = left(x);
+    node(x).left = right(y);
+    if (right(y) != kNull)
+      set_parent(right(y), x);
+    set_parent(y, parent(x));
+    replace_child(x, y);
+    node(y).right = x;
+    set_parent(x, y);
+  }
+
+  void insert_fixup(Index z) noexcept {
+    while (color(parent(z)) == rb_color::Red) {
+      Index p = parent(z);
+      Index grand = parent(p);
+      if (p == left(grand)) {
+        const Index uncle = right(grand);
+        if (color(uncle) == rb_color::Red) {
+          set_color(p, rb_color::Black);
+          set_color(uncle, rb_color::Black);
+          set_color(grand, rb_color::Red);
+          z = grand;
+        } else {
+          if (z == right(p)) {
+            z = p;
+            rotate_left(z);
+            p = parent(z);
+            grand = parent(p);
+          }
+          set_color(p, rb_color::Black);
+          set_color(grand, rb_color::Red);
+          rotate_right(grand);
+        }
+      } else {
+        const Index uncle = left(grand);
+        if (color(uncle) == rb_color::Red) {
+          set_color(p, rb_color::Black);
+          set_color(uncle, rb_color::Black);
+          set_color(grand, rb_color::Red);
+          z = grand;
+        } else {
+          if (z == left(p)) {
+            z = p;
+            rotate_right(z);
+            p = parent(z);
+            grand = parent(p);
+          }
+          set_color(p, rb_color::Black);
+          set_color(grand, rb_color::Red);
+          rotate_left(grand);
+        }
+      }
+    }
+    set_color(root_, rb_color::Black);
+  }
+
+  void transplant(Index u, Index v) noexcept {
+    replace_child(u, v);
+    if (v != kNull)
+      set_parent(v, parent(u));
+  }
+
+  void erase_node(Index z) noexcept {
+    Index y = z;
+    Index x = kNull;
+    Index x_parent = kNull;
+    rb_color y_original = color(y);
+
+    if (left(z) == kNull) {
+      x = right(z);
+      x_parent = parent(z);
+      transplant(z, right(z));
+    } else if (right(z) == kNull) {
+      x = left(z);
+      x_parent = parent(z);
+      transplant(z, left(z));
+    } else {
+      y = minimum(right(z));
+      y_original = color(y);
+      x = right(y);
+      if (parent(y) == z) {
+        x_parent = y;
+        if (x != kNull)
+          set_parent(x, y);
+      } else {
+        x_parent = parent(y);
+        transplant(y, right(y));
+        node(y).right = right(z);
+        set_parent(right(y), y);
+      }
+      transplant(z, y);
+      node(y).left = left(z);
+      set_parent(left(y), y);
+      set_color(y, color(z));
+    }
+
+    destroy_node(z);
+    --size_;
+    if (y_original == rb_color::Black)
+      erase_fixup(x, x_parent);
+  }
+
+  void erase_fixup(Index x, Index p) noexcept {
+    while (x != root_ && color(x) == rb_color::Black) {
+      if (x == left(p)) {
+        Index w = right(p);
+        if (color(w) == rb_color::Red) {
+          set_color(w, rb_color::Black);
+          set_color(p, rb_color::Red);
+          rotate_left(p);
+          w = right(p);
+        }
+        if (color(left(w)) == rb_color::Black && color(right(w)) == rb_color::Black) {
+          set_color(w, rb_color::Red);
+          x = p;
+          p = parent(x);
+        } else {
+          if (color(right(w)) == rb_color::Black) {
+            set_color(left(w), rb_color::Black);
+            set_color(w, rb_color::Red);
+            rotate_right(w);
+            w = right(p);
+          }
+          set_color(w, color(p));
+          set_color(p, rb_color::Black);
+          set_color(right(w), rb_color::Black);
+          rotate_left(p);
+          x = root_;
+        }
+      } else {
+        Index w = left(p);
+        if (color(w) == rb_color::Red) {
+          set_color(w, rb_color::Black);
+          set_color(p, rb_color::Red);
+          rotate_right(p);
+          w = left(p);
+        }
+        if (color(right(w)) == rb_color::Black && color(left(w)) == rb_color::Black) {
+          set_color(w, rb_color::Red);
+          x = p;
+          p = parent(x);
+        } else {
+          if (color(left(w)) == rb_color::Black) {
+            set_color(right(w), rb_color::Black);
+            set_color(w, rb_color::Red);
+            rotate_left(w);
+            w = left(p);
+          }
+          set_color(w, color(p));
+          set_color(p, rb_color::Black);
+          set_color(left(w), rb_color::Black);
+          rotate_right(p);
+          x = root_;
+        }
+      }
+    }
+    if (x != kNull)
+      set_color(x, rb_color::Black);
+  }
+
+  // Builds a subtree of the next n input values in order, as RbTree::build_sorted does. On a
+  // throw, everything this call has created so far is destroyed before the exception propagates.
+  template <typename It>
+  Index build_sorted(It& it, size_type n, size_type depth, size_type red_depth, Index& prev) {
+    if (n == 0)
+      return kNull;
+    const Index l = build_sorted(it, n / 2, depth + 1, red_depth, prev);
+    Index n_at = kNull;
+    try {
+      n_at = create_node(value_type(*it));
+    } catch (...) {
+      destroy_subtree(l);
+      throw;
+    }
+    ++it;
+    node(n_at).left = l;
+    if (l != kNull)
+      set_parent(l, n_at);
+    set_color(n_at, depth == red_depth ? rb_color::Red : rb_color::Black);
+    try {
+      const auto& key = key_of_(node(n_at).value);
+      if (prev != kNull && (Multi ? comp_(key, key_of_(node(prev).value))
+                                  : !comp_(key_of_(node(prev).value), key)))
+        throw std::invalid_argument("CompactRbTree::assign_sorted: input is not sorted");
+      prev = n_at;
+      node(n_at).right = build_sorted(it, n - n / 2 - 1, depth + 1, red_depth, prev);
+    } catch (...) {
+      destroy_subtree(n_at);
+      throw;
+    }
+    if (right(n_at) != kNull)
+      set_parent(right(n_at), n_at);
+    return n_at;
+  }
+
+  void destroy_subtree(Index n) noexcept {
+    if (n == kNull)
+      return;
+    destroy_subtree(left(n));
+    destroy_subtree(right(n));
+    destroy_node(n);
+  }
+
+public:
+  class iterator {
+  public:
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    iterator() noexcept = default;
+
+    reference operator*() const {
+      return tree_->node(node_).value;
+    }
+    pointer operator->() const {
+      return std::addressof(tree_->node(node_).value);
+    }
+
+    iterator& operator++() {
+      node_ = tree_->successor(node_);
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    iterator& operator--() {
+      node_ = node_ == kNull ? tree_->maximum(tree_->root_) : tree_->predecessor(node_);
+      return *this;
+    }
+    iterator operator--(int) {
+      auto tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    bool operator==(const iterator& other) const {
+      return node_ == other.node_;
+    }
+    bool operator!=(const iterator& other) const {
+      return node_ != other.node_;
+    }
+
+  private:
+    friend class CompactRbTree;
+    friend class const_iterator;
+    iterator(Index node, CompactRbTree* tree) noexcept : node_(node), tree_(tree) {}
+    Index node_ = kNull;
+    CompactRbTree* tree_ = nullptr;
+  };
+
+  class const_iterator {
+  public:
+    using value_type = const Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    const_iterator() noexcept = default;
+    const_iterator(iterator it) noexcept : node_(it.node_), tree_(it.tree_) {}
+
+    reference operator*() const {
+      return tree_->node(node_).value;
+    }
+    pointer operator->() const {
+      return std::addressof(tree_->node(node_).value);
+    }
+
+    const_iterator& operator++() {
+      node_ = tree_->successor(node_);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    const_iterator& operator--() {
+      node_ = node_ == kNull ? tree_->maximum(tree_->root_) : tree_->predecessor(node_);
+      return *this;
+    }
+    const_iterator operator--(int) {
+      auto tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return node_ == other.node_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return node_ != other.node_;
+    }
+
+  private:
+    friend class CompactRbTree;
+    const_iterator(Index node, const CompactRbTree* tree) noexcept : node_(node), tree_(tree) {}
+    Index node_ = kNull;
+    const CompactRbTree* tree_ = nullptr;
+  };
+};
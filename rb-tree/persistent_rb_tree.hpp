@@ -0,0 +1,581 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "rb-tree/rb_tree.hpp"
+#include "utility/node_handle.hpp"
+
+// Red-black tree with shared, reference-counted nodes, for `map<K, V, Compare,
+// PersistentRbTree>` and `set<K, Compare, PersistentRbTree>`. Copying a tree is O(1): the copy
+// shares every node. An update first gives this tree its own copy of each node it is about to
+// change, which is the root-to-node path plus the few siblings the rebalancing recolours or
+// rotates, so it allocates O(log n) nodes and leaves every other tree that shares them as it was.
+// Nodes that no other tree shares are updated in place.
+//
+// A node's count is the number of links to it, from parent nodes or from tree roots. Counts are
+// atomic and nodes are only ever changed by the one tree that holds the sole link, so a copy may
+// be read, and dropped, on another thread while the original keeps being updated. Copying itself
+// reads the tree, so it happens on the writer's thread (or under its lock).
+//
+// There are no parent links, since a shared node has several parents; iterators carry their path
+// from the root instead. Iterators only give const access, and any update invalidates them.
+// Unique keys only. Value copies made while erasing are assumed not to throw.
+template <typename Value, typename KeyOfValue, typename Compare, bool Multi>
+class PersistentRbTree {
+  static_assert(!Multi, "PersistentRbTree keeps unique keys only");
+
+  struct Node {
+    Node(Value v, Node* l, Node* r, rb_color c)
+        : value(std::move(v)), left(l), right(r), color(c) {}
+    Value value;
+    Node* left;
+    Node* right;
+    std::atomic<std::uint32_t> links{1};
+    rb_color color;
+  };
+
+  // Red-black height is at most 2 log2(n + 1), so this covers any size_t count.
+  static constexpr std::size_t kMaxHeight = 2 * std::numeric_limits<std::size_t>::digits;
+
+public:
+  class const_iterator;
+  using iterator = const_iterator;
+
+  using value_type = Value;
+  using size_type = std::size_t;
+  // Nodes may be shared, so a handle carries a copy of the value.
+  using node_type = value_handle<Value>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+  // Bytes per node, for estimating what snapshots cost.
+  static constexpr std::size_t node_bytes = sizeof(Node);
+
+  PersistentRbTree() = default;
+  explicit PersistentRbTree(Compare comp) : comp_(std::move(comp)) {}
+
+  PersistentRbTree(const PersistentRbTree& other)
+      : root_(retain(other.root_)), size_(other.size_), comp_(other.comp_) {}
+  PersistentRbTree& operator=(const PersistentRbTree& other) {
+    if (this != &other) {
+      Node* root = retain(other.root_);
+      release(root_);
+      root_ = root;
+      size_ = other.size_;
+      comp_ = other.comp_;
+    }
+    return *this;
+  }
+
+  PersistentRbTree(PersistentRbTree&& other) noexcept
+      : root_(std::exchange(other.root_, nullptr)), size_(std::exchange(other.size_, 0)),
+        comp_(std::move(other.comp_)) {}
+  PersistentRbTree& operator=(PersistentRbTree&& other) noexcept {
+    if (this != &other) {
+      release(root_);
+      root_ = std::exchange(other.root_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      comp_ = std::move(other.comp_);
+    }
+    return *this;
+  }
+
+  ~PersistentRbTree() {
+    release(root_);
+  }
+
+  // An O(1) copy that shares every node.
+  PersistentRbTree snapshot() const {
+    return *this;
+  }
+
+  bool empty() const noexcept {
+    return size_ == 0;
+  }
+  size_type size() const noexcept {
+    return size_;
+  }
+
+  const_iterator begin() const noexcept {
+    const_iterator it(root_);
+    for (const Node* n = root_; n; n = n->left)
+      it.push(n);
+    return it;
+  }
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(root_);
+  }
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  void clear() noexcept {
+    release(std::exchange(root_, nullptr));
+    size_ = 0;
+  }
+
+  template <typename Key> const_iterator find(const Key& key) const noexcept {
+    const_iterator it(root_);
+    for (const Node* n = root_; n;) {
+      it.push(n);
+      if (comp_(key, key_of_(n->value)))
+        n = n->left;
+      else if (comp_(key_of_(n->value), key))
+        n = n->right;
+      else
+        return it;
+    }
+    return end();
+  }
+
+  template <typename Key> const_iterator lower_bound(const Key& key) const noexcept {
+    return bound([&](const Node* n) { return !comp_(key_of_(n->value), key); });
+  }
+  template <typename Key> const_iterator upper_bound(const Key& key) const noexcept {
+    return bound([&](const Node* n) { return comp_(key, key_of_(n->value)); });
+  }
+
+  std::pair<iterator, bool> insert_unique(value_type value) {
+    if (auto it = find(key_of_(value)); it != end())
+      return {it, false};
+    Path path;
+    Node** link = &root_;
+    while (*link) {
+      Node* n = own(*link);
+      path.push(n);
+      link = comp_(key_of_(value), key_of_(n->value)) ? &n->left : &n->right;
+    }
+    Node* node = new Node(std::move(value), nullptr, nullptr, rb_color::Red);
+    *link = node;
+    path.push(node);
+    ++size_;
+    insert_fixup(path);
+    return {find(key_of_(node->value)), true};
+  }
+
+  // Gives this tree its own copy of every node from the root to `pos`, so the element can be
+  // changed in place without other trees seeing it. Invalidates iterators, like any update.
+  Value& make_unique(const_iterator pos) {
+    return own_path(pos).top()->value;
+  }
+
+  node_type extract(const_iterator pos) {
+    node_type nh(std::in_place, Value(*pos));
+    erase(pos);
+    return nh;
+  }
+
+  insert_return_type insert_unique(node_type&& nh) {
+    if (nh.empty())
+      return {end(), false, node_type()};
+    if (auto it = find(key_of_(nh.element())); it != end())
+      return {it, false, std::move(nh)};
+    return {insert_unique(nh.take()).first, true, node_type()};
+  }
+
+  // Copies in each value of `source` whose key is not present here and erases it there.
+  template <typename Tree>
+    requires std::same_as<typename Tree::node_type, node_type>
+  void merge(Tree& source) {
+    if (static_cast<const void*>(&source) == this)
+      return;
+    for (auto it = source.begin(); it != source.end();) {
+      if (find(key_of_(*it)) != end()) {
+        ++it;
+        continue;
+      }
+      insert_unique(*it);
+      it = source.erase(it);
+    }
+  }
+
+  // Replaces the contents with [first, last), strictly sorted, in O(n), as RbTree does. Throws
+  // std::invalid_argument, leaving the tree empty, on unsorted input.
+  template <std::forward_iterator It> void assign_sorted(It first, It last) {
+    clear();
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    if (n == 0)
+      return;
+    size_type red_depth = 0;
+    while ((size_type{2} << red_depth) <= n)
+      ++red_depth;
+    const Node* prev = nullptr;
+    root_ = build_sorted(first, n, 0, red_depth, prev);
+    root_->color = rb_color::Black;
+    size_ = n;
+  }
+
+  iterator erase(const_iterator pos) {
+    Path path = own_path(pos);
+    Node* z = path.top();
+    rb_color removed = z->color;
+    Node* x = nullptr;
+    const size_type z_at = path.depth - 1;
+    if (z->left && z->right) {
+      // z's successor y takes its place, and y's right child takes y's.
+      Node* y = own(z->right);
+      path.push(y);
+      while (y->left) {
+        y = own(y->left);
+        path.push(y);
+      }
+      removed = y->color;
+      x = y->right;
+      Node* y_parent = path.nodes[path.depth - 2];
+      if (y_parent != z) {
+        y_parent->left = x;
+        y->right = z->right;
+      }
+      y->left = z->left;
+      y->color = z->color;
+      link_of(path, z_at) = y;
+      path.nodes[z_at] = y;
+      path.pop();
+    } else {
+      x = z->left ? z->left : z->right;
+      link_of(path, z_at) = x;
+      path.pop();
+    }
+    --size_;
+    if (removed == rb_color::Black)
+      erase_fixup(x, path);
+
+    // z's children are linked elsewhere now; only z itself goes.
+    const_iterator next = upper_bound(key_of_(z->value));
+    delete z;
+    return next;
+  }
+
+  class const_iterator {
+  public:
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    const_iterator() noexcept = default;
+    // Copies only the live part of the path.
+    const_iterator(const const_iterator& other) noexcept
+        : root_(other.root_), depth_(other.depth_) {
+      std::copy_n(other.path_, depth_, path_);
+    }
+    const_iterator& operator=(const const_iterator& other) noexcept {
+      root_ = other.root_;
+      depth_ = other.depth_;
+      std::copy_n(other.path_, depth_, path_);
+      return *this;
+    }
+
+    reference operator*() const {
+      return path_[depth_ - 1]->value;
+    }
+    pointer operator->() const {
+      return std::addressof(path_[depth_ - 1]->value);
+    }
+
+    const_iterator& operator++() {
+      const Node* n = path_[depth_ - 1];
+      if (n->right) {
+        for (n = n->right; n; n = n->left)
+          push(n);
+      } else {
+        // Climb until arriving from a left child.
+        const Node* child = nullptr;
+        do {
+          child = path_[--depth_];
+        } while (depth_ > 0 && path_[depth_ - 1]->right == child);
+      }
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    const_iterator& operator--() {
+      if (depth_ == 0) {
+        for (const Node* n = root_; n; n = n->right)
+          push(n);
+        return *this;
+      }
+      const Node* n = path_[depth_ - 1];
+      if (n->left) {
+        for (n = n->left; n; n = n->right)
+          push(n);
+      } else {
+        const Node* child = nullptr;
+        do {
+          child = path_[--depth_];
+        } while (depth_ > 0 && path_[depth_ - 1]->left == child);
+      }
+      return *this;
+    }
+    const_iterator operator--(int) {
+      auto tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const noexcept {
+      return node() == other.node();
+    }
+    bool operator!=(const const_iterator& other) const noexcept {
+      return node() != other.node();
+    }
+
+  private:
+    friend class PersistentRbTree;
+
+    explicit const_iterator(const Node* root) noexcept : root_(root) {}
+
+    const Node* node() const noexcept {
+      return depth_ ? path_[depth_ - 1] : nullptr;
+    }
+    void push(const Node* n) noexcept {
+      path_[depth_++] = n;
+    }
+
+    const Node* root_ = nullptr;
+    std::size_t depth_ = 0;
+    const Node* path_[kMaxHeight];
+  };
+
+private:
+  // Nodes from the root down, all owned by this tree.
+  struct Path {
+    Node* nodes[kMaxHeight];
+    size_type depth = 0;
+
+    void push(Node* n) noexcept {
+      nodes[depth++] = n;
+    }
+    void pop() noexcept {
+      --depth;
+    }
+    Node* top() const noexcept {
+      return nodes[depth - 1];
+    }
+  };
+
+  Node* root_ = nullptr;
+  size_type size_ = 0;
+  Compare comp_{};
+  KeyOfValue key_of_{};
+
+  static Node* retain(Node* n) noexcept {
+    if (n)
+      n->links.fetch_add(1, std::memory_order_relaxed);
+    return n;
+  }
+
+  static void release(Node* n) noexcept {
+    while (n && n->links.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      release(n->left);
+      Node* right = n->right;
+      delete n;
+      n = right;
+    }
+  }
+
+  // Makes the node behind `link`, which lives in this tree's root or in a node this tree owns,
+  // this tree's alone: shared nodes are replaced by a copy linking to the same children.
+  static Node* own(Node*& link) {
+    Node* n = link;
+    if (n && n->links.load(std::memory_order_acquire) != 1) {
+      link = new Node(n->value, retain(n->left), retain(n->right), n->color);
+      release(n);
+    }
+    return link;
+  }
+
+  // The link that points at path.nodes[i]: the root or a child slot of the node above it.
+  Node*& link_of(Path& path, size_type i) noexcept {
+    if (i == 0)
+      return root_;
+    Node* parent = path.nodes[i - 1];
+    return parent->left == path.nodes[i] ? parent->left : parent->right;
+  }
+
+  // Owns the nodes on `pos`'s path, following the same left/right turns.
+  Path own_path(const_iterator pos) {
+    Path path;
+    Node** link = &root_;
+    for (size_type i = 0; i < pos.depth_; ++i) {
+      const Node* next = i + 1 < pos.depth_ ? pos.path_[i + 1] : nullptr;
+      Node* n = own(*link);
+      path.push(n);
+      link = n->left == next ? &n->left : &n->right;
+    }
+    return path;
+  }
+
+  // The path to the first node satisfying `take`, a predicate that is false, then true, in order.
+  template <typename Pred> const_iterator bound(Pred take) const noexcept {
+    const_iterator it(root_);
+    std::size_t found = 0;
+    for (const Node* n = root_; n;) {
+      it.push(n);
+      if (take(n)) {
+        found = it.depth_;
+        n = n->left;
+      } else {
+        n = n->right;
+      }
+    }
+    it.depth_ = found;
+    return it;
+  }
+
+  static rb_color color_of(const Node* n) noexcept {
+    return n ? n->color : rb_color::Black;
+  }
+
+  // Rotations on owned nodes; the child moving up is owned first.
+  static void rotate_left(Node*& link) {
+    Node* x = link;
+    Node* y = own(x->right);
+    x->right = y->left;
+    y->left = x;
+    link = y;
+  }
+  static void rotate_right(Node*& link) {
+    Node* x = link;
+    Node* y = own(x->left);
+    x->left = y->right;
+    y->right = x;
+    link = y;
+  }
+
+  // RbTree's insert fixup, walking `path` instead of parent links.
+  void insert_fixup(Path& path) {
+    size_type i = path.depth - 1;
+    while (i >= 2 && path.nodes[i - 1]->color == rb_color::Red) {
+      Node* parent = path.nodes[i - 1];
+      Node* grand = path.nodes[i - 2];
+      const bool parent_left = grand->left == parent;
+      if (color_of(parent_left ? grand->right : grand->left) == rb_color::Red) {
+        Node* uncle = own(parent_left ? grand->right : grand->left);
+        parent->color = rb_color::Black;
+        uncle->color = rb_color::Black;
+        grand->color = rb_color::Red;
+        i -= 2;
+        continue;
+      }
+      Node* z = path.nodes[i];
+      if (parent_left && z == parent->right) {
+        rotate_left(grand->left);
+        parent = z;
+      } else if (!parent_left && z == parent->left) {
+        rotate_right(grand->right);
+        parent = z;
+      }
+      parent->color = rb_color::Black;
+      grand->color = rb_color::Red;
+      if (parent_left)
+        rotate_right(link_of(path, i - 2));
+      else
+        rotate_left(link_of(path, i - 2));
+      break;
+    }
+    root_->color = rb_color::Black;
+  }
+
+  // RbTree's erase fixup. `x` (possibly null) is short one black; path.top() is its parent.
+  void erase_fixup(Node* x, Path& path) {
+    while (path.depth > 0 && color_of(x) == rb_color::Black) {
+      Node* parent = path.top();
+      const bool x_left = parent->left == x;
+      Node*& sibling_link = x_left ? parent->right : parent->left;
+      Node* w = own(sibling_link);
+      if (w->color == rb_color::Red) {
+        w->color = rb_color::Black;
+        parent->color = rb_color::Red;
+        Node*& parent_link = link_of(path, path.depth - 1);
+        if (x_left)
+          rotate_left(parent_link);
+        else
+          rotate_right(parent_link);
+        // w now sits above parent.
+        path.nodes[path.depth - 1] = w;
+        path.push(parent);
+        w = own(x_left ? parent->right : parent->left);
+      }
+      Node* near = x_left ? w->left : w->right;
+      Node* far = x_left ? w->right : w->left;
+      if (color_of(near) == rb_color::Black && color_of(far) == rb_color::Black) {
+        w->color = rb_color::Red;
+        x = parent;
+        path.pop();
+        continue;
+      }
+      if (color_of(far) == rb_color::Black) {
+        own(x_left ? w->left : w->right)->color = rb_color::Black;
+        w->color = rb_color::Red;
+        if (x_left)
+          rotate_right(parent->right);
+        else
+          rotate_left(parent->left);
+        w = x_left ? parent->right : parent->left;
+      }
+      w->color = parent->color;
+      parent->color = rb_color::Black;
+      own(x_left ? w->right : w->left)->color = rb_color::Black;
+      if (x_left)
+        rotate_left(link_of(path, path.depth - 1));
+      else
+        rotate_right(link_of(path, path.depth - 1));
+      return;
+    }
+    if (color_of(x) == rb_color::Red)
+      own(path.depth == 0 ? root_ : (path.top()->left == x ? path.top()->left : path.top()->right))
+          ->color = rb_color::Black;
+  }
+
+  template <typename It>
+  Node* build_sorted(It& it, size_type n, size_type depth, size_type red_depth,
+                     const Node*& prev) {
+    if (n == 0)
+      return nullptr;
+    Node* left = build_sorted(it, n / 2, depth + 1, red_depth, prev);
+    Node* node = nullptr;
+    try {
+      node = new Node(value_type(*it), left, nullptr,
+                      depth == red_depth ? rb_color::Red : rb_color::Black);
+    } catch (...) {
+      release(left);
+      throw;
+    }
+    ++it;
+    try {
+      if (prev && !comp_(key_of_(prev->value), key_of_(node->value)))
+        throw std::invalid_argument("PersistentRbTree::assign_sorted: input is not sorted");
+      prev = node;
+      node->right = build_sorted(it, n - n / 2 - 1, depth + 1, red_depth, prev);
+    } catch (...) {
+      release(node);
+      throw;
+    }
+    return node;
+  }
+};
+
+// Tree backends whose copies share nodes; map and set expose snapshot() only for these.
+template <typename Tree>
+concept persistent_tree = requires(const Tree& t, typename Tree::const_iterator it) {
+  t.snapshot();
+  std::declval<Tree&>().make_unique(it);
+};
@@ -1,20 +1,131 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
-template <typename Value, typename KeyOfValue, typename Compare, bool Multi> class RbTree {
+#include "utility/node_handle.hpp"
+
+// Subtree element count kept in each node of an order-statistic RbTree. The disabled
+// specialization is empty, so as a base class it adds nothing to the node.
+template <bool Enabled> struct rb_subtree_size {
+  std::size_t subtree_size = 1;
+};
+template <> struct rb_subtree_size<false> {};
+
+// Summary of a node's subtree, for an RbTree with a Summary policy. The policy provides `type`,
+// `of(value)`, the summary of one element, and `add(summary, child_summary)`, which folds a
+// child's summary in; neither may throw. With `void` the base is empty.
+template <typename Summary> struct rb_subtree_summary {
+  typename Summary::type summary{};
+};
+template <> struct rb_subtree_summary<void> {};
+
+enum class rb_color : unsigned char { Red, Black };
+
+// Depends only on the element type and the augmentations, not on the comparator or on Multi, so
+// map and multimap (or set and multiset) over the same elements can hand nodes to each other.
+template <typename Value, bool OrderStatistics, typename Summary = void>
+struct rb_node : rb_subtree_size<OrderStatistics>, rb_subtree_summary<Summary> {
+  explicit rb_node(Value v) : value(std::move(v)) {}
+  Value value;
+  rb_node* parent = nullptr;
+  rb_node* left = nullptr;
+  rb_node* right = nullptr;
+  rb_color color = rb_color::Red;
+};
+
+// Slabs that RbTree nodes are carved from. A slab is aligned to its own size, so a node finds the
+// slab header by masking its address. The header counts the slab's slots that have not been handed
+// back. A tree that never traded nodes frees its slabs wholesale, as before. A tree that did
+// returns each of its slots instead, and the last slot back frees the slab. That is what lets
+// extract() and merge() move a node to another tree, or let it outlive its tree in a handle.
+template <typename Node> class rb_node_slab {
+  struct Header {
+    std::atomic<std::size_t> held;
+  };
+  static constexpr std::size_t kSlotOffset =
+      (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+
+public:
+  static constexpr std::size_t kBytes =
+      std::bit_ceil(std::max<std::size_t>(16384, kSlotOffset + 64 * sizeof(Node)));
+  static constexpr std::size_t kSlots = (kBytes - kSlotOffset) / sizeof(Node);
+
+  static std::byte* allocate() {
+    auto* slab = static_cast<std::byte*>(::operator new(kBytes, std::align_val_t{kBytes}));
+    std::construct_at(reinterpret_cast<Header*>(slab), kSlots);
+    return slab;
+  }
+  static void deallocate(std::byte* slab) noexcept {
+    std::destroy_at(reinterpret_cast<Header*>(slab));
+    ::operator delete(slab, kBytes, std::align_val_t{kBytes});
+  }
+
+  static void* slot(std::byte* slab, std::size_t i) noexcept {
+    return slab + kSlotOffset + i * sizeof(Node);
+  }
+  static std::byte* slab_of(const void* slot) noexcept {
+    return reinterpret_cast<std::byte*>(reinterpret_cast<std::uintptr_t>(slot) & ~(kBytes - 1));
+  }
+
+  // Hands back `count` slots of `slab`, freeing it once none are left out.
+  static void release(std::byte* slab, std::size_t count) noexcept {
+    auto& held = reinterpret_cast<Header*>(slab)->held;
+    if (held.fetch_sub(count, std::memory_order_acq_rel) == count)
+      deallocate(slab);
+  }
+};
+
+// node_handle traits for a detached RbTree node, which goes back to its slab when dropped.
+template <typename Node> struct rb_node_traits {
+  using pointer = Node*;
+  using element_type = decltype(Node::value);
+
+  static element_type& element(Node* node) noexcept {
+    return node->value;
+  }
+  static void destroy(Node* node) noexcept {
+    std::destroy_at(node);
+    rb_node_slab<Node>::release(rb_node_slab<Node>::slab_of(node), 1);
+  }
+};
+
+// With OrderStatistics, every node also counts the nodes below it, which rotations and erase keep
+// current at O(1) extra per step. That enables rank(), select() and index_of() in O(log n).
+//
+// With a Summary policy (see rb_subtree_summary), every node also keeps the summary of its
+// subtree, recomputed by rotations and along the path of each insert and erase, O(log n) in
+// all. first_where() and next_where() then skip the subtrees whose summary rules them out;
+// interval_map keeps the largest interval end this way.
+template <typename Value, typename KeyOfValue, typename Compare, bool Multi,
+          bool OrderStatistics = false, typename Summary = void>
+class RbTree {
+  using Node = rb_node<Value, OrderStatistics, Summary>;
+  static constexpr bool kSummarized = !std::is_void_v<Summary>;
+
 public:
   class iterator;
   class const_iterator;
 
   using value_type = Value;
   using size_type = std::size_t;
+  using node_type = node_handle<rb_node_traits<Node>>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+  // Bytes per node, for comparing layouts.
+  static constexpr std::size_t node_bytes = sizeof(Node);
 
   RbTree() : root_(nullptr), size_(0), comp_(), key_of_() {}
   explicit RbTree(Compare comp) : root_(nullptr), size_(0), comp_(std::move(comp)), key_of_() {}
@@ -28,6 +139,7 @@ public:
     size_ = std::exchange(other.size_, 0);
     blocks_ = std::move(other.blocks_);
     free_ = std::exchange(other.free_, nullptr);
+    traded_ = std::exchange(other.traded_, false);
   }
 
   RbTree& operator=(RbTree&& other) noexcept {
@@ -40,6 +152,7 @@ public:
     comp_ = std::move(other.comp_);
     blocks_ = std::move(other.blocks_);
     free_ = std::exchange(other.free_, nullptr);
+    traded_ = std::exchange(other.traded_, false);
     return *this;
   }
 
@@ -164,45 +277,151 @@ public:
   }
 
   std::pair<iterator, bool> insert_unique(value_type value) {
-    Node* parent = nullptr;
-    Node* curr = root_;
-    const auto& k = key_of_(value);
-    while (curr) {
-      parent = curr;
-      if (comp_(k, key_of_(curr->value)))
-        curr = curr->left;
-      else if (comp_(key_of_(curr->value), k))
-        curr = curr->right;
-      else
-        return {iterator(curr, this), false};
-    }
+    const Position pos = unique_position(key_of_(value));
+    if (pos.match)
+      return {iterator(pos.match, this), false};
     Node* node = create_node(std::move(value));
-    node->parent = parent;
-    link_node(parent, node, k);
-    insert_fixup(node);
-    ++size_;
+    attach_node(pos, node);
     return {iterator(node, this), true};
   }
 
   iterator insert_multi(value_type value) {
-    Node* parent = nullptr;
-    Node* curr = root_;
-    const auto& k = key_of_(value);
-    while (curr) {
-      parent = curr;
-      if (comp_(k, key_of_(curr->value)))
-        curr = curr->left;
-      else
-        curr = curr->right;
-    }
+    const Position pos = multi_position(key_of_(value));
     Node* node = create_node(std::move(value));
-    node->parent = parent;
-    link_node(parent, node, k);
-    insert_fixup(node);
-    ++size_;
+    attach_node(pos, node);
     return iterator(node, this);
   }
 
+  // Unlinks the element at `pos` and returns it in a handle. The node itself is not copied or
+  // freed, so pointers and references to the element stay valid.
+  node_type extract(const_iterator pos) noexcept {
+    Node* node = const_cast<Node*>(pos.node_);
+    unlink_node(node);
+    traded_ = true;
+    return node_type(node);
+  }
+
+  // Links the handle's node into this tree. An empty handle inserts nothing; on a key clash the
+  // node stays in the returned handle.
+  insert_return_type insert_unique(node_type&& nh) {
+    if (nh.empty())
+      return {end(), false, node_type()};
+    const Position pos = unique_position(key_of_(nh.get()->value));
+    if (pos.match)
+      return {iterator(pos.match, this), false, std::move(nh)};
+    traded_ = true;
+    Node* node = nh.release();
+    attach_node(pos, node);
+    return {iterator(node, this), true, node_type()};
+  }
+
+  iterator insert_multi(node_type&& nh) {
+    if (nh.empty())
+      return end();
+    const Position pos = multi_position(key_of_(nh.get()->value));
+    traded_ = true;
+    Node* node = nh.release();
+    attach_node(pos, node);
+    return iterator(node, this);
+  }
+
+  // Moves every node of `source` (any RbTree with the same node type) into this tree, except, if
+  // keys are unique here, those whose key is already present, which stay behind. Nodes are
+  // relinked, never copied; iterators to moved elements must not be used with `source` again.
+  template <typename Tree>
+    requires std::same_as<typename Tree::node_type, node_type>
+  void merge(Tree& source) {
+    if (static_cast<const void*>(&source) == this)
+      return;
+    for (auto it = source.begin(); it != source.end();) {
+      const auto pos = it++;
+      const Position at = Multi ? multi_position(key_of_(*pos)) : unique_position(key_of_(*pos));
+      if (!at.match) {
+        traded_ = true;
+        attach_node(at, source.extract(pos).release());
+      }
+    }
+  }
+
+  // Replaces the contents with [first, last), which must already be sorted (strictly, unless
+  // Multi), in O(n): nodes are created in order into a perfectly balanced shape instead of being
+  // inserted one by one. Throws std::invalid_argument, leaving the tree empty, on unsorted input.
+  template <std::forward_iterator It> void assign_sorted(It first, It last) {
+    clear();
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    if (n == 0)
+      return;
+    // The balanced split leaves every null link at one of two adjacent depths, so making the
+    // deepest level red and everything above it black satisfies the red-black invariants.
+    size_type red_depth = 0;
+    while ((size_type{2} << red_depth) <= n)
+      ++red_depth;
+    const Node* prev = nullptr;
+    root_ = build_sorted(first, n, 0, red_depth, prev);
+    root_->parent = nullptr;
+    root_->color = Color::Black;
+    size_ = n;
+  }
+
+  // Moves every element whose key does not order before `key` into a new tree and returns it;
+  // this tree keeps the rest. Whole subtrees are relinked with the red-black join, O(log n) in
+  // all, and no element is copied, so pointers and references to elements stay valid. Without
+  // OrderStatistics the two sizes are recounted, which walks the smaller half. All comparisons
+  // happen before anything is relinked, so a throwing comparator leaves the tree unchanged.
+  template <typename Key> RbTree split(const Key& key) {
+    RbTree upper(comp_);
+    if (!root_)
+      return upper;
+    const auto [lower_part, upper_part] = split_subtree(root_, black_height(root_), key);
+    root_ = lower_part.root;
+    upper.root_ = upper_part.root;
+    if (!upper.root_)
+      return upper;
+    traded_ = upper.traded_ = true;
+    if constexpr (OrderStatistics) {
+      upper.size_ = subtree_size(upper.root_);
+    } else {
+      // Step through both halves together, so the count stops at the end of the smaller one.
+      Node* a = minimum(root_);
+      Node* b = minimum(upper.root_);
+      size_type steps = 0;
+      for (; a && b; ++steps) {
+        a = successor(a);
+        b = successor(b);
+      }
+      upper.size_ = a ? steps : size_ - steps;
+    }
+    size_ -= upper.size_;
+    return upper;
+  }
+
+  // Appends every element of `right`, all of whose keys must order after this tree's (or not
+  // before them, if Multi), in O(log n): right's first node becomes the pivot of a red-black
+  // join. `right` is left empty. Throws std::invalid_argument, changing neither tree, if the key
+  // ranges overlap.
+  void join(RbTree&& right) {
+    if (&right == this || !right.root_)
+      return;
+    if (!root_) {
+      *this = std::move(right);
+      return;
+    }
+    const Node* last = maximum(root_);
+    Node* pivot = minimum(right.root_);
+    if (Multi ? comp_(key_of_(pivot->value), key_of_(last->value))
+              : !comp_(key_of_(last->value), key_of_(pivot->value)))
+      throw std::invalid_argument("RbTree::join: key ranges overlap");
+    right.unlink_node(pivot);
+    const size_type added = right.size_ + 1;
+    const Piece joined = join_pieces(as_piece(root_, black_height(root_)), pivot,
+                                     as_piece(right.root_, black_height(right.root_)));
+    root_ = joined.root;
+    size_ += added;
+    right.root_ = nullptr;
+    right.size_ = 0;
+    traded_ = right.traded_ = true;
+  }
+
   iterator erase(iterator pos) {
     Node* z = pos.node_;
     Node* next = successor(z);
@@ -210,34 +429,205 @@ public:
     return iterator(next, this);
   }
 
-private:
-  enum class Color : unsigned char { Red, Black };
+  // Number of elements whose key orders before `key` (the index of lower_bound(key)).
+  template <typename Key>
+  size_type rank(const Key& key) const noexcept
+    requires OrderStatistics
+  {
+    size_type r = 0;
+    const Node* n = root_;
+    while (n) {
+      if (comp_(key_of_(n->value), key)) {
+        r += subtree_size(n->left) + 1;
+        n = n->right;
+      } else {
+        n = n->left;
+      }
+    }
+    return r;
+  }
 
-  struct Node {
-    explicit Node(value_type v) : value(std::move(v)) {}
-    value_type value;
-    Node* parent = nullptr;
-    Node* left = nullptr;
-    Node* right = nullptr;
-    Color color = Color::Red;
-  };
+  // The element at in-order index `k`, or end() if k >= size().
+  iterator select(size_type k) noexcept
+    requires OrderStatistics
+  {
+    return iterator(const_cast<Node*>(select_node(k)), this);
+  }
+  const_iterator select(size_type k) const noexcept
+    requires OrderStatistics
+  {
+    return const_iterator(select_node(k), this);
+  }
+
+  // In-order index of `it`; end() maps to size().
+  size_type index_of(const_iterator it) const noexcept
+    requires OrderStatistics
+  {
+    const Node* n = it.node_;
+    if (!n)
+      return size_;
+    size_type r = subtree_size(n->left);
+    for (; n->parent; n = n->parent) {
+      if (n == n->parent->right)
+        r += subtree_size(n->parent->left) + 1;
+    }
+    return r;
+  }
+
+  // Pruned in-order search, for a tree with a Summary policy. `reach(summary)` must hold for a
+  // subtree exactly when it holds for the summary of some element in it; subtrees out of reach
+  // are skipped whole. `past(value)` ends the search, so once it holds for an element it must
+  // hold for every later one. `hit(value)` picks the elements returned, and must accept every
+  // element in reach that is not past. first_where() returns the first hit, or end().
+  template <typename Reach, typename Past, typename Hit>
+  iterator first_where(Reach reach, Past past, Hit hit)
+    requires kSummarized
+  {
+    return iterator(const_cast<Node*>(first_reached(reach, past, hit)), this);
+  }
+  template <typename Reach, typename Past, typename Hit>
+  const_iterator first_where(Reach reach, Past past, Hit hit) const
+    requires kSummarized
+  {
+    return const_iterator(first_reached(reach, past, hit), this);
+  }
+
+  // The next hit after `pos`, which must not be end(), or end().
+  template <typename Reach, typename Past, typename Hit>
+  iterator next_where(const_iterator pos, Reach reach, Past past, Hit hit)
+    requires kSummarized
+  {
+    return iterator(const_cast<Node*>(next_hit(pos.node_, reach, past, hit)), this);
+  }
+  template <typename Reach, typename Past, typename Hit>
+  const_iterator next_where(const_iterator pos, Reach reach, Past past, Hit hit) const
+    requires kSummarized
+  {
+    return const_iterator(next_hit(pos.node_, reach, past, hit), this);
+  }
+
+private:
+  using Color = rb_color;
+  using Slab = rb_node_slab<Node>;
 
   struct FreeNode {
     FreeNode* next = nullptr;
   };
 
-  struct Storage {
-    alignas(Node) std::byte data[sizeof(Node)];
-  };
-  static constexpr size_type kBlockSize = 512;
-
   Node* root_;
   size_type size_;
   Compare comp_;
   KeyOfValue key_of_;
-  std::allocator<Storage> storage_alloc_{};
-  std::vector<Storage*> blocks_;
+  std::vector<std::byte*> blocks_;
   FreeNode* free_ = nullptr;
+  // Set once a node has left or joined this tree other than through insert/erase; from then on the
+  // slabs are released slot by slot (see rb_node_slab).
+  bool traded_ = false;
+
+  static size_type subtree_size(const Node* n) noexcept {
+    if constexpr (OrderStatistics)
+      return n ? n->subtree_size : 0;
+    else
+      return 0;
+  }
+
+  // Recomputes the size and summary of `n` from its children.
+  static void refresh(Node* n) noexcept {
+    if constexpr (OrderStatistics)
+      n->subtree_size = subtree_size(n->left) + subtree_size(n->right) + 1;
+    summarize(n);
+  }
+
+  static void summarize(Node* n) noexcept {
+    if constexpr (kSummarized) {
+      n->summary = Summary::of(n->value);
+      if (n->left)
+        Summary::add(n->summary, n->left->summary);
+      if (n->right)
+        Summary::add(n->summary, n->right->summary);
+    }
+  }
+
+  // Recomputes the summaries of `n` and its ancestors after a change below `n`. A summary that
+  // comes out unchanged leaves every ancestor's as it was, so the walk stops there if summaries
+  // compare equal, but not before reaching `through`, a node whose children were relinked.
+  static void summarize_path(Node* n, const Node* through = nullptr) noexcept {
+    if constexpr (kSummarized) {
+      for (; n; n = n->parent) {
+        if constexpr (std::equality_comparable<typename Summary::type>) {
+          const typename Summary::type before = n->summary;
+          summarize(n);
+          if (!through && n->summary == before)
+            return;
+        } else {
+          summarize(n);
+        }
+        if (n == through)
+          through = nullptr;
+      }
+    }
+  }
+
+  // Leftmost node of subtree `n` that `hit` accepts, or null if `past` rejects an earlier one.
+  template <typename Reach, typename Past, typename Hit>
+  static const Node* first_hit(const Node* n, Reach& reach, Past& past, Hit& hit) {
+    while (n) {
+      if (n->left && reach(n->left->summary)) {
+        n = n->left;
+        continue;
+      }
+      if (past(n->value))
+        return nullptr;
+      if (hit(n->value))
+        return n;
+      n = n->right && reach(n->right->summary) ? n->right : nullptr;
+    }
+    return nullptr;
+  }
+
+  template <typename Reach, typename Past, typename Hit>
+  static const Node* next_hit(const Node* n, Reach& reach, Past& past, Hit& hit) {
+    for (;;) {
+      if (n->right && reach(n->right->summary))
+        return first_hit(n->right, reach, past, hit);
+      while (n->parent && n == n->parent->right)
+        n = n->parent;
+      n = n->parent;
+      if (!n || past(n->value))
+        return nullptr;
+      if (hit(n->value))
+        return n;
+    }
+  }
+
+  // Adjusts the counts of `n` and every ancestor after a node below them was linked or unlinked.
+  static void add_to_path(Node* n, int delta) noexcept {
+    if constexpr (OrderStatistics) {
+      for (; n; n = n->parent)
+        n->subtree_size += static_cast<size_type>(delta);
+    }
+  }
+
+  template <typename Reach, typename Past, typename Hit>
+  const Node* first_reached(Reach& reach, Past& past, Hit& hit) const {
+    return root_ && reach(root_->summary) ? first_hit(root_, reach, past, hit) : nullptr;
+  }
+
+  const Node* select_node(size_type k) const noexcept {
+    const Node* n = root_;
+    while (n) {
+      const size_type left = subtree_size(n->left);
+      if (k < left) {
+        n = n->left;
+      } else if (k == left) {
+        return n;
+      } else {
+        k -= left + 1;
+        n = n->right;
+      }
+    }
+    return nullptr;
+  }
 
   static Node* minimum(Node* n) noexcept {
     if (!n)
@@ -289,13 +679,13 @@ private:
     return p;
   }
 
+  // Slots are pushed last-to-first so consecutive allocations get ascending addresses.
   void allocate_block() {
-    Storage* block = storage_alloc_.allocate(kBlockSize);
+    blocks_.reserve(blocks_.size() + 1);
+    std::byte* block = Slab::allocate();
     blocks_.push_back(block);
-    for (size_type i = 0; i < kBlockSize; ++i) {
-      auto* slot = std::construct_at(reinterpret_cast<FreeNode*>(block + i), FreeNode{free_});
-      free_ = slot;
-    }
+    for (size_type i = Slab::kSlots; i > 0; --i)
+      free_ = std::construct_at(static_cast<FreeNode*>(Slab::slot(block, i - 1)), FreeNode{free_});
   }
 
   Node* create_node(value_type value) {
@@ -312,23 +702,88 @@ private:
     free_ = slot;
   }
 
+  // Expects clear() first, so every slot this tree holds is on the free list.
   void release_blocks() noexcept {
-    for (auto* block : blocks_)
-      storage_alloc_.deallocate(block, kBlockSize);
+    if (!traded_) {
+      for (auto* block : blocks_)
+        Slab::deallocate(block);
+    } else {
+      // Return free slots in runs: consecutive slots usually share a slab.
+      std::byte* run = nullptr;
+      size_type count = 0;
+      for (FreeNode* slot = free_; slot;) {
+        FreeNode* next = slot->next;
+        std::byte* block = Slab::slab_of(slot);
+        if (block != run) {
+          if (run)
+            Slab::release(run, count);
+          run = block;
+          count = 0;
+        }
+        ++count;
+        slot = next;
+      }
+      if (run)
+        Slab::release(run, count);
+    }
     blocks_.clear();
     free_ = nullptr;
+    traded_ = false;
   }
 
-  void link_node(Node* parent, Node* node,
-                 const decltype(key_of_(std::declval<value_type&>()))& k) {
-    if (!parent) {
-      root_ = node;
-      return;
+  // Where a new key goes: below `parent` (the root if null), on the `left` side or the right.
+  // For unique keys, `match` is instead set when the key is already present.
+  struct Position {
+    Node* parent = nullptr;
+    bool left = false;
+    Node* match = nullptr;
+  };
+
+  template <typename Key> Position unique_position(const Key& k) {
+    Position pos;
+    Node* curr = root_;
+    while (curr) {
+      pos.parent = curr;
+      pos.left = comp_(k, key_of_(curr->value));
+      if (pos.left)
+        curr = curr->left;
+      else if (comp_(key_of_(curr->value), k))
+        curr = curr->right;
+      else
+        return {nullptr, false, curr};
     }
-    if (comp_(k, key_of_(parent->value)))
-      parent->left = node;
+    return pos;
+  }
+
+  // With duplicates allowed a new key goes after every equal key.
+  template <typename Key> Position multi_position(const Key& k) {
+    Position pos;
+    Node* curr = root_;
+    while (curr) {
+      pos.parent = curr;
+      pos.left = comp_(k, key_of_(curr->value));
+      curr = pos.left ? curr->left : curr->right;
+    }
+    return pos;
+  }
+
+  // Links a node, new or detached from some tree, at `pos` and rebalances.
+  void attach_node(const Position& pos, Node* node) noexcept {
+    node->parent = pos.parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->color = Color::Red;
+    refresh(node);
+    if (!pos.parent)
+      root_ = node;
+    else if (pos.left)
+      pos.parent->left = node;
     else
-      parent->right = node;
+      pos.parent->right = node;
+    add_to_path(pos.parent, 1);
+    summarize_path(pos.parent);
+    insert_fixup(node);
+    ++size_;
   }
 
   static Color color_of(Node* n) noexcept {
@@ -351,6 +806,8 @@ private:
 
     y->left = x;
     x->parent = y;
+    refresh(x);
+    refresh(y);
   }
 
   void rotate_right(Node* x) noexcept {
@@ -369,9 +826,12 @@ private:
 
     y->right = x;
     x->parent = y;
+    refresh(x);
+    refresh(y);
   }
 
-  void insert_fixup(Node* z) noexcept {
+  // Returns whether the root ended up red and was blackened, which adds one to the black height.
+  bool insert_fixup(Node* z) noexcept {
     while (z->parent && z->parent->color == Color::Red) {
       Node* parent = z->parent;
       Node* grand = parent->parent;
@@ -413,7 +873,9 @@ private:
         }
       }
     }
+    const bool grew = root_->color == Color::Red;
     root_->color = Color::Black;
+    return grew;
   }
 
   void transplant(Node* u, Node* v) noexcept {
@@ -428,11 +890,22 @@ private:
   }
 
   void erase_node(Node* z) noexcept {
+    unlink_node(z);
+    destroy_node(z);
+  }
+
+  // Takes z out of the tree and rebalances, leaving z itself untouched for the caller to free or
+  // hand off.
+  void unlink_node(Node* z) noexcept {
     Node* y = z;
     Node* x = nullptr;
     Node* x_parent = nullptr;
     Color y_original = y->color;
 
+    // The node that leaves its position is z itself, or z's successor when z has two children;
+    // every ancestor of that position loses one element.
+    add_to_path(z->left && z->right ? minimum(z->right)->parent : z->parent, -1);
+
     if (!z->left) {
       x = z->right;
       x_parent = z->parent;
@@ -459,9 +932,12 @@ private:
       y->left = z->left;
       y->left->parent = y;
       y->color = z->color;
+      if constexpr (OrderStatistics)
+        y->subtree_size = z->subtree_size;
     }
+    // Every subtree that lost a node lies on the path up from x_parent, which passes through y.
+    summarize_path(x_parent, y == z ? nullptr : y);
 
-    destroy_node(z);
     --size_;
     if (y_original == Color::Black)
       erase_fixup(x, x_parent);
@@ -545,6 +1021,135 @@ private:
       x->color = Color::Black;
   }
 
+  // Builds a subtree of the next n input values in order. On a throw, everything this call has
+  // created so far is destroyed before the exception propagates.
+  template <typename It>
+  Node* build_sorted(It& it, size_type n, size_type depth, size_type red_depth,
+                     const Node*& prev) {
+    if (n == 0)
+      return nullptr;
+    Node* left = build_sorted(it, n / 2, depth + 1, red_depth, prev);
+    Node* node = nullptr;
+    try {
+      node = create_node(value_type(*it));
+    } catch (...) {
+      destroy_subtree(left);
+      throw;
+    }
+    ++it;
+    node->left = left;
+    if (left)
+      left->parent = node;
+    node->color = depth == red_depth ? Color::Red : Color::Black;
+    try {
+      if (prev && (Multi ? comp_(key_of_(node->value), key_of_(prev->value))
+                         : !comp_(key_of_(prev->value), key_of_(node->value))))
+        throw std::invalid_argument("RbTree::assign_sorted: input is not sorted");
+      prev = node;
+      node->right = build_sorted(it, n - n / 2 - 1, depth + 1, red_depth, prev);
+    } catch (...) {
+      destroy_subtree(node);
+      throw;
+    }
+    if (node->right)
+      node->right->parent = node;
+    refresh(node);
+    return node;
+  }
+
+  // A detached subtree with a black root, and its black height: the number of black nodes on
+  // every path from the root down to a null link.
+  struct Piece {
+    Node* root = nullptr;
+    size_type black_height = 0;
+  };
+
+  static size_type black_height(const Node* n) noexcept {
+    size_type h = 0;
+    for (; n; n = n->left)
+      h += n->color == Color::Black ? 1 : 0;
+    return h;
+  }
+
+  // Detaches `n`, whose black height is `h`, as a Piece; a red root is blackened, which adds one.
+  static Piece as_piece(Node* n, size_type h) noexcept {
+    if (n) {
+      n->parent = nullptr;
+      if (n->color == Color::Red) {
+        n->color = Color::Black;
+        ++h;
+      }
+    }
+    return {n, h};
+  }
+
+  // The red-black join: links `left`, `mid` and `right`, whose keys are in that order, into one
+  // tree in O(1 + the difference in black height). `mid` hangs off the taller tree's spine next
+  // to a black node of the shorter tree's height, with the shorter tree as its other child, and
+  // insert_fixup repairs a red parent. root_ serves as the taller tree's root meanwhile, since
+  // the rotations update it.
+  Piece join_pieces(Piece left, Node* mid, Piece right) noexcept {
+    mid->color = Color::Red;
+    if (left.black_height == right.black_height) {
+      mid->parent = nullptr;
+      mid->color = Color::Black;
+      link_children(mid, left.root, right.root);
+      return {mid, left.black_height + 1};
+    }
+    const bool left_taller = left.black_height > right.black_height;
+    const Piece& tall = left_taller ? left : right;
+    const Piece& shorter = left_taller ? right : left;
+    const size_type added = subtree_size(shorter.root) + 1;
+    Node* parent = nullptr;
+    Node* c = tall.root;
+    for (size_type h = tall.black_height; color_of(c) == Color::Red || h != shorter.black_height;
+         c = left_taller ? c->right : c->left) {
+      if (c->color == Color::Black)
+        --h;
+      if constexpr (OrderStatistics)
+        c->subtree_size += added;
+      parent = c;
+    }
+    mid->parent = parent;
+    if (left_taller) {
+      parent->right = mid;
+      link_children(mid, c, right.root);
+    } else {
+      parent->left = mid;
+      link_children(mid, left.root, c);
+    }
+    summarize_path(parent);
+    root_ = tall.root;
+    const bool grew = insert_fixup(mid);
+    return {root_, tall.black_height + (grew ? 1 : 0)};
+  }
+
+  static void link_children(Node* n, Node* left, Node* right) noexcept {
+    n->left = left;
+    n->right = right;
+    if (left)
+      left->parent = n;
+    if (right)
+      right->parent = n;
+    refresh(n);
+  }
+
+  // Splits the subtree `n`, of black height `h`, into the nodes ordered before `key` and the
+  // rest. The recursion compares on the way down and relinks on the way back up; the joins'
+  // height differences telescope, so the whole split is O(log n).
+  template <typename Key>
+  std::pair<Piece, Piece> split_subtree(Node* n, size_type h, const Key& key) {
+    if (!n)
+      return {};
+    const size_type child_h = h - (n->color == Color::Black ? 1 : 0);
+    if (comp_(key_of_(n->value), key)) {
+      auto [lower, upper] = split_subtree(n->right, child_h, key);
+      return {join_pieces(as_piece(n->left, child_h), n, lower), upper};
+    }
+    auto [lower, upper] = split_subtree(n->left, child_h, key);
+    return {lower, join_pieces(upper, n, as_piece(n->right, child_h))};
+  }
+
   void destroy_subtree(Node* n) noexcept {
     if (!n)
       return;
@@ -668,3 +1273,18 @@ public:
     const RbTree* tree_;
   };
 };
+
+// RbTree with subtree sizes, for `map<K, V, Compare, OrderStatisticRbTree>` and friends.
+template <typename Value, typename KeyOfValue, typename Compare, bool Multi>
+using OrderStatisticRbTree = RbTree<Value, KeyOfValue, Compare, Multi, true>;
+
+// Tree backends that answer rank/select queries; map and set expose them only for these.
+template <typename Tree>
+concept order_statistic_tree = requires(const Tree& t, typename Tree::const_iterator it) {
+  t.select(0);
+  t.index_of(it);
+};
+
+// Tree backends that split and join in O(log n); map and set expose them only for these.
+template <typename Tree>
+concept splittable_tree = requires(Tree& t) { t.join(std::move(t)); };
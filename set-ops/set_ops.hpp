@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "vector/vector.hpp"
+
+// Set algebra over sorted, duplicate-free inputs: set, FlatSet, a sorted Vector, or anything else
+// with begin(), end() and size() in Compare order. The result is a sorted Vector, which
+// set::from_sorted can adopt in O(n).
+//
+// Each call picks a strategy from the input sizes:
+// - Similar sizes: one linear merge, O(n + m).
+// - One input kSetOpsGallopRatio times the other or more, the larger one contiguous: each
+//   element of the smaller input is found in the larger by exponential search from the last
+//   hit, and the runs in between are skipped or copied whole, O(m log(n / m)) comparisons.
+//   If the larger input is a tree set and none of its own elements are output (intersection,
+//   or difference from it), it is probed with its lower_bound instead, O(m log n).
+// - `threads` > 1, both inputs contiguous and kSetOpsParallelMin elements or more: the larger
+//   input is cut into one piece per thread and the smaller one at the matching lower_bounds.
+//   The pieces are combined concurrently, each with the strategy above, and then concatenated.
+//   Compare is copied into each thread.
+
+inline constexpr std::size_t kSetOpsGallopRatio = 16;
+inline constexpr std::size_t kSetOpsParallelMin = std::size_t{1} << 16;
+
+template <typename R>
+concept set_ops_input = requires(const R& r) {
+  r.begin();
+  r.end();
+  r.size();
+};
+
+template <typename R>
+using set_ops_value_t = std::remove_cvref_t<decltype(*std::declval<const R&>().begin())>;
+
+// Whether an input of `big` elements is worth galloping through for each of `small` elements.
+constexpr bool set_ops_skewed(std::size_t big, std::size_t small) noexcept {
+  return big / kSetOpsGallopRatio >= std::max<std::size_t>(small, 1);
+}
+
+// Which elements an operation keeps: those only in a, only in b, and those in both.
+struct set_ops_keep {
+  bool a_only;
+  bool b_only;
+  bool both;
+};
+
+template <typename ItA, typename ItB, typename T, typename Compare>
+void set_ops_merge(ItA a, ItA a_end, ItB b, ItB b_end, set_ops_keep keep, Compare& comp,
+                   Vector<T>& out) {
+  while (a != a_end && b != b_end) {
+    if (comp(*a, *b)) {
+      if (keep.a_only)
+        out.push_back(*a);
+      ++a;
+    } else if (comp(*b, *a)) {
+      if (keep.b_only)
+        out.push_back(*b);
+      ++b;
+    } else {
+      if (keep.both)
+        out.push_back(*a);
+      ++a;
+      ++b;
+    }
+  }
+  if (keep.a_only) {
+    for (; a != a_end; ++a)
+      out.push_back(*a);
+  }
+  if (keep.b_only) {
+    for (; b != b_end; ++b)
+      out.push_back(*b);
+  }
+}
+
+// First element of [first, last) not ordered before `key`. Probes 1, 2, 4, ... places ahead
+// before bisecting, so a hit d places in costs O(log d) comparisons.
+template <typename T, typename Compare>
+const T* set_ops_gallop(const T* first, const T* last, const T& key, Compare& comp) {
+  const auto n = static_cast<std::size_t>(last - first);
+  std::size_t bound = 1;
+  while (bound < n && comp(first[bound], key))
+    bound *= 2;
+  return std::lower_bound(first + bound / 2, first + std::min(bound + 1, n), key, comp);
+}
+
+// Walks the smaller input and gallops through the larger, contiguous one.
+template <typename SmallIt, typename T, typename Compare>
+void set_ops_gallop_merge(SmallIt small, SmallIt small_end, const T* big, const T* big_end,
+                          bool small_is_a, set_ops_keep keep, Compare& comp, Vector<T>& out) {
+  const bool keep_small = small_is_a ? keep.a_only : keep.b_only;
+  const bool keep_big = small_is_a ? keep.b_only : keep.a_only;
+  for (; small != small_end && big != big_end; ++small) {
+    const T* hit = set_ops_gallop(big, big_end, *small, comp);
+    if (keep_big) {
+      for (; big != hit; ++big)
+        out.push_back(*big);
+    }
+    big = hit;
+    if (big != big_end && !comp(*small, *big)) {
+      if (keep.both)
+        out.push_back(small_is_a ? *small : *big);
+      ++big;
+    } else if (keep_small) {
+      out.push_back(*small);
+    }
+  }
+  if (keep_small) {
+    for (; small != small_end; ++small)
+      out.push_back(*small);
+  }
+  if (keep_big) {
+    for (; big != big_end; ++big)
+      out.push_back(*big);
+  }
+}
+
+// Two contiguous ranges, one thread.
+template <typename T, typename Compare>
+void set_ops_combine(const T* a, const T* a_end, const T* b, const T* b_end, set_ops_keep keep,
+                     Compare& comp, Vector<T>& out) {
+  const auto n = static_cast<std::size_t>(a_end - a);
+  const auto m = static_cast<std::size_t>(b_end - b);
+  if (set_ops_skewed(m, n))
+    set_ops_gallop_merge(a, a_end, b, b_end, true, keep, comp, out);
+  else if (set_ops_skewed(n, m))
+    set_ops_gallop_merge(b, b_end, a, a_end, false, keep, comp, out);
+  else
+    set_ops_merge(a, a_end, b, b_end, keep, comp, out);
+}
+
+template <typename T, typename Compare>
+Vector<T> set_ops_parallel(const T* a, std::size_t n, const T* b, std::size_t m,
+                           set_ops_keep keep, const Compare& comp, std::size_t threads) {
+  // Piece i starts at element i * len / pieces of the larger input and, in the smaller one, at
+  // the lower_bound of that element, so equal elements always land in the same piece.
+  const bool cut_a = n >= m;
+  const std::size_t len = cut_a ? n : m;
+  const std::size_t pieces = std::min(threads, len);
+  Vector<const T*> a_cuts;
+  Vector<const T*> b_cuts;
+  a_cuts.reserve(pieces + 1);
+  b_cuts.reserve(pieces + 1);
+  for (std::size_t i = 0; i < pieces; ++i) {
+    const std::size_t at = i * len / pieces;
+    Compare c = comp;
+    if (cut_a) {
+      a_cuts.push_back(a + at);
+      b_cuts.push_back(i == 0 ? b : std::lower_bound(b_cuts.back(), b + m, a[at], c));
+    } else {
+      b_cuts.push_back(b + at);
+      a_cuts.push_back(i == 0 ? a : std::lower_bound(a_cuts.back(), a + n, b[at], c));
+    }
+  }
+  a_cuts.push_back(a + n);
+  b_cuts.push_back(b + m);
+
+  Vector<Vector<T>> parts;
+  Vector<std::exception_ptr> errors;
+  parts.resize(pieces);
+  errors.resize(pieces);
+  auto work = [&](std::size_t i) {
+    try {
+      Compare c = comp;
+      set_ops_combine(a_cuts[i], a_cuts[i + 1], b_cuts[i], b_cuts[i + 1], keep, c, parts[i]);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  {
+    Vector<std::jthread> pool;
+    pool.reserve(pieces - 1);
+    for (std::size_t i = 1; i < pieces; ++i)
+      pool.emplace_back(work, i);
+    work(0);
+  }
+  for (const auto& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::size_t total = 0;
+  for (const auto& part : parts)
+    total += part.size();
+  Vector<T> out;
+  out.reserve(total);
+  for (auto& part : parts) {
+    for (auto& value : part)
+      out.push_back(std::move(value));
+  }
+  return out;
+}
+
+template <typename A, typename B, typename Compare>
+Vector<set_ops_value_t<A>> set_ops_run(const A& a, const B& b, set_ops_keep keep, Compare comp,
+                                       std::size_t threads, std::size_t reserve) {
+  using T = set_ops_value_t<A>;
+  static_assert(std::is_same_v<T, set_ops_value_t<B>>, "set_ops: inputs must hold one type");
+  constexpr bool a_contiguous = std::contiguous_iterator<decltype(a.begin())>;
+  constexpr bool b_contiguous = std::contiguous_iterator<decltype(b.begin())>;
+  const auto n = static_cast<std::size_t>(a.size());
+  const auto m = static_cast<std::size_t>(b.size());
+
+  if constexpr (a_contiguous && b_contiguous) {
+    const T* pa = std::to_address(a.begin());
+    const T* pb = std::to_address(b.begin());
+    if (threads > 1 && n + m >= kSetOpsParallelMin)
+      return set_ops_parallel(pa, n, pb, m, keep, comp, threads);
+    Vector<T> out;
+    out.reserve(reserve);
+    set_ops_combine(pa, pa + n, pb, pb + m, keep, comp, out);
+    return out;
+  } else {
+    Vector<T> out;
+    out.reserve(reserve);
+    if constexpr (b_contiguous) {
+      if (set_ops_skewed(m, n)) {
+        const T* pb = std::to_address(b.begin());
+        set_ops_gallop_merge(a.begin(), a.end(), pb, pb + m, true, keep, comp, out);
+        return out;
+      }
+    } else if constexpr (requires { b.lower_bound(*a.begin()); }) {
+      if (set_ops_skewed(m, n) && !keep.b_only) {
+        for (const T& x : a) {
+          const auto it = b.lower_bound(x);
+          const bool found = it != b.end() && !comp(x, *it);
+          if (found ? keep.both : keep.a_only)
+            out.push_back(x);
+        }
+        return out;
+      }
+    }
+    if constexpr (a_contiguous) {
+      if (set_ops_skewed(n, m)) {
+        const T* pa = std::to_address(a.begin());
+        set_ops_gallop_merge(b.begin(), b.end(), pa, pa + n, false, keep, comp, out);
+        return out;
+      }
+    } else if constexpr (requires { a.lower_bound(*b.begin()); }) {
+      if (set_ops_skewed(n, m) && !keep.a_only) {
+        for (const T& x : b) {
+          const auto it = a.lower_bound(x);
+          const bool found = it != a.end() && !comp(x, *it);
+          if (found ? keep.both : keep.b_only)
+            out.push_back(found ? *it : x);
+        }
+        return out;
+      }
+    }
+    set_ops_merge(a.begin(), a.end(), b.begin(), b.end(), keep, comp, out);
+    return out;
+  }
+}
+
+// Every element in a or b.
+template <set_ops_input A, set_ops_input B, typename Compare = std::less<>>
+Vector<set_ops_value_t<A>> sorted_union(const A& a, const B& b, Compare comp = Compare(),
+                                        std::size_t threads = 1) {
+  return set_ops_run(a, b, {true, true, true}, std::move(comp), threads, a.size() + b.size());
+}
+
+// Every element in both a and b.
+template <set_ops_input A, set_ops_input B, typename Compare = std::less<>>
+Vector<set_ops_value_t<A>> sorted_intersection(const A& a, const B& b, Compare comp = Compare(),
+                                               std::size_t threads = 1) {
+  return set_ops_run(a, b, {false, false, true}, std::move(comp), threads,
+                     std::min<std::size_t>(a.size(), b.size()));
+}
+
+// Every element of a that is not in b.
+template <set_ops_input A, set_ops_input B, typename Compare = std::less<>>
+Vector<set_ops_value_t<A>> sorted_difference(const A& a, const B& b, Compare comp = Compare(),
+                                             std::size_t threads = 1) {
+  return set_ops_run(a, b, {true, false, false}, std::move(comp), threads, a.size());
+}
+
+// Every element in exactly one of a and b.
+template <set_ops_input A, set_ops_input B, typename Compare = std::less<>>
+Vector<set_ops_value_t<A>> sorted_symmetric_difference(const A& a, const B& b,
+                                                       Compare comp = Compare(),
+                                                       std::size_t threads = 1) {
+  return set_ops_run(a, b, {true, true, false}, std::move(comp), threads, a.size() + b.size());
+}
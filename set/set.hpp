@@ -2,11 +2,25 @@
 
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <type_traits>
 #include <utility>
 
+#include "b-tree/b_tree.hpp"
+#include "rb-tree/compact_rb_tree.hpp"
+#include "rb-tree/persistent_rb_tree.hpp"
 #include "rb-tree/rb_tree.hpp"
+#include "utility/sorted_tags.hpp"
+#include "utility/transparent.hpp"
 
-template <typename K, typename Compare = std::less<K>> class set {
+template <typename K, typename Compare, template <typename, typename, typename, bool> class Tree>
+class multiset;
+
+// Ordered set; `Tree` picks the backend as for map (RbTree by default, CompactRbTree,
+// BTree or PersistentRbTree).
+template <typename K, typename Compare = std::less<K>,
+          template <typename, typename, typename, bool> class Tree = RbTree>
+class set {
 public:
   using key_type = K;
   using value_type = K;
@@ -19,16 +33,34 @@ private:
     }
   };
 
-  using tree_type = RbTree<value_type, key_of_value, Compare, false>;
+  using tree_type = Tree<value_type, key_of_value, Compare, false>;
   tree_type tree_{};
 
+  // merge() reaches into the source's tree.
+  template <typename, typename, template <typename, typename, typename, bool> class>
+  friend class set;
+  template <typename, typename, template <typename, typename, typename, bool> class>
+  friend class multiset;
+
 public:
   using iterator = typename tree_type::iterator;
   using const_iterator = typename tree_type::const_iterator;
+  using node_type = typename tree_type::node_type;
+  using insert_return_type = typename tree_type::insert_return_type;
 
   set() = default;
   explicit set(Compare comp) : tree_(std::move(comp)) {}
 
+  // Builds from a range sorted by Compare with unique keys in O(n) instead of O(n log n).
+  // Throws std::invalid_argument if the range is not in that order.
+  template <std::forward_iterator It>
+  set(sorted_unique_t, It first, It last, Compare comp = Compare()) : tree_(std::move(comp)) {
+    tree_.assign_sorted(first, last);
+  }
+  template <std::forward_iterator It> static set from_sorted(It first, It last) {
+    return set(sorted_unique, first, last);
+  }
+
   bool empty() const noexcept {
     return tree_.empty();
   }
@@ -92,6 +124,10 @@ public:
     return {lower_bound(key), upper_bound(key)};
   }
 
+  size_type count(const K& key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+
   std::pair<iterator, bool> insert(value_type value) {
     return tree_.insert_unique(std::move(value));
   }
@@ -105,9 +141,168 @@ public:
   iterator erase(iterator pos) {
     return tree_.erase(pos);
   }
+
+  // Node handles, as for std::set. extract() detaches an element; insert() links it into any
+  // set or multiset with the same element type and backend. With RbTree the node itself moves:
+  // nothing is allocated, freed or copied, and pointers to the element stay valid. BTree has no
+  // per-element nodes, so its handles carry the moved element instead.
+  node_type extract(const_iterator pos) {
+    return tree_.extract(pos);
+  }
+  node_type extract(const K& key) {
+    auto it = find(key);
+    return it == end() ? node_type() : tree_.extract(it);
+  }
+  insert_return_type insert(node_type&& nh) {
+    return tree_.insert_unique(std::move(nh));
+  }
+
+  // Moves in each element of `source` whose key is not present here; the others stay put.
+  template <typename C2> void merge(set<K, C2, Tree>& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(set<K, C2, Tree>&& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(multiset<K, C2, Tree>& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(multiset<K, C2, Tree>&& source) {
+    tree_.merge(source.tree_);
+  }
+
+  // Range partitioning, for the RbTree backends. split() moves the elements with keys from `key`
+  // on into a new set and returns it, keeping the earlier ones; join() appends `right`, whose
+  // keys must all order after this set's, and leaves it empty. Both relink whole subtrees in
+  // O(log n) (split also recounts the smaller half unless the backend keeps subtree sizes), and
+  // elements stay where they are in memory. join() throws std::invalid_argument, changing
+  // nothing, if the key ranges overlap.
+  set split(const K& key)
+    requires splittable_tree<tree_type>
+  {
+    set upper;
+    upper.tree_ = tree_.split(key);
+    return upper;
+  }
+
+  void join(set&& right)
+    requires splittable_tree<tree_type>
+  {
+    tree_.join(std::move(right.tree_));
+  }
+
+  // Order statistics, for a backend that keeps subtree sizes (`OrderStatisticRbTree`).
+  // rank(key) counts elements ordered before `key`; select(k) is the k-th element or end().
+  size_type rank(const K& key) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.rank(key);
+  }
+  template <typename Q>
+    requires transparent<Compare> && order_statistic_tree<tree_type>
+  size_type rank(const Q& key) const noexcept {
+    return tree_.rank(key);
+  }
+
+  iterator select(size_type k) noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.select(k);
+  }
+  const_iterator select(size_type k) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.select(k);
+  }
+
+  // O(log n) equivalent of std::distance(first, last).
+  std::ptrdiff_t distance(const_iterator first, const_iterator last) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return static_cast<std::ptrdiff_t>(tree_.index_of(last)) -
+           static_cast<std::ptrdiff_t>(tree_.index_of(first));
+  }
+
+  // For the PersistentRbTree backend: an O(1) copy sharing every node with this set, as for map.
+  set snapshot() const
+    requires persistent_tree<tree_type>
+  {
+    return *this;
+  }
+
+  // Heterogeneous lookup, enabled when Compare is transparent (e.g. `std::less<>`).
+  template <typename Q>
+    requires transparent<Compare>
+  iterator find(const Q& key) noexcept {
+    return tree_.find(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator find(const Q& key) const noexcept {
+    return tree_.find(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  bool contains(const Q& key) const noexcept {
+    return find(key) != end();
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  size_type count(const Q& key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  iterator lower_bound(const Q& key) noexcept {
+    return tree_.lower_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator lower_bound(const Q& key) const noexcept {
+    return tree_.lower_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  iterator upper_bound(const Q& key) noexcept {
+    return tree_.upper_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator upper_bound(const Q& key) const noexcept {
+    return tree_.upper_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<iterator, iterator> equal_range(const Q& key) noexcept {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<const_iterator, const_iterator> equal_range(const Q& key) const noexcept {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  template <typename Q>
+    requires transparent<Compare> && (!std::is_convertible_v<const Q&, iterator>)
+  void erase(const Q& key) {
+    auto it = find(key);
+    if (it != end())
+      tree_.erase(it);
+  }
 };
 
-template <typename K, typename Compare = std::less<K>> class multiset {
+template <typename K, typename Compare = std::less<K>,
+          template <typename, typename, typename, bool> class Tree = RbTree>
+class multiset {
 public:
   using key_type = K;
   using value_type = K;
@@ -120,16 +315,34 @@ private:
     }
   };
 
-  using tree_type = RbTree<value_type, key_of_value, Compare, true>;
+  using tree_type = Tree<value_type, key_of_value, Compare, true>;
   tree_type tree_{};
 
+  // merge() reaches into the source's tree.
+  template <typename, typename, template <typename, typename, typename, bool> class>
+  friend class set;
+  template <typename, typename, template <typename, typename, typename, bool> class>
+  friend class multiset;
+
 public:
   using iterator = typename tree_type::iterator;
   using const_iterator = typename tree_type::const_iterator;
+  using node_type = typename tree_type::node_type;
 
   multiset() = default;
   explicit multiset(Compare comp) : tree_(std::move(comp)) {}
 
+  // Builds from a range whose keys are non-decreasing under Compare in O(n) instead of
+  // O(n log n). Throws std::invalid_argument if the range is not in that order.
+  template <std::forward_iterator It>
+  multiset(sorted_equivalent_t, It first, It last, Compare comp = Compare())
+      : tree_(std::move(comp)) {
+    tree_.assign_sorted(first, last);
+  }
+  template <std::forward_iterator It> static multiset from_sorted(It first, It last) {
+    return multiset(sorted_equivalent, first, last);
+  }
+
   bool empty() const noexcept {
     return tree_.empty();
   }
@@ -190,6 +403,18 @@ public:
     return {lower_bound(key), upper_bound(key)};
   }
 
+  bool contains(const K& key) const noexcept {
+    return find(key) != end();
+  }
+
+  size_type count(const K& key) const noexcept {
+    const auto [first, last] = equal_range(key);
+    if constexpr (order_statistic_tree<tree_type>)
+      return static_cast<size_type>(distance(first, last));
+    else
+      return static_cast<size_type>(std::distance(first, last));
+  }
+
   iterator insert(value_type value) {
     return tree_.insert_multi(std::move(value));
   }
@@ -201,16 +426,174 @@ public:
   }
 
   size_type erase_all(const K& key) {
-    size_type erased = 0;
-    auto [first, last] = equal_range(key);
-    while (first != last) {
-      first = tree_.erase(first);
-      ++erased;
-    }
+    // Counted first: BTree erases invalidate the end of the range.
+    const size_type erased = count(key);
+    auto it = lower_bound(key);
+    for (size_type i = 0; i < erased; ++i)
+      it = tree_.erase(it);
     return erased;
   }
 
   iterator erase(iterator pos) {
     return tree_.erase(pos);
   }
+
+  // Node handles, as for std::multiset; see map::extract.
+  node_type extract(const_iterator pos) {
+    return tree_.extract(pos);
+  }
+  // Detaches the first element with `key`, or returns an empty handle.
+  node_type extract(const K& key) {
+    const auto [first, last] = equal_range(key);
+    return first == last ? node_type() : tree_.extract(first);
+  }
+  iterator insert(node_type&& nh) {
+    return tree_.insert_multi(std::move(nh));
+  }
+
+  // Moves every element of `source` in.
+  template <typename C2> void merge(set<K, C2, Tree>& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(set<K, C2, Tree>&& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(multiset<K, C2, Tree>& source) {
+    tree_.merge(source.tree_);
+  }
+  template <typename C2> void merge(multiset<K, C2, Tree>&& source) {
+    tree_.merge(source.tree_);
+  }
+
+  // Range partitioning, as for set::split and set::join; the keys of `right` must not order
+  // before this multiset's.
+  multiset split(const K& key)
+    requires splittable_tree<tree_type>
+  {
+    multiset upper;
+    upper.tree_ = tree_.split(key);
+    return upper;
+  }
+
+  void join(multiset&& right)
+    requires splittable_tree<tree_type>
+  {
+    tree_.join(std::move(right.tree_));
+  }
+
+  // Order statistics, for a backend that keeps subtree sizes (`OrderStatisticRbTree`).
+  // rank(key) counts elements ordered before `key`; select(k) is the k-th element or end().
+  size_type rank(const K& key) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.rank(key);
+  }
+  template <typename Q>
+    requires transparent<Compare> && order_statistic_tree<tree_type>
+  size_type rank(const Q& key) const noexcept {
+    return tree_.rank(key);
+  }
+
+  iterator select(size_type k) noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.select(k);
+  }
+  const_iterator select(size_type k) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return tree_.select(k);
+  }
+
+  // O(log n) equivalent of std::distance(first, last).
+  std::ptrdiff_t distance(const_iterator first, const_iterator last) const noexcept
+    requires order_statistic_tree<tree_type>
+  {
+    return static_cast<std::ptrdiff_t>(tree_.index_of(last)) -
+           static_cast<std::ptrdiff_t>(tree_.index_of(first));
+  }
+
+  // Heterogeneous lookup, enabled when Compare is transparent (e.g. `std::less<>`).
+  template <typename Q>
+    requires transparent<Compare>
+  iterator find(const Q& key) noexcept {
+    return tree_.find(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator find(const Q& key) const noexcept {
+    return tree_.find(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  bool contains(const Q& key) const noexcept {
+    return find(key) != end();
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  size_type count(const Q& key) const noexcept {
+    const auto [first, last] = equal_range(key);
+    if constexpr (order_statistic_tree<tree_type>)
+      return static_cast<size_type>(distance(first, last));
+    else
+      return static_cast<size_type>(std::distance(first, last));
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  iterator lower_bound(const Q& key) noexcept {
+    return tree_.lower_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator lower_bound(const Q& key) const noexcept {
+    return tree_.lower_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  iterator upper_bound(const Q& key) noexcept {
+    return tree_.upper_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  const_iterator upper_bound(const Q& key) const noexcept {
+    return tree_.upper_bound(key);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<iterator, iterator> equal_range(const Q& key) noexcept {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  std::pair<const_iterator, const_iterator> equal_range(const Q& key) const noexcept {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  void erase_one(const Q& key) {
+    auto it = find(key);
+    if (it != end())
+      tree_.erase(it);
+  }
+
+  template <typename Q>
+    requires transparent<Compare>
+  size_type erase_all(const Q& key) {
+    // Counted first: BTree erases invalidate the end of the range.
+    const size_type erased = count(key);
+    auto it = lower_bound(key);
+    for (size_type i = 0; i < erased; ++i)
+      it = tree_.erase(it);
+    return erased;
+  }
 };
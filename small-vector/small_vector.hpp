@@ -8,6 +8,10 @@
 #include <type_traits>
 #include <utility>
 
+#include "utility/default_init.hpp"
+#include "utility/ranges.hpp"
+#include "utility/relocate.hpp"
+
 template <typename T, std::size_t InlineCapacity = 8> class SmallVector {
 public:
   using value_type = T;
@@ -103,6 +107,13 @@ public:
   void clear() noexcept;
   void reserve(size_type new_capacity);
 
+  // New elements are value-initialized by resize(n) and default-initialized by
+  // resize(n, default_init); resize_uninitialized and resize_and_overwrite are as on Vector.
+  void resize(size_type new_size);
+  void resize(size_type new_size, default_init_t);
+  void resize_uninitialized(size_type new_size);
+  template <typename Op> void resize_and_overwrite(size_type n, Op op);
+
   void push_back(const T& value) {
     emplace_back(value);
   }
@@ -123,6 +134,16 @@ public:
 
   template <typename... Args> iterator emplace(const_iterator pos, Args&&... args);
 
+  // As on Vector: one growth and one tail shift for sized and forward ranges.
+  template <container_compatible_range<T> R> void append_range(R&& rg) {
+    insert_range(cend(), std::forward<R>(rg));
+  }
+  template <container_compatible_range<T> R> iterator insert_range(const_iterator pos, R&& rg);
+  template <container_compatible_range<T> R> void assign_range(R&& rg) {
+    clear();
+    append_range(std::forward<R>(rg));
+  }
+
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
 
@@ -140,6 +161,7 @@ private:
   static void deallocate(T* p, size_type n) noexcept;
 
   void grow_to(size_type new_capacity);
+  size_type next_capacity() const noexcept;
 
   size_type size_ = 0;
   size_type capacity_ = 0;
@@ -148,4 +170,7 @@ private:
   alignas(T) std::byte inline_storage_[InlineCapacity == 0 ? 1 : sizeof(T) * InlineCapacity];
 };
 
+// Only without inline storage: otherwise data_ may point into the object itself.
+template <typename T> struct is_trivially_relocatable<SmallVector<T, 0>> : std::true_type {};
+
 #include "small_vector.tpp"
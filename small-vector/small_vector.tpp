@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <cstring>
 #include <new>
 
 template <typename T, std::size_t InlineCapacity>
@@ -34,9 +33,14 @@ SmallVector<T, InlineCapacity>::SmallVector(SmallVector&& other) noexcept(
   }
 
   reserve(other.size_);
-  for (auto& v : other)
-    emplace_back(std::move(v));
-  other.clear();
+  if constexpr (is_trivially_relocatable_v<T>) {
+    trivially_relocate(other.data_, other.data_ + other.size_, data_);
+    size_ = std::exchange(other.size_, 0);
+  } else {
+    for (auto& v : other)
+      emplace_back(std::move(v));
+    other.clear();
+  }
 }
 
 template <typename T, std::size_t InlineCapacity>
@@ -72,9 +76,14 @@ SmallVector<T, InlineCapacity>& SmallVector<T, InlineCapacity>::operator=(
   }
 
   reserve(other.size_);
-  for (auto& v : other)
-    emplace_back(std::move(v));
-  other.clear();
+  if constexpr (is_trivially_relocatable_v<T>) {
+    trivially_relocate(other.data_, other.data_ + other.size_, data_);
+    size_ = std::exchange(other.size_, 0);
+  } else {
+    for (auto& v : other)
+      emplace_back(std::move(v));
+    other.clear();
+  }
   return *this;
 }
 
@@ -157,21 +166,28 @@ void SmallVector<T, InlineCapacity>::clear() noexcept {
 template <typename T, std::size_t InlineCapacity>
 void SmallVector<T, InlineCapacity>::grow_to(size_type new_capacity) {
   T* new_data = allocate(new_capacity);
-  if constexpr (std::is_trivially_copyable_v<T> && std::is_trivially_copy_assignable_v<T>) {
-    if (size_ > 0)
-      std::memcpy(new_data, data_, size_ * sizeof(T));
-  } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
-    std::uninitialized_move_n(data_, size_, new_data);
+  if constexpr (is_trivially_relocatable_v<T>) {
+    trivially_relocate(data_, data_ + size_, new_data);
   } else {
-    std::uninitialized_copy_n(data_, size_, new_data);
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_move_n(data_, size_, new_data);
+    } else {
+      std::uninitialized_copy_n(data_, size_, new_data);
+    }
+    std::destroy_n(data_, size_);
   }
-  std::destroy_n(data_, size_);
   if (!using_inline_storage())
     deallocate(data_, capacity_);
   data_ = new_data;
   capacity_ = new_capacity;
 }
 
+template <typename T, std::size_t InlineCapacity>
+typename SmallVector<T, InlineCapacity>::size_type
+SmallVector<T, InlineCapacity>::next_capacity() const noexcept {
+  return capacity_ == 0 ? 1 : (capacity_ * 2);
+}
+
 template <typename T, std::size_t InlineCapacity>
 void SmallVector<T, InlineCapacity>::reserve(size_type new_capacity) {
   if (new_capacity <= capacity_)
@@ -179,16 +195,53 @@ void SmallVector<T, InlineCapacity>::reserve(size_type new_capacity) {
   grow_to(new_capacity);
 }
 
+template <typename T, std::size_t InlineCapacity>
+void SmallVector<T, InlineCapacity>::resize(size_type new_size) {
+  if (new_size <= size_) {
+    std::destroy_n(data_ + new_size, size_ - new_size);
+    size_ = new_size;
+    return;
+  }
+  reserve(new_size);
+  std::uninitialized_value_construct(data_ + size_, data_ + new_size);
+  size_ = new_size;
+}
+
+template <typename T, std::size_t InlineCapacity>
+void SmallVector<T, InlineCapacity>::resize(size_type new_size, default_init_t) {
+  if (new_size <= size_) {
+    resize(new_size);
+    return;
+  }
+  reserve(new_size);
+  std::uninitialized_default_construct(data_ + size_, data_ + new_size);
+  size_ = new_size;
+}
+
+template <typename T, std::size_t InlineCapacity>
+void SmallVector<T, InlineCapacity>::resize_uninitialized(size_type new_size) {
+  static_assert(std::is_trivially_default_constructible_v<T>,
+                "SmallVector::resize_uninitialized requires trivially default constructible T");
+  resize(new_size, default_init);
+}
+
+template <typename T, std::size_t InlineCapacity>
+template <typename Op>
+void SmallVector<T, InlineCapacity>::resize_and_overwrite(size_type n, Op op) {
+  static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                "SmallVector::resize_and_overwrite requires trivial T");
+  reserve(n);
+  const auto kept = static_cast<size_type>(std::move(op)(data_, n));
+  if (kept > n)
+    throw std::length_error("SmallVector::resize_and_overwrite: op kept more than n elements");
+  size_ = kept;
+}
+
 template <typename T, std::size_t InlineCapacity>
 template <typename... Args>
 T& SmallVector<T, InlineCapacity>::emplace_back(Args&&... args) {
-  if (size_ == capacity_) {
-    const size_type required = size_ + 1;
-    size_type next = capacity_ == 0 ? 1 : (capacity_ * 2);
-    if (next < required)
-      next = required;
-    grow_to(next);
-  }
+  if (size_ == capacity_)
+    grow_to(next_capacity());
 
   T* slot = data_ + size_;
   std::construct_at(slot, std::forward<Args>(args)...);
@@ -216,14 +269,34 @@ SmallVector<T, InlineCapacity>::emplace(const_iterator pos, Args&&... args) {
     return data_ + index;
   }
 
-  if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    // The new element is built before anything moves, since `args` may refer into the buffer.
     if (size_ == capacity_) {
-      const size_type required = size_ + 1;
-      size_type next = capacity_ == 0 ? 1 : (capacity_ * 2);
-      if (next < required)
-        next = required;
-      grow_to(next);
+      const size_type new_capacity = next_capacity();
+      T* new_data = allocate(new_capacity);
+      try {
+        std::construct_at(new_data + index, std::forward<Args>(args)...);
+      } catch (...) {
+        deallocate(new_data, new_capacity);
+        throw;
+      }
+      trivially_relocate(data_, data_ + index, new_data);
+      trivially_relocate(data_ + index, data_ + size_, new_data + index + 1);
+      if (!using_inline_storage())
+        deallocate(data_, capacity_);
+      data_ = new_data;
+      capacity_ = new_capacity;
+    } else {
+      alignas(T) std::byte staged[sizeof(T)];
+      T* value = std::construct_at(reinterpret_cast<T*>(staged), std::forward<Args>(args)...);
+      trivially_relocate(data_ + index, data_ + size_, data_ + index + 1);
+      trivially_relocate(value, value + 1, data_ + index);
     }
+    ++size_;
+    return data_ + index;
+  } else if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
+    if (size_ == capacity_)
+      grow_to(next_capacity());
 
     const size_type old_size = size_;
     if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
@@ -288,6 +361,94 @@ SmallVector<T, InlineCapacity>::emplace(const_iterator pos, Args&&... args) {
   }
 }
 
+template <typename T, std::size_t InlineCapacity>
+template <container_compatible_range<T> R>
+typename SmallVector<T, InlineCapacity>::iterator
+SmallVector<T, InlineCapacity>::insert_range(const_iterator pos, R&& rg) {
+  const size_type index = static_cast<size_type>(pos - cbegin());
+  if (index > size_)
+    throw std::out_of_range("SmallVector::insert_range position out of range");
+
+  if constexpr (!sized_or_forward_range<R>) {
+    if (index == size_) {
+      for (auto&& v : rg)
+        emplace_back(std::forward<decltype(v)>(v));
+      return data_ + index;
+    }
+    SmallVector staged;
+    for (auto&& v : rg)
+      staged.emplace_back(std::forward<decltype(v)>(v));
+    return insert_range(pos, std::ranges::subrange(std::make_move_iterator(staged.begin()),
+                                                   std::make_move_iterator(staged.end())));
+  } else {
+    const size_type n = range_length(rg);
+    if (n == 0)
+      return data_ + index;
+
+    // data_ is only null when capacity_ is 0; testing it spares GCC a false -Wnonnull on memmove.
+    if (data_ && n <= capacity_ - size_) {
+      if constexpr (is_trivially_relocatable_v<T>) {
+        trivially_relocate(data_ + index, data_ + size_, data_ + index + n);
+        try {
+          uninitialized_copy_range(rg, data_ + index);
+        } catch (...) {
+          trivially_relocate(data_ + index + n, data_ + size_ + n, data_ + index);
+          throw;
+        }
+        size_ += n;
+        return data_ + index;
+      } else if constexpr (std::is_move_constructible_v<T> && std::is_move_assignable_v<T>) {
+        const size_type old_size = size_;
+        uninitialized_copy_range(rg, data_ + size_);
+        size_ += n;
+        std::rotate(data_ + index, data_ + old_size, data_ + size_);
+        return data_ + index;
+      }
+    }
+
+    const size_type new_capacity =
+        n <= capacity_ - size_ ? capacity_ : std::max(next_capacity(), size_ + n);
+    T* new_data = allocate(new_capacity);
+    try {
+      uninitialized_copy_range(rg, new_data + index);
+    } catch (...) {
+      deallocate(new_data, new_capacity);
+      throw;
+    }
+    if constexpr (is_trivially_relocatable_v<T>) {
+      trivially_relocate(data_, data_ + index, new_data);
+      trivially_relocate(data_ + index, data_ + size_, new_data + index + n);
+    } else {
+      auto transfer = [](T* first, size_type count, T* dest) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+          std::uninitialized_move_n(first, count, dest);
+        else
+          std::uninitialized_copy_n(first, count, dest);
+      };
+      try {
+        transfer(data_, index, new_data);
+        try {
+          transfer(data_ + index, size_ - index, new_data + index + n);
+        } catch (...) {
+          std::destroy_n(new_data, index);
+          throw;
+        }
+      } catch (...) {
+        std::destroy_n(new_data + index, n);
+        deallocate(new_data, new_capacity);
+        throw;
+      }
+      std::destroy_n(data_, size_);
+    }
+    if (!using_inline_storage())
+      deallocate(data_, capacity_);
+    data_ = new_data;
+    capacity_ = new_capacity;
+    size_ += n;
+    return data_ + index;
+  }
+}
+
 template <typename T, std::size_t InlineCapacity>
 typename SmallVector<T, InlineCapacity>::iterator
 SmallVector<T, InlineCapacity>::erase(const_iterator pos) {
@@ -311,7 +472,12 @@ SmallVector<T, InlineCapacity>::erase(const_iterator first, const_iterator last)
   if (count == 0)
     return data_ + first_index;
 
-  if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    std::destroy_n(data_ + first_index, count);
+    trivially_relocate(data_ + last_index, data_ + size_, data_ + first_index);
+    size_ -= count;
+    return data_ + first_index;
+  } else if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
     if constexpr (std::is_nothrow_move_assignable_v<T> || !std::is_copy_assignable_v<T>) {
       std::move(data_ + last_index, data_ + size_, data_ + first_index);
     } else {
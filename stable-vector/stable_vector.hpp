@@ -1,11 +1,13 @@
 #pragma once
 
 #include "unique-ptr/unique_ptr.hpp"
+#include "utility/ranges.hpp"
 #include "vector/vector.hpp"
 
 #include <cstddef>
 #include <initializer_list>
 #include <iterator>
+#include <ranges>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -74,6 +76,14 @@ public:
     return emplace(pos, std::move(value));
   }
 
+  // C++23 range insertion. Every element still gets its own allocation, but the slot vector
+  // grows at most once and its tail of pointers shifts once. assign_range is all-or-nothing.
+  template <container_compatible_range<T> R> void append_range(R&& rg) {
+    insert_range(cend(), std::forward<R>(rg));
+  }
+  template <container_compatible_range<T> R> iterator insert_range(const_iterator pos, R&& rg);
+  template <container_compatible_range<T> R> void assign_range(R&& rg);
+
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
 
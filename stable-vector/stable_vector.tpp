@@ -75,6 +75,29 @@ typename StableVector<T>::iterator StableVector<T>::emplace(const_iterator pos,
   return iterator(it);
 }
 
+template <typename T>
+template <container_compatible_range<T> R>
+typename StableVector<T>::iterator StableVector<T>::insert_range(const_iterator pos, R&& rg) {
+  // Allocate every element before touching slots_, so a throwing constructor changes nothing.
+  Vector<unique_ptr<T>> staged;
+  if constexpr (sized_or_forward_range<R>)
+    staged.reserve(range_length(rg));
+  for (auto&& v : rg)
+    staged.emplace_back(make(std::forward<decltype(v)>(v)));
+  auto it = slots_.insert_range(pos.base(),
+                                std::ranges::subrange(std::make_move_iterator(staged.begin()),
+                                                      std::make_move_iterator(staged.end())));
+  return iterator(it);
+}
+
+template <typename T>
+template <container_compatible_range<T> R>
+void StableVector<T>::assign_range(R&& rg) {
+  StableVector tmp;
+  tmp.append_range(std::forward<R>(rg));
+  slots_.swap(tmp.slots_);
+}
+
 template <typename T>
 typename StableVector<T>::iterator StableVector<T>::erase(const_iterator pos) {
   auto it = slots_.erase(pos.base());
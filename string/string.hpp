@@ -2,12 +2,17 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 #include <string_view>
 #include <type_traits>
 #include <utility>
 
+#include "utility/default_init.hpp"
+#include "utility/ranges.hpp"
+#include "utility/relocate.hpp"
+
 template <typename CharT> class basic_string {
 public:
   using value_type = CharT;
@@ -57,10 +62,25 @@ public:
   const_reference back() const;
 
   void reserve(size_type new_capacity);
+
+  // resize(n) fills new characters with CharT{}; resize(n, default_init) and
+  // resize_uninitialized(n) leave them unwritten. resize_and_overwrite(n, op) is as in C++23:
+  // `op(data(), n)` fills the buffer and returns the new size, at most n.
+  void resize(size_type new_size);
+  void resize(size_type new_size, default_init_t);
+  void resize_uninitialized(size_type new_size);
+  template <typename Op> void resize_and_overwrite(size_type n, Op op);
   void push_back(CharT ch);
 
   basic_string& append(std::basic_string_view<CharT> sv);
 
+  // C++23 range insertion. Sized and forward ranges grow the buffer at most once and move the
+  // tail once; contiguous ranges of CharT are copied with memcpy. `rg` must not overlap the
+  // string.
+  template <container_compatible_range<CharT> R> basic_string& append_range(R&& rg);
+  template <container_compatible_range<CharT> R> iterator insert_range(const_iterator pos, R&& rg);
+  template <container_compatible_range<CharT> R> basic_string& assign_range(R&& rg);
+
   basic_string& operator+=(std::basic_string_view<CharT> sv);
   basic_string& operator+=(const basic_string& other);
   basic_string& operator+=(CharT ch);
@@ -80,14 +100,26 @@ private:
   size_type capacity_;
   CharT sso_[sso_capacity_ + 1];
 
+  // Short strings live in sso_ and leave data_ null, so no member points into the object itself
+  // and a string can be relocated by copying its bytes. Heap capacities are always larger.
   bool is_sso() const noexcept {
-    return data_ == sso_;
+    return capacity_ == sso_capacity_;
+  }
+  pointer ptr() noexcept {
+    return is_sso() ? sso_ : data_;
+  }
+  const_pointer ptr() const noexcept {
+    return is_sso() ? sso_ : data_;
   }
   void set_sso_empty() noexcept;
   void ensure_capacity_for_one_more();
   void reallocate(size_type new_capacity);
 };
 
+// Short strings keep their characters inline without pointing at them (see is_sso()).
+template <typename CharT>
+struct is_trivially_relocatable<basic_string<CharT>> : std::true_type {};
+
 using string = basic_string<char>;
 
 #include "string.tpp"
@@ -1,5 +1,6 @@
 template <typename CharT>
-basic_string<CharT>::basic_string() noexcept : data_(sso_), size_(0), capacity_(sso_capacity_) {
+basic_string<CharT>::basic_string() noexcept
+    : data_(nullptr), size_(0), capacity_(sso_capacity_) {
   sso_[0] = CharT{};
 }
 
@@ -10,9 +11,9 @@ basic_string<CharT>::basic_string(const CharT* s)
 template <typename CharT>
 basic_string<CharT>::basic_string(std::basic_string_view<CharT> sv) : basic_string() {
   reserve(sv.size());
-  std::copy_n(sv.data(), sv.size(), data_);
+  std::copy_n(sv.data(), sv.size(), ptr());
   size_ = sv.size();
-  data_[size_] = CharT{};
+  ptr()[size_] = CharT{};
 }
 
 template <typename CharT>
@@ -26,7 +27,7 @@ basic_string<CharT>::basic_string(basic_string&& other) noexcept : basic_string(
     return;
   }
 
-  data_ = std::exchange(other.data_, other.sso_);
+  data_ = std::exchange(other.data_, nullptr);
   size_ = std::exchange(other.size_, 0);
   capacity_ = std::exchange(other.capacity_, other.sso_capacity_);
   other.sso_[0] = CharT{};
@@ -56,14 +57,14 @@ basic_string<CharT>& basic_string<CharT>::operator=(basic_string&& other) noexce
 
   if (other.is_sso()) {
     reserve(other.size_);
-    std::copy_n(other.data_, other.size_, data_);
+    std::copy_n(other.ptr(), other.size_, ptr());
     size_ = other.size_;
-    data_[size_] = CharT{};
+    ptr()[size_] = CharT{};
     other.clear();
     return *this;
   }
 
-  data_ = std::exchange(other.data_, other.sso_);
+  data_ = std::exchange(other.data_, nullptr);
   size_ = std::exchange(other.size_, 0);
   capacity_ = std::exchange(other.capacity_, other.sso_capacity_);
   other.sso_[0] = CharT{};
@@ -71,7 +72,7 @@ basic_string<CharT>& basic_string<CharT>::operator=(basic_string&& other) noexce
 }
 
 template <typename CharT> void basic_string<CharT>::set_sso_empty() noexcept {
-  data_ = sso_;
+  data_ = nullptr;
   size_ = 0;
   capacity_ = sso_capacity_;
   sso_[0] = CharT{};
@@ -79,7 +80,7 @@ template <typename CharT> void basic_string<CharT>::set_sso_empty() noexcept {
 
 template <typename CharT> void basic_string<CharT>::clear() noexcept {
   size_ = 0;
-  data_[0] = CharT{};
+  ptr()[0] = CharT{};
 }
 
 template <typename CharT> bool basic_string<CharT>::empty() const noexcept {
@@ -98,98 +99,98 @@ typename basic_string<CharT>::size_type basic_string<CharT>::capacity() const no
 
 template <typename CharT>
 typename basic_string<CharT>::const_pointer basic_string<CharT>::c_str() const noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_pointer basic_string<CharT>::data() const noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::pointer basic_string<CharT>::data() noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::iterator basic_string<CharT>::begin() noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::iterator basic_string<CharT>::end() noexcept {
-  return data_ + size_;
+  return ptr() + size_;
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_iterator basic_string<CharT>::begin() const noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_iterator basic_string<CharT>::end() const noexcept {
-  return data_ + size_;
+  return ptr() + size_;
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_iterator basic_string<CharT>::cbegin() const noexcept {
-  return data_;
+  return ptr();
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_iterator basic_string<CharT>::cend() const noexcept {
-  return data_ + size_;
+  return ptr() + size_;
 }
 
 template <typename CharT>
 typename basic_string<CharT>::reference basic_string<CharT>::operator[](size_type i) noexcept {
-  return data_[i];
+  return ptr()[i];
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_reference
 basic_string<CharT>::operator[](size_type i) const noexcept {
-  return data_[i];
+  return ptr()[i];
 }
 
 template <typename CharT>
 typename basic_string<CharT>::reference basic_string<CharT>::at(size_type i) {
   if (i >= size_)
     throw std::out_of_range("basic_string::at out of range");
-  return data_[i];
+  return ptr()[i];
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_reference basic_string<CharT>::at(size_type i) const {
   if (i >= size_)
     throw std::out_of_range("basic_string::at out of range");
-  return data_[i];
+  return ptr()[i];
 }
 
 template <typename CharT> typename basic_string<CharT>::reference basic_string<CharT>::front() {
   if (empty())
     throw std::out_of_range("basic_string::front on empty");
-  return data_[0];
+  return ptr()[0];
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_reference basic_string<CharT>::front() const {
   if (empty())
     throw std::out_of_range("basic_string::front on empty");
-  return data_[0];
+  return ptr()[0];
 }
 
 template <typename CharT> typename basic_string<CharT>::reference basic_string<CharT>::back() {
   if (empty())
     throw std::out_of_range("basic_string::back on empty");
-  return data_[size_ - 1];
+  return ptr()[size_ - 1];
 }
 
 template <typename CharT>
 typename basic_string<CharT>::const_reference basic_string<CharT>::back() const {
   if (empty())
     throw std::out_of_range("basic_string::back on empty");
-  return data_[size_ - 1];
+  return ptr()[size_ - 1];
 }
 
 template <typename CharT> void basic_string<CharT>::reserve(size_type new_capacity) {
@@ -198,16 +199,45 @@ template <typename CharT> void basic_string<CharT>::reserve(size_type new_capaci
   reallocate(new_capacity);
 }
 
+template <typename CharT> void basic_string<CharT>::resize(size_type new_size) {
+  const size_type old_size = size_;
+  resize_uninitialized(new_size);
+  if (new_size > old_size)
+    std::fill(ptr() + old_size, ptr() + new_size, CharT{});
+}
+
+template <typename CharT> void basic_string<CharT>::resize(size_type new_size, default_init_t) {
+  resize_uninitialized(new_size);
+}
+
+template <typename CharT> void basic_string<CharT>::resize_uninitialized(size_type new_size) {
+  reserve(new_size);
+  size_ = new_size;
+  ptr()[size_] = CharT{};
+}
+
+template <typename CharT>
+template <typename Op>
+void basic_string<CharT>::resize_and_overwrite(size_type n, Op op) {
+  reserve(n);
+  const auto kept = static_cast<size_type>(std::move(op)(ptr(), n));
+  if (kept > n)
+    throw std::length_error("basic_string::resize_and_overwrite: op kept more than n characters");
+  size_ = kept;
+  ptr()[size_] = CharT{};
+}
+
 template <typename CharT> void basic_string<CharT>::ensure_capacity_for_one_more() {
   if (size_ < capacity_)
     return;
-  const size_type next = capacity_ == 0 ? 1 : (capacity_ + (capacity_ >> 1));
+  // At least one more, so a heap capacity never equals sso_capacity_ (see is_sso()).
+  const size_type next = capacity_ + std::max<size_type>(capacity_ >> 1, 1);
   reallocate(next);
 }
 
 template <typename CharT> void basic_string<CharT>::reallocate(size_type new_capacity) {
   pointer next = alloc_.allocate(new_capacity + 1);
-  std::copy_n(data_, size_ + 1, next);
+  std::copy_n(ptr(), size_ + 1, next);
   if (!is_sso())
     alloc_.deallocate(data_, capacity_ + 1);
   data_ = next;
@@ -216,20 +246,61 @@ template <typename CharT> void basic_string<CharT>::reallocate(size_type new_cap
 
 template <typename CharT> void basic_string<CharT>::push_back(CharT ch) {
   ensure_capacity_for_one_more();
-  data_[size_] = ch;
+  ptr()[size_] = ch;
   ++size_;
-  data_[size_] = CharT{};
+  ptr()[size_] = CharT{};
 }
 
 template <typename CharT>
 basic_string<CharT>& basic_string<CharT>::append(std::basic_string_view<CharT> sv) {
   reserve(size_ + sv.size());
-  std::copy_n(sv.data(), sv.size(), data_ + size_);
+  std::copy_n(sv.data(), sv.size(), ptr() + size_);
   size_ += sv.size();
-  data_[size_] = CharT{};
+  ptr()[size_] = CharT{};
+  return *this;
+}
+
+template <typename CharT>
+template <container_compatible_range<CharT> R>
+basic_string<CharT>& basic_string<CharT>::append_range(R&& rg) {
+  insert_range(cend(), std::forward<R>(rg));
   return *this;
 }
 
+template <typename CharT>
+template <container_compatible_range<CharT> R>
+typename basic_string<CharT>::iterator basic_string<CharT>::insert_range(const_iterator pos,
+                                                                         R&& rg) {
+  const size_type index = static_cast<size_type>(pos - cbegin());
+  if (index > size_)
+    throw std::out_of_range("basic_string::insert_range position out of range");
+
+  if constexpr (!sized_or_forward_range<R>) {
+    const size_type old_size = size_;
+    for (auto&& ch : rg)
+      push_back(static_cast<CharT>(ch));
+    std::rotate(ptr() + index, ptr() + old_size, ptr() + size_);
+  } else {
+    const size_type n = range_length(rg);
+    if (size_ + n > capacity_)
+      reserve(std::max(size_ + n, capacity_ + (capacity_ >> 1)));
+    CharT* p = ptr();
+    // The tail moves with its null terminator.
+    std::memmove(static_cast<void*>(p + index + n), static_cast<const void*>(p + index),
+                 (size_ - index + 1) * sizeof(CharT));
+    uninitialized_copy_range(rg, p + index);
+    size_ += n;
+  }
+  return ptr() + index;
+}
+
+template <typename CharT>
+template <container_compatible_range<CharT> R>
+basic_string<CharT>& basic_string<CharT>::assign_range(R&& rg) {
+  clear();
+  return append_range(std::forward<R>(rg));
+}
+
 template <typename CharT>
 basic_string<CharT>& basic_string<CharT>::operator+=(std::basic_string_view<CharT> sv) {
   return append(sv);
@@ -246,5 +317,5 @@ template <typename CharT> basic_string<CharT>& basic_string<CharT>::operator+=(C
 }
 
 template <typename CharT> std::basic_string_view<CharT> basic_string<CharT>::view() const noexcept {
-  return std::basic_string_view<CharT>(data_, size_);
+  return std::basic_string_view<CharT>(ptr(), size_);
 }
@@ -0,0 +1,99 @@
+#include "test.hpp"
+
+#include "concurrent-map/concurrent_map.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("concurrent_map: insert/find/erase/update") {
+  concurrent_map<std::string, int> m;
+  CHECK(m.empty());
+
+  CHECK(m.insert("a", 1));
+  CHECK(!m.insert("a", 2));
+  CHECK(!m.insert_or_assign("a", 3));
+  CHECK(m.insert_or_assign("b", 4));
+  CHECK_EQ(m.find("a").value(), 3);
+  CHECK(!m.find("missing").has_value());
+
+  int seen = 0;
+  CHECK(m.cvisit("b", [&](const std::string&, const int& v) { seen = v; }));
+  CHECK_EQ(seen, 4);
+  CHECK(!m.cvisit("missing", [](const std::string&, const int&) {}));
+
+  auto before = m.snapshot();
+  m.update([](auto& draft) {
+    draft["c"] = 5;
+    draft.erase("a");
+  });
+  auto abandoned = [](auto& draft) {
+    draft["d"] = 6;
+    throw std::runtime_error("abandoned");
+  };
+  CHECK_THROWS_AS(m.update(abandoned), std::runtime_error);
+  CHECK(!m.contains("d"));
+
+  CHECK(m.erase("b"));
+  CHECK(!m.erase("b"));
+  CHECK_EQ(m.size(), 1u);
+  CHECK_EQ(m.read([](const auto& v) { return v.begin()->first; }), "c");
+
+  // The snapshot is unaffected by later writes.
+  CHECK_EQ(before.size(), 2u);
+  CHECK_EQ(before.at("a"), 3);
+  CHECK_EQ(before.at("b"), 4);
+}
+
+TEST_CASE("concurrent_map: readers see whole versions while a writer runs") {
+  // The writer keeps the keys a sliding window [lo, hi) with value 2 * key, and moves it one
+  // step per version, so every version a reader sees must be such a window.
+  concurrent_map<int, int> m;
+  constexpr int kWindow = 64;
+  constexpr int kVersions = 4000;
+  std::atomic<bool> done{false};
+  std::atomic<int> bad{0};
+
+  {
+    std::vector<std::jthread> readers;
+    for (int t = 0; t < 3; ++t) {
+      readers.emplace_back([&] {
+        while (!done.load()) {
+          m.read([&](const auto& v) {
+            int expect = v.empty() ? 0 : v.begin()->first;
+            for (const auto& [k, val] : v) {
+              if (k != expect++ || val != 2 * k)
+                ++bad;
+            }
+            if (v.size() > static_cast<std::size_t>(kWindow))
+              ++bad;
+          });
+        }
+      });
+    }
+
+    for (int i = 0; i < kVersions; ++i) {
+      if (i >= kWindow) {
+        m.update([&](auto& draft) {
+          draft.erase(i - kWindow);
+          draft[i] = 2 * i;
+        });
+      } else {
+        m.insert(i, 2 * i);
+      }
+    }
+    done = true;
+  }
+
+  CHECK_EQ(bad.load(), 0);
+  CHECK_EQ(m.size(), static_cast<std::size_t>(kWindow));
+  CHECK_EQ(m.find(kVersions - 1).value(), 2 * (kVersions - 1));
+
+  // With no guard held, two collections advance past every retired version.
+  for (int i = 0; i < 3; ++i)
+    ebr_collect();
+  CHECK_EQ(ebr_pending(), 0u);
+}
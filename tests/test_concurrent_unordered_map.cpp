@@ -0,0 +1,66 @@
+#include "test.hpp"
+
+#include "concurrent-unordered-map/concurrent_unordered_map.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("concurrent_unordered_map: insert/visit/erase") {
+  concurrent_unordered_map<std::string, int> m;
+  CHECK(m.empty());
+
+  CHECK(m.insert("a", 1));
+  CHECK(!m.insert("a", 2));
+  CHECK(!m.insert_or_assign("a", 3));
+  CHECK(m.insert_or_assign("b", 4));
+
+  int seen = 0;
+  CHECK(m.cvisit("a", [&](const std::string&, const int& v) { seen = v; }));
+  CHECK_EQ(seen, 3);
+  CHECK(m.visit("b", [](const std::string&, int& v) { v += 10; }));
+  CHECK(!m.visit("missing", [](const std::string&, int&) {}));
+
+  CHECK(!m.insert_or_visit("b", 0, [](const std::string&, int& v) { ++v; }));
+  CHECK(m.cvisit("b", [&](const std::string&, const int& v) { seen = v; }));
+  CHECK_EQ(seen, 15);
+
+  CHECK(!m.erase_if("a", [](const std::string&, const int& v) { return v > 100; }));
+  CHECK(m.erase("a"));
+  CHECK(!m.contains("a"));
+  CHECK_EQ(m.size(), 1u);
+}
+
+TEST_CASE("concurrent_unordered_map: parallel writers and for_each") {
+  concurrent_unordered_map<int, int, std::hash<int>, std::equal_to<int>, 8> m;
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 2000;
+
+  {
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+      workers.emplace_back([&m, t] {
+        for (int i = 0; i < kPerThread; ++i) {
+          m.insert(t * kPerThread + i, i);
+          m.insert_or_visit(-1, 1, [](const int&, int& v) { ++v; });
+        }
+      });
+    }
+  }
+
+  CHECK_EQ(m.size(), static_cast<std::size_t>(kThreads * kPerThread + 1));
+  int counter = 0;
+  m.cvisit(-1, [&](const int&, const int& v) { counter = v; });
+  CHECK_EQ(counter, kThreads * kPerThread);
+
+  std::atomic<long long> sum{0};
+  m.for_each([&](const int& k, const int&) { sum += k >= 0 ? 1 : 0; }, 4);
+  CHECK_EQ(sum.load(), kThreads * kPerThread);
+
+  CHECK_EQ(m.erase_if([](const int& k, const int&) { return k % 2 == 0; }),
+           static_cast<std::size_t>(kThreads * kPerThread / 2));
+  std::size_t remaining = 0;
+  m.for_each([&](const int&, const int&) { ++remaining; });
+  CHECK_EQ(remaining, m.size());
+}
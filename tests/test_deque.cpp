@@ -1,6 +1,67 @@
 #include "test.hpp"
 
 #include "deque/deque.hpp"
+#include "string/string.hpp"
+#include "vector/huge_page_allocator.hpp"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <ranges>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// Stateful allocator identified by `id`; allocators with different ids compare unequal. The
+// propagation traits are parameters so each combination can be checked.
+template <typename T, bool Pocca, bool Pocma> struct tagged_allocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::bool_constant<Pocca>;
+  using propagate_on_container_move_assignment = std::bool_constant<Pocma>;
+  using is_always_equal = std::false_type;
+  template <typename U> struct rebind {
+    using other = tagged_allocator<U, Pocca, Pocma>;
+  };
+
+  int id;
+
+  explicit tagged_allocator(int tag) : id(tag) {}
+  template <typename U>
+  tagged_allocator(const tagged_allocator<U, Pocca, Pocma>& other) : id(other.id) {}
+
+  T* allocate(std::size_t n) {
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const tagged_allocator& a, const tagged_allocator& b) {
+    return a.id == b.id;
+  }
+};
+
+template <bool Pocca, bool Pocma> void check_assignment_propagation() {
+  using alloc = tagged_allocator<int, Pocca, Pocma>;
+  Deque<int, alloc> a{alloc(1)};
+  for (int i = 0; i < 10; ++i)
+    a.push_back(i);
+
+  Deque<int, alloc> b{alloc(2)};
+  b.push_back(-1);
+  b = a;
+  CHECK_EQ(b.get_allocator().id, Pocca ? 1 : 2);
+  CHECK_EQ(b.size(), 10u);
+  CHECK_EQ(b[9], 9);
+
+  Deque<int, alloc> c{alloc(3)};
+  c = std::move(b);
+  CHECK_EQ(c.get_allocator().id, Pocma ? b.get_allocator().id : 3);
+  CHECK_EQ(c.size(), 10u);
+  CHECK_EQ(c[4], 4);
+}
+} // namespace
 
 TEST_CASE("Deque: push/pop front/back and indexing") {
   Deque<int> d;
@@ -34,3 +95,81 @@ TEST_CASE("Deque: wraparound growth") {
   CHECK_EQ(d.size(), 75u);
   CHECK_EQ(d.back(), 49);
 }
+
+TEST_CASE("Deque: wraparound growth with relocatable elements") {
+  Deque<string> d;
+  for (int i = 0; i < 6; ++i)
+    d.push_back(i % 2 ? "odd" : "an even element stored on the heap");
+  d.pop_front();
+  d.pop_front();
+  for (int i = 0; i < 8; ++i)
+    d.push_front("front");
+  REQUIRE_EQ(d.size(), 12u);
+  CHECK_EQ(d[0].view(), "front");
+  CHECK_EQ(d[8].view(), "an even element stored on the heap");
+  CHECK_EQ(d.back().view(), "odd");
+}
+
+TEST_CASE("Deque: range insertion") {
+  Deque<int> d;
+  for (int i = 0; i < 6; ++i)
+    d.push_back(i);
+  d.pop_front();
+  d.pop_front(); // [2, 6), head moved off slot 0
+
+  const std::vector<int> back{6, 7, 8};
+  d.append_range(back); // wraps around the end of the buffer
+  const std::vector<int> front{0, 1};
+  d.prepend_range(front);
+  CHECK_EQ(d.size(), 9u);
+  for (int i = 0; i < 9; ++i)
+    CHECK_EQ(d[static_cast<std::size_t>(i)], i);
+
+  const std::list<int> near_front{-1, -2};
+  auto it = d.insert_range(d.cbegin() + 1, near_front);
+  CHECK_EQ(*it, -1);
+  const std::list<int> near_back{-3};
+  d.insert_range(d.cbegin() + 9, near_back);
+  CHECK_EQ(d.size(), 12u);
+  CHECK_EQ(d[0], 0);
+  CHECK_EQ(d[2], -2);
+  CHECK_EQ(d[3], 1);
+  CHECK_EQ(d[9], -3);
+  CHECK_EQ(d[11], 8);
+
+  std::istringstream in("3 4");
+  Deque<string> names;
+  names.push_back(string("x"));
+  names.prepend_range(std::views::istream<int>(in) |
+                      std::views::transform([](int v) { return string(std::to_string(v)); }));
+  CHECK_EQ(names[0].view(), "3");
+  CHECK_EQ(names[2].view(), "x");
+  names.assign_range(back | std::views::transform([](int v) { return string(std::to_string(v)); }));
+  CHECK_EQ(names.size(), 3u);
+  CHECK_EQ(names[2].view(), "8");
+}
+
+TEST_CASE("Deque: allocator parameter") {
+  Deque<int, huge_page_allocator<int>> d;
+  for (int i = 0; i < 1'000'000; ++i)
+    d.push_back(i);
+  for (int i = 0; i < 1000; ++i)
+    d.pop_front();
+  d.push_front(-1);
+  CHECK_EQ(d.size(), 999'001u);
+  CHECK_EQ(d.front(), -1);
+  CHECK_EQ(d[1], 1000);
+  CHECK_EQ(d.back(), 999'999);
+
+  auto copy = d;
+  auto moved = std::move(d);
+  CHECK_EQ(copy[500], moved[500]);
+  CHECK(d.empty());
+}
+
+TEST_CASE("Deque: assignment follows the allocator's propagation traits") {
+  check_assignment_propagation<false, false>();
+  check_assignment_propagation<true, false>();
+  check_assignment_propagation<false, true>();
+  check_assignment_propagation<true, true>();
+}
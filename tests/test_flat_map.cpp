@@ -3,6 +3,7 @@
 #include "flat-map/flat_map.hpp"
 
 #include <string>
+#include <string_view>
 
 TEST_CASE("FlatMap: insert/find/iteration order") {
   FlatMap<int, std::string> m;
@@ -54,3 +55,18 @@ TEST_CASE("FlatMap: operator[]/at/erase") {
 
   CHECK_THROWS(m.at(2));
 }
+
+TEST_CASE("FlatMap: transparent lookup with string_view") {
+  FlatMap<std::string, int, std::less<>> m;
+  m.emplace("a", 1);
+  m.emplace("c", 3);
+
+  CHECK(m.contains(std::string_view("a")));
+  CHECK_EQ(m.count(std::string_view("b")), 0u);
+  CHECK_EQ(m.lower_bound(std::string_view("b"))->first, "c");
+
+  auto [first, last] = m.equal_range(std::string_view("c"));
+  CHECK_EQ(last - first, 1);
+  CHECK_EQ(m.erase(std::string_view("c")), 1u);
+  CHECK(m.find(std::string_view("c")) == m.end());
+}
@@ -0,0 +1,116 @@
+#include "test.hpp"
+
+#include "frozen-unordered-map/frozen_unordered_map.hpp"
+#include "unordered-map/unordered_map.hpp"
+#include "utility/mapped_file.hpp"
+#include "vector/vector.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST_CASE("frozen_unordered_map: freeze and query") {
+  unordered_map<std::string, std::uint64_t> m;
+  for (std::uint64_t i = 0; i < 1000; ++i)
+    m.emplace("key" + std::to_string(i), i * 3);
+  m.emplace("", 7);
+
+  const Vector<std::byte> blob = frozen_unordered_map<std::uint64_t>::freeze(m);
+  const frozen_unordered_map<std::uint64_t> f(blob);
+  CHECK_EQ(f.size(), m.size());
+
+  for (const auto& [k, v] : m) {
+    const auto found = f.find(k);
+    REQUIRE(found.has_value());
+    CHECK_EQ(found->get(), v);
+  }
+  CHECK(f.contains(""));
+  CHECK(!f.contains("key1000"));
+  CHECK(!f.find("missing").has_value());
+  CHECK_EQ(f.at("key42").get(), 126u);
+  CHECK_THROWS_AS(f.at("nope"), std::out_of_range);
+
+  std::size_t visited = 0;
+  f.for_each([&](std::string_view k, const std::uint64_t& v) {
+    CHECK_EQ(m.at(std::string(k)), v);
+    ++visited;
+  });
+  CHECK_EQ(visited, m.size());
+
+  const Vector<std::byte> empty_blob =
+      frozen_unordered_map<std::uint64_t>::freeze(unordered_map<std::string, std::uint64_t>{});
+  const frozen_unordered_map<std::uint64_t> empty(empty_blob);
+  CHECK(empty.empty());
+  CHECK(!empty.contains("key1"));
+  CHECK(!frozen_unordered_map<int>{}.contains("x"));
+}
+
+TEST_CASE("frozen_unordered_map: string and Vector values") {
+  unordered_map<std::string, std::string> names;
+  names.emplace("a", "alpha");
+  names.emplace("b", "");
+  names.emplace("c", std::string(100, 'c'));
+  const Vector<std::byte> names_blob = frozen_unordered_map<std::string>::freeze(names);
+  const frozen_unordered_map<std::string> fn(names_blob);
+  CHECK_EQ(fn.at("a"), "alpha");
+  CHECK_EQ(fn.at("b"), "");
+  CHECK_EQ(fn.at("c"), std::string(100, 'c'));
+
+  // Keys of odd lengths force the arena to pad before each Vector<double> payload.
+  std::vector<std::pair<std::string, Vector<double>>> lists;
+  lists.emplace_back("odd", Vector<double>{1.5, 2.5});
+  lists.emplace_back("x", Vector<double>{});
+  lists.emplace_back("longer", Vector<double>{3.0});
+  const Vector<std::byte> lists_blob = frozen_unordered_map<Vector<double>>::freeze(lists);
+  const frozen_unordered_map<Vector<double>> fl(lists_blob);
+  const Span<const double> odd = fl.at("odd");
+  REQUIRE_EQ(odd.size(), 2u);
+  CHECK_EQ(reinterpret_cast<std::uintptr_t>(odd.data()) % alignof(double), 0u);
+  CHECK_EQ(odd[1], 2.5);
+  CHECK(fl.at("x").empty());
+  CHECK_EQ(fl.at("longer")[0], 3.0);
+}
+
+TEST_CASE("frozen_unordered_map: rejects bad input") {
+  std::vector<std::pair<std::string, int>> dup{{"a", 1}, {"b", 2}, {"a", 3}};
+  CHECK_THROWS_AS(frozen_unordered_map<int>::freeze(dup), std::invalid_argument);
+
+  std::vector<std::pair<std::string, int>> ok{{"a", 1}};
+  Vector<std::byte> blob = frozen_unordered_map<int>::freeze(ok);
+  CHECK_THROWS_AS(frozen_unordered_map<std::string>(blob), std::invalid_argument);
+  CHECK_THROWS_AS(frozen_unordered_map<int>(Span<const std::byte>(blob.data(), 8)),
+                  std::invalid_argument);
+  blob[0] = std::byte{'X'};
+  CHECK_THROWS_AS(frozen_unordered_map<int>(blob), std::invalid_argument);
+}
+
+TEST_CASE("frozen_unordered_map: load from mapped file") {
+  unordered_map<std::string, std::uint64_t> m;
+  for (std::uint64_t i = 0; i < 100; ++i)
+    m.emplace(std::to_string(i), i);
+  const Vector<std::byte> blob = frozen_unordered_map<std::uint64_t>::freeze(m);
+
+  const auto path = std::filesystem::temp_directory_path() / "stl_frozen_map_test.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(blob.data()),
+              static_cast<std::streamsize>(blob.size()));
+  }
+
+  {
+    const mapped_file file(path.string());
+    CHECK_EQ(file.size(), blob.size());
+    const frozen_unordered_map<std::uint64_t> f(file.bytes());
+    CHECK_EQ(f.size(), 100u);
+    CHECK_EQ(f.at("57").get(), 57u);
+    CHECK(!f.contains("100"));
+  }
+  std::filesystem::remove(path);
+  CHECK_THROWS_AS(mapped_file(path.string()), std::runtime_error);
+}
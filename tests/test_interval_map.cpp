@@ -0,0 +1,127 @@
+#include "test.hpp"
+
+#include "interval-map/interval_map.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using Entry = std::tuple<int, int, int>;
+
+template <typename Range> std::vector<Entry> collect(const Range& r) {
+  std::vector<Entry> out;
+  for (const auto& [range, value] : r)
+    out.emplace_back(range.lo, range.hi, value);
+  return out;
+}
+
+// The linear scan that interval_map replaces, in map order.
+std::vector<Entry> scan(const interval_map<int, int>& m, int lo, int hi) {
+  std::vector<Entry> out;
+  for (const auto& [range, value] : m) {
+    if (range.lo < hi && lo < range.hi)
+      out.emplace_back(range.lo, range.hi, value);
+  }
+  return out;
+}
+
+// Ordered by `at` alone; `note` plays no part in equivalence, and there is no operator==.
+struct stamp {
+  int at;
+  int note;
+};
+
+struct stamp_less {
+  bool operator()(const stamp& a, const stamp& b) const {
+    return a.at < b.at;
+  }
+};
+
+} // namespace
+
+TEST_CASE("interval_map: overlapping, insert and erase") {
+  interval_map<int, std::string> m;
+  m.insert(10, 20, "a");
+  m.insert(15, 25, "b");
+  m.insert(30, 40, "c");
+  m.insert(0, 100, "all");
+  m.insert(10, 20, "a2");
+  CHECK_EQ(m.size(), 5u);
+  CHECK_THROWS_AS(m.insert(5, 5, "empty"), std::invalid_argument);
+
+  std::vector<std::string> hits;
+  for (const auto& [range, name] : m.overlapping(18, 31))
+    hits.push_back(name);
+  CHECK(hits == std::vector<std::string>{"all", "a", "a2", "b", "c"});
+
+  // Half-open: [20, 30) touches the ends of a and c but overlaps neither.
+  hits.clear();
+  for (const auto& [range, name] : m.overlapping(20, 30))
+    hits.push_back(name);
+  CHECK(hits == std::vector<std::string>{"all", "b"});
+  CHECK(m.overlapping(100, 200).empty());
+  CHECK_EQ(std::distance(m.overlapping(-5, 1).begin(), m.overlapping(-5, 1).end()), 1);
+
+  // Values can be updated in place, and base() leads back to the map for erase.
+  auto range = m.overlapping(35, 36);
+  for (auto it = range.begin(); it != range.end(); ++it)
+    it->second += "!";
+  CHECK_EQ(m.find({30, 40})->second, "c!");
+  CHECK_EQ(m.erase(interval<int>{10, 20}), 2u);
+  CHECK(m.find({10, 20}) == m.end());
+  m.erase(m.overlapping(0, 1).begin().base());
+  CHECK_EQ(m.size(), 2u);
+  CHECK(m.overlapping(5, 12).empty());
+}
+
+TEST_CASE("interval_map: matches a linear scan under random updates") {
+  interval_map<int, int> m;
+  std::mt19937 rng(18);
+  std::vector<interval<int>> live;
+  for (int step = 0; step < 4000; ++step) {
+    if (live.empty() || rng() % 3 != 0) {
+      const int lo = static_cast<int>(rng() % 10000);
+      const int hi = lo + 1 + static_cast<int>(rng() % (rng() % 8 == 0 ? 3000 : 100));
+      m.insert(lo, hi, step);
+      live.push_back({lo, hi});
+    } else {
+      const std::size_t i = rng() % live.size();
+      m.erase(m.find(live[i]));
+      live.erase(live.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    if (step % 50 == 0) {
+      const int lo = static_cast<int>(rng() % 11000) - 500;
+      const int hi = lo + static_cast<int>(rng() % 400);
+      REQUIRE(collect(m.overlapping(lo, hi)) == scan(m, lo, hi));
+    }
+  }
+  CHECK_EQ(m.size(), live.size());
+  const auto& view = m;
+  CHECK(collect(view.overlapping(0, 20000)) == scan(m, 0, 20000));
+}
+
+TEST_CASE("interval_map: find and erase match through Compare") {
+  interval_map<stamp, int, stamp_less> m;
+  m.insert(stamp{1, 0}, stamp{5, 0}, 1);
+  m.insert(stamp{1, 7}, stamp{5, 8}, 2);
+  m.insert(stamp{2, 0}, stamp{5, 0}, 3);
+
+  // Equivalent under stamp_less though the notes differ.
+  const interval<stamp> key{stamp{1, 9}, stamp{5, 9}};
+  auto it = m.find(key);
+  REQUIRE(it != m.end());
+  CHECK_EQ(it->first.lo.at, 1);
+  CHECK(m.find(interval<stamp>{stamp{1, 0}, stamp{4, 0}}) == m.end());
+
+  CHECK_EQ(m.erase(key), 2u);
+  CHECK_EQ(m.size(), 1u);
+  CHECK_EQ(m.begin()->second, 3);
+  CHECK_EQ(m.erase(key), 0u);
+}
@@ -3,7 +3,28 @@
 #include "map/map.hpp"
 #include "set/set.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Tiny nodes (a handful of values each) so a few thousand keys exercise every split, borrow and
+// merge path several levels deep.
+template <typename V, typename KeyOfValue, typename Compare, bool Multi>
+using SmallBTree = BTree<V, KeyOfValue, Compare, Multi, 48>;
+
+} // namespace
 
 TEST_CASE("map: insert/find/operator[]/erase") {
   map<std::string, int> m;
@@ -63,3 +84,448 @@ TEST_CASE("multiset: duplicates") {
 
   CHECK_EQ(s.erase_all(1), 2u);
 }
+
+TEST_CASE("map/multimap: transparent lookup with string_view") {
+  map<std::string, int, std::less<>> m;
+  m.insert({"apple", 1});
+  m.insert({"banana", 2});
+  m.insert({"cherry", 3});
+
+  const std::string_view key = "banana";
+  REQUIRE(m.find(key) != m.end());
+  CHECK_EQ(m.find(key)->second, 2);
+  CHECK_EQ(m.count(key), 1u);
+  CHECK_EQ(m.lower_bound(std::string_view("b"))->first, "banana");
+  CHECK_EQ(m.upper_bound(key)->first, "cherry");
+  m.erase(key);
+  CHECK(!m.contains(key));
+
+  multimap<std::string, int, std::less<>> mm;
+  mm.insert({"x", 1});
+  mm.insert({"x", 2});
+  mm.insert({"y", 3});
+  CHECK_EQ(mm.count(std::string_view("x")), 2u);
+  CHECK_EQ(mm.erase_all(std::string_view("x")), 2u);
+  CHECK_EQ(mm.size(), 1u);
+
+  set<std::string, std::less<>> s;
+  s.insert("k");
+  CHECK(s.contains(std::string_view("k")));
+}
+
+TEST_CASE("map: BTree backend matches std::map") {
+  map<int, std::string, std::less<int>, SmallBTree> m;
+  std::map<int, std::string> ref;
+  std::mt19937 rng(7);
+  for (int step = 0; step < 20000; ++step) {
+    const int key = static_cast<int>(rng() % 3000);
+    if (rng() % 3 != 0) {
+      const bool inserted = m.insert({key, std::to_string(key)}).second;
+      CHECK_EQ(inserted, ref.emplace(key, std::to_string(key)).second);
+    } else {
+      // erase(iterator) must return the successor even when the tree rebalances around it.
+      auto it = m.lower_bound(key);
+      auto rit = ref.lower_bound(key);
+      REQUIRE_EQ(it == m.end(), rit == ref.end());
+      if (it == m.end())
+        continue;
+      it = m.erase(it);
+      rit = ref.erase(rit);
+      REQUIRE_EQ(it == m.end(), rit == ref.end());
+      if (it != m.end())
+        CHECK_EQ(it->first, rit->first);
+    }
+  }
+  REQUIRE_EQ(m.size(), ref.size());
+  CHECK(std::equal(m.begin(), m.end(), ref.begin(), ref.end(), [](const auto& a, const auto& b) {
+    return a.first == b.first && a.second == b.second;
+  }));
+  CHECK(std::equal(std::make_reverse_iterator(m.end()), std::make_reverse_iterator(m.begin()),
+                   ref.rbegin(), ref.rend(),
+                   [](const auto& a, const auto& b) { return a.first == b.first; }));
+  CHECK_EQ(m.at(ref.begin()->first), ref.begin()->second);
+  CHECK(m.upper_bound(3000) == m.end());
+
+  while (!m.empty())
+    m.erase(m.begin());
+  CHECK(m.begin() == m.end());
+  m[5] = "five";
+  CHECK_EQ(m.at(5), "five");
+}
+
+TEST_CASE("multiset/set: BTree backend") {
+  multiset<int, std::less<int>, SmallBTree> ms;
+  std::multiset<int> ref;
+  std::mt19937 rng(11);
+  for (int i = 0; i < 5000; ++i) {
+    const int key = static_cast<int>(rng() % 200);
+    ms.insert(key);
+    ref.insert(key);
+  }
+  for (int key = 0; key < 200; key += 3)
+    CHECK_EQ(ms.erase_all(key), ref.erase(key));
+  REQUIRE_EQ(ms.size(), ref.size());
+  CHECK(std::equal(ms.begin(), ms.end(), ref.begin(), ref.end()));
+  CHECK_EQ(ms.count(1), ref.count(1));
+
+  // Sorted insertion takes the append-split path.
+  set<int, std::less<int>, BTree> s;
+  for (int i = 0; i < 10000; ++i)
+    CHECK(s.insert(i).second);
+  CHECK(!s.insert(42).second);
+  CHECK_EQ(*s.lower_bound(5000), 5000);
+  CHECK_EQ(*std::prev(s.end()), 9999);
+  std::size_t visited = 0;
+  for (int v : s)
+    visited += v == static_cast<int>(visited) ? 1 : 0;
+  CHECK_EQ(visited, 10000u);
+}
+
+TEST_CASE("set/multimap: CompactRbTree backend") {
+  set<std::uint32_t, std::less<std::uint32_t>, CompactRbTree> s;
+  std::set<std::uint32_t> ref;
+  std::mt19937 rng(19);
+  for (int i = 0; i < 20000; ++i) {
+    const std::uint32_t key = rng() % 5000;
+    if (rng() % 3 == 0) {
+      s.erase(key);
+      ref.erase(key);
+    } else {
+      CHECK_EQ(s.insert(key).second, ref.insert(key).second);
+    }
+  }
+  REQUIRE_EQ(s.size(), ref.size());
+  CHECK(std::equal(s.begin(), s.end(), ref.begin(), ref.end()));
+  CHECK(std::equal(std::make_reverse_iterator(s.end()), std::make_reverse_iterator(s.begin()),
+                   ref.rbegin(), ref.rend()));
+  CHECK_EQ(*s.lower_bound(2500), *ref.lower_bound(2500));
+
+  // Elements stay put while others come and go.
+  const auto* pinned = &*s.find(*ref.begin());
+  for (std::uint32_t key = 5000; key < 6000; ++key)
+    s.insert(key);
+  CHECK_EQ(&*s.find(*ref.begin()), pinned);
+
+  multimap<int, std::string, std::less<int>, CompactRbTree> mm;
+  for (int i = 0; i < 30; ++i)
+    mm.insert({i % 3, std::to_string(i)});
+  CHECK_EQ(mm.count(1), 10u);
+  auto nh = mm.extract(mm.find(2));
+  CHECK_EQ(nh.key(), 2);
+  mm.insert(std::move(nh));
+  CHECK_EQ(mm.count(2), 10u);
+  multimap<int, std::string, std::less<int>, CompactRbTree> other;
+  other.insert({7, "seven"});
+  mm.merge(other);
+  CHECK(other.empty());
+  CHECK_EQ(mm.size(), 31u);
+  auto sorted = decltype(mm)::from_sorted(mm.begin(), mm.end());
+  CHECK(std::equal(sorted.begin(), sorted.end(), mm.begin(), mm.end()));
+}
+
+TEST_CASE("map/multiset: order statistics") {
+  map<int, int, std::less<int>, OrderStatisticRbTree> m;
+  std::set<int> ref;
+  std::mt19937 rng(3);
+  for (int step = 0; step < 6000; ++step) {
+    const int key = static_cast<int>(rng() % 2000);
+    if (rng() % 4 != 0) {
+      m.insert({key, -key});
+      ref.insert(key);
+    } else {
+      m.erase(key);
+      ref.erase(key);
+    }
+  }
+  REQUIRE_EQ(m.size(), ref.size());
+
+  std::vector<int> sorted(ref.begin(), ref.end());
+  bool ranks_ok = true;
+  for (int key = -1; key <= 2000; key += 7) {
+    const auto expected = std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin();
+    ranks_ok = ranks_ok && m.rank(key) == static_cast<std::size_t>(expected);
+  }
+  CHECK(ranks_ok);
+
+  bool selects_ok = true;
+  for (std::size_t k = 0; k < sorted.size(); k += 5)
+    selects_ok = selects_ok && m.select(k)->first == sorted[k];
+  CHECK(selects_ok);
+  CHECK(m.select(sorted.size()) == m.end());
+  CHECK_EQ(m.distance(m.begin(), m.end()), static_cast<std::ptrdiff_t>(m.size()));
+  CHECK_EQ(m.distance(m.select(10), m.select(42)), 32);
+
+  multiset<int, std::less<int>, OrderStatisticRbTree> scores;
+  for (int s : {50, 70, 70, 70, 90, 100})
+    scores.insert(s);
+  CHECK_EQ(scores.count(70), 3u);
+  CHECK_EQ(scores.rank(90), 4u);
+  CHECK_EQ(*scores.select(5), 100);
+  CHECK_EQ(scores.erase_all(70), 3u);
+  CHECK_EQ(scores.rank(100), 2u);
+
+  map<std::string, int, std::less<>, OrderStatisticRbTree> names;
+  names.insert({"bob", 1});
+  names.insert({"alice", 2});
+  CHECK_EQ(names.rank(std::string_view("bob")), 1u);
+}
+
+TEST_CASE("map/set: from_sorted bulk construction") {
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < 5000; ++i)
+    pairs.emplace_back(2 * i, i);
+
+  auto m = map<int, int>::from_sorted(pairs.begin(), pairs.end());
+  REQUIRE_EQ(m.size(), pairs.size());
+  CHECK(std::equal(m.begin(), m.end(), pairs.begin(), pairs.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.first == b.first && a.second == b.second;
+                   }));
+
+  // The tree built in bulk must stay a valid red-black tree under later updates.
+  std::map<int, int> ref(pairs.begin(), pairs.end());
+  std::mt19937 rng(13);
+  for (int step = 0; step < 10000; ++step) {
+    const int key = static_cast<int>(rng() % 12000);
+    if (rng() % 2 == 0) {
+      m.insert({key, key});
+      ref.insert({key, key});
+    } else {
+      m.erase(key);
+      ref.erase(key);
+    }
+  }
+  REQUIRE_EQ(m.size(), ref.size());
+  CHECK(std::equal(m.begin(), m.end(), ref.begin(), ref.end(),
+                   [](const auto& a, const auto& b) { return a.first == b.first; }));
+
+  const std::vector<int> unsorted{1, 3, 2};
+  const std::vector<int> repeated{1, 2, 2, 3};
+  CHECK_THROWS_AS(set<int>::from_sorted(unsorted.begin(), unsorted.end()), std::invalid_argument);
+  CHECK_THROWS_AS(set<int>(sorted_unique, repeated.begin(), repeated.end()),
+                  std::invalid_argument);
+
+  multiset<int> dup(sorted_equivalent, repeated.begin(), repeated.end());
+  CHECK_EQ(dup.count(2), 2u);
+  CHECK_THROWS_AS(multiset<int>::from_sorted(unsorted.begin(), unsorted.end()),
+                  std::invalid_argument);
+
+  std::vector<int> keys(3000);
+  std::iota(keys.begin(), keys.end(), 0);
+  using ranked_set = set<int, std::less<int>, OrderStatisticRbTree>;
+  auto ranked = ranked_set::from_sorted(keys.begin(), keys.end());
+  CHECK_EQ(ranked.rank(1234), 1234u);
+  CHECK_EQ(*ranked.select(2999), 2999);
+
+  auto btree = set<int, std::less<int>, SmallBTree>::from_sorted(keys.begin(), keys.end());
+  REQUIRE_EQ(btree.size(), keys.size());
+  CHECK(std::equal(btree.begin(), btree.end(), keys.begin(), keys.end()));
+  for (int k = 0; k < 3000; k += 2)
+    btree.erase(k);
+  CHECK_EQ(btree.size(), 1500u);
+  CHECK_EQ(*btree.begin(), 1);
+  CHECK_THROWS_AS((set<int, std::less<int>, SmallBTree>::from_sorted(repeated.begin(),
+                                                                      repeated.end())),
+                  std::invalid_argument);
+}
+
+TEST_CASE("map/set: node handles move elements without copying") {
+  map<int, std::string> a;
+  for (int i = 0; i < 2000; ++i)
+    a.insert({i, std::to_string(i)});
+  const std::string* addr = &a.find(42)->second;
+
+  auto nh = a.extract(42);
+  REQUIRE_FALSE(nh.empty());
+  CHECK_EQ(nh.key(), 42);
+  CHECK_EQ(&nh.mapped(), addr);
+  CHECK_FALSE(a.contains(42));
+  CHECK(a.extract(42).empty());
+
+  map<int, std::string> b;
+  b.insert({7, "seven"});
+  auto inserted = b.insert(std::move(nh));
+  CHECK(inserted.inserted);
+  CHECK(inserted.node.empty());
+  CHECK_EQ(&inserted.position->second, addr);
+
+  // On a key clash the handle comes back with the element still in it.
+  auto clash = b.insert(a.extract(a.find(7)));
+  CHECK_FALSE(clash.inserted);
+  CHECK_EQ(clash.node.mapped(), "7");
+  CHECK_EQ(clash.position->second, "seven");
+  CHECK(a.insert(std::move(clash.node)).inserted);
+
+  // Keys already in `b` stay behind; every other node moves over in place.
+  addr = &a.find(1000)->second;
+  b.merge(a);
+  CHECK_EQ(a.size(), 1u);
+  CHECK_EQ(b.size(), 2000u);
+  CHECK_EQ(&b.find(1000)->second, addr);
+
+  multimap<int, std::string> mm;
+  mm.insert({1000, "dup"});
+  mm.merge(b);
+  CHECK(b.empty());
+  CHECK_EQ(mm.size(), 2001u);
+  CHECK_EQ(mm.count(1000), 2u);
+  b.insert(mm.extract(1000));
+  CHECK_EQ(b.size(), 1u);
+
+  // Nodes traded back and forth outlive the tree that allocated them.
+  auto orphan = [] {
+    set<int> s;
+    s.insert(5);
+    return s.extract(5);
+  }();
+  CHECK_EQ(orphan.value(), 5);
+  orphan.value() = 6;
+  set<int> t;
+  t.insert(std::move(orphan));
+  CHECK(t.contains(6));
+
+  std::mt19937 rng(3);
+  multiset<int> x;
+  multiset<int> y;
+  std::multiset<int> ref_x;
+  std::multiset<int> ref_y;
+  for (int step = 0; step < 5000; ++step) {
+    const int key = static_cast<int>(rng() % 100);
+    if (rng() % 2 == 0) {
+      x.insert(key);
+      ref_x.insert(key);
+    } else if (auto h = x.extract(key)) {
+      y.insert(std::move(h));
+      ref_x.erase(ref_x.find(key));
+      ref_y.insert(key);
+    }
+    if (step % 1000 == 999) {
+      std::swap(x, y);
+      std::swap(ref_x, ref_y);
+    }
+  }
+  CHECK(std::equal(x.begin(), x.end(), ref_x.begin(), ref_x.end()));
+  CHECK(std::equal(y.begin(), y.end(), ref_y.begin(), ref_y.end()));
+
+  map<int, std::string, std::less<int>, SmallBTree> ba;
+  map<int, std::string, std::less<int>, SmallBTree> bb;
+  for (int i = 0; i < 300; ++i)
+    ba.insert({i, std::to_string(i)});
+  bb.insert({3, "three"});
+  auto bh = ba.extract(10);
+  CHECK_EQ(bh.mapped(), "10");
+  CHECK(bb.insert(std::move(bh)).inserted);
+  bb.merge(ba);
+  CHECK_EQ(ba.size(), 1u);
+  CHECK_EQ(bb.size(), 300u);
+  CHECK_EQ(bb.find(3)->second, "three");
+}
+
+TEST_CASE("map/set: split and join") {
+  map<int, std::string> m;
+  for (int i = 0; i < 1000; ++i)
+    m.insert({i * 2, std::to_string(i)});
+  const std::string* addr = &m.find(1200)->second;
+
+  auto upper = m.split(1001);
+  CHECK_EQ(m.size(), 501u);
+  CHECK_EQ(upper.size(), 499u);
+  CHECK_EQ(std::prev(m.end())->first, 1000);
+  CHECK_EQ(upper.begin()->first, 1002);
+  CHECK_EQ(&upper.find(1200)->second, addr);
+
+  auto top = upper.split(1800);
+  CHECK_EQ(top.size(), 100u);
+  CHECK(upper.split(5000).empty());
+  CHECK_THROWS_AS(top.join(std::move(m)), std::invalid_argument);
+  CHECK_EQ(m.size(), 501u);
+
+  m.join(std::move(upper));
+  m.join(std::move(top));
+  CHECK(upper.empty());
+  CHECK_EQ(m.size(), 1000u);
+  bool in_order = true;
+  int expected = 0;
+  for (const auto& [k, v] : m) {
+    in_order = in_order && k == expected;
+    expected += 2;
+  }
+  CHECK(in_order);
+  m.insert({1, "one"});
+  m.erase(1200);
+  CHECK_EQ(m.size(), 1000u);
+
+  // Subtree sizes survive the relinking, so rank/select stay exact.
+  set<int, std::less<int>, OrderStatisticRbTree> s;
+  std::mt19937 rng(5);
+  for (int i = 0; i < 3000; ++i)
+    s.insert(static_cast<int>(rng() % 10000));
+  const std::size_t total = s.size();
+  auto high = s.split(5000);
+  const std::size_t low = s.size();
+  CHECK_EQ(low + high.size(), total);
+  CHECK_EQ(s.rank(5000), low);
+  CHECK(*high.select(0) >= 5000);
+  s.join(std::move(high));
+  CHECK_EQ(s.size(), total);
+  CHECK_EQ(s.rank(5000), low);
+  CHECK_EQ(*s.select(low), *s.lower_bound(5000));
+
+  multimap<int, int> mm;
+  for (int i = 0; i < 30; ++i)
+    mm.insert({i % 3, i});
+  auto rest = mm.split(1);
+  CHECK_EQ(mm.size(), 10u);
+  CHECK_EQ(rest.count(1), 10u);
+  mm.insert({1, 99});
+  mm.join(std::move(rest));
+  CHECK_EQ(mm.count(1), 11u);
+}
+
+TEST_CASE("map/set: persistent snapshots") {
+  map<int, std::string, std::less<int>, PersistentRbTree> m;
+  for (int i = 0; i < 500; ++i)
+    m.insert({i, std::to_string(i)});
+  auto before = m.snapshot();
+  const auto* shared = &*before.find(250);
+  CHECK_EQ(&*m.find(250), shared);
+
+  // The writer's updates copy the paths they touch; the snapshot keeps the old tree.
+  m[250] = "changed";
+  m.at(10) = "ten";
+  m.erase(100);
+  m.insert({1000, "new"});
+  for (int i = 0; i < 500; i += 3)
+    m.erase(i);
+  CHECK_EQ(before.size(), 500u);
+  CHECK_EQ(before.at(250), "250");
+  CHECK_EQ(before.at(10), "10");
+  CHECK(before.contains(100));
+  CHECK_FALSE(before.contains(1000));
+  CHECK_EQ(&*before.find(250), shared);
+  CHECK_EQ(m.at(250), "changed");
+  CHECK_EQ(m.at(10), "ten");
+  CHECK_FALSE(m.contains(100));
+  bool in_order = true;
+  int expected = 0;
+  for (const auto& [k, v] : before) {
+    in_order = in_order && k == expected && v == std::to_string(expected);
+    ++expected;
+  }
+  CHECK(in_order);
+
+  // Dropping the writer leaves the snapshot intact.
+  m.clear();
+  CHECK_EQ(before.at(499), "499");
+
+  set<int, std::less<int>, PersistentRbTree> s;
+  for (int i = 0; i < 100; ++i)
+    s.insert(i);
+  auto old = s.snapshot();
+  for (int i = 0; i < 50; ++i)
+    s.erase(i);
+  CHECK_EQ(s.size(), 50u);
+  CHECK_EQ(old.size(), 100u);
+  CHECK_EQ(*old.begin(), 0);
+  CHECK_EQ(*s.begin(), 50);
+}
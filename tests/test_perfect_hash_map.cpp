@@ -0,0 +1,89 @@
+#include "test.hpp"
+
+#include "perfect-hash-map/perfect_hash_map.hpp"
+#include "vector/vector.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+struct TransparentStringHash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+constexpr auto kColors = make_perfect_hash_map<std::string_view, int>(
+    {{"red", 1}, {"green", 2}, {"blue", 3}, {"cyan", 4}, {"magenta", 5}, {"yellow", 6}});
+static_assert(kColors.size() == 6);
+static_assert(kColors.at("blue") == 3);
+static_assert(kColors.contains("magenta"));
+static_assert(!kColors.contains("black"));
+
+} // namespace
+
+TEST_CASE("perfect_hash_map: build and lookup") {
+  for (std::size_t n : {0u, 1u, 2u, 5u, 1000u, 20000u}) {
+    Vector<std::pair<std::uint64_t, std::uint64_t>> items;
+    for (std::uint64_t i = 0; i < n; ++i)
+      items.push_back({i * 7919, i});
+    const perfect_hash_map<std::uint64_t, std::uint64_t> m(items);
+    REQUIRE_EQ(m.size(), n);
+
+    bool all_found = true;
+    for (std::uint64_t i = 0; i < n; ++i) {
+      const auto it = m.find(i * 7919);
+      all_found = all_found && it != m.end() && it->second == i;
+    }
+    CHECK(all_found);
+    CHECK(!m.contains(1));
+    CHECK_EQ(m.count(7919 * n), 0u);
+
+    std::size_t visited = 0;
+    for (const auto& kv : m) {
+      CHECK_EQ(kv.first, kv.second * 7919);
+      ++visited;
+    }
+    CHECK_EQ(visited, n);
+  }
+}
+
+TEST_CASE("perfect_hash_map: string keys, at, and heterogeneous lookup") {
+  Vector<std::pair<std::string, int>> items;
+  for (int i = 0; i < 500; ++i)
+    items.push_back({"k" + std::to_string(i), i});
+  perfect_hash_map<std::string, int, TransparentStringHash, std::equal_to<>> m(std::move(items));
+
+  CHECK_EQ(m.at("k42"), 42);
+  m.at("k42") = -1;
+  CHECK_EQ(m.find(std::string_view("k42"))->second, -1);
+  CHECK(m.contains(std::string_view("k499")));
+  CHECK(!m.contains(std::string_view("k500")));
+  CHECK_THROWS_AS(m.at("missing"), std::out_of_range);
+}
+
+TEST_CASE("perfect_hash_map: duplicate keys are rejected") {
+  Vector<std::pair<int, int>> items{{1, 1}, {2, 2}, {3, 3}, {2, 4}};
+  CHECK_THROWS_AS((perfect_hash_map<int, int>(items)), std::invalid_argument);
+}
+
+TEST_CASE("static_perfect_hash_map: runtime use") {
+  CHECK_EQ(kColors.at(std::string("green")), 2);
+  CHECK(kColors.find("black") == kColors.end());
+  int sum = 0;
+  for (const auto& [name, value] : kColors)
+    sum += value;
+  CHECK_EQ(sum, 21);
+
+  constexpr auto squares =
+      make_perfect_hash_map<int, int>({{1, 1}, {2, 4}, {3, 9}, {4, 16}, {5, 25}, {-6, 36}});
+  static_assert(squares.at(-6) == 36);
+  CHECK(!squares.contains(6));
+}
@@ -0,0 +1,87 @@
+#include "test.hpp"
+
+#include "flat-set/flat_set.hpp"
+#include "set-ops/set_ops.hpp"
+#include "set/set.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <typename Range> std::vector<std::uint64_t> to_std(const Range& r) {
+  return std::vector<std::uint64_t>(r.begin(), r.end());
+}
+
+Vector<std::uint64_t> random_sorted(std::mt19937_64& rng, std::size_t n, std::uint64_t range) {
+  std::vector<std::uint64_t> v(n);
+  for (auto& x : v)
+    x = rng() % range;
+  std::sort(v.begin(), v.end());
+  v.erase(std::unique(v.begin(), v.end()), v.end());
+  Vector<std::uint64_t> out;
+  for (auto x : v)
+    out.push_back(x);
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("set_ops: small inputs across set, FlatSet and Vector") {
+  set<std::uint64_t> s;
+  FlatSet<std::uint64_t> f;
+  Vector<std::uint64_t> v{2, 3, 5, 7};
+  for (std::uint64_t x : {1, 2, 3, 4})
+    s.insert(x);
+  for (std::uint64_t x : {3, 4, 5, 6})
+    f.insert(x);
+
+  CHECK(to_std(sorted_union(s, f)) == std::vector<std::uint64_t>{1, 2, 3, 4, 5, 6});
+  CHECK(to_std(sorted_intersection(s, f)) == std::vector<std::uint64_t>{3, 4});
+  CHECK(to_std(sorted_difference(s, f)) == std::vector<std::uint64_t>{1, 2});
+  CHECK(to_std(sorted_symmetric_difference(s, f)) == std::vector<std::uint64_t>{1, 2, 5, 6});
+  CHECK(to_std(sorted_intersection(f, v)) == std::vector<std::uint64_t>{3, 5});
+  CHECK(to_std(sorted_difference(v, s)) == std::vector<std::uint64_t>{5, 7});
+  CHECK(sorted_union(Vector<std::uint64_t>{}, Vector<std::uint64_t>{}).empty());
+
+  const auto merged = sorted_union(s, v);
+  auto back = set<std::uint64_t>::from_sorted(merged.begin(), merged.end());
+  CHECK_EQ(back.size(), 6u);
+  CHECK(back.contains(7));
+}
+
+TEST_CASE("set_ops: galloping and threaded paths match std") {
+  std::mt19937_64 rng(9);
+  // Similar sizes, skewed both ways, and sizes large enough for the threaded split.
+  const std::size_t sizes[][2] = {{3000, 2500}, {40, 200000}, {150000, 30}, {90000, 70000}};
+  bool all_match = true;
+  for (const auto& size : sizes) {
+    const auto a = random_sorted(rng, size[0], 400000);
+    const auto b = random_sorted(rng, size[1], 400000);
+    set<std::uint64_t> tree_b;
+    for (auto x : b)
+      tree_b.insert(x);
+
+    std::vector<std::uint64_t> un, in, diff, sym;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(un));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(in));
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(diff));
+    std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                                  std::back_inserter(sym));
+    for (std::size_t threads : {1u, 4u}) {
+      all_match = all_match && to_std(sorted_union(a, b, std::less<>(), threads)) == un;
+      all_match = all_match && to_std(sorted_intersection(a, b, std::less<>(), threads)) == in;
+      all_match = all_match && to_std(sorted_difference(a, b, std::less<>(), threads)) == diff;
+      all_match =
+          all_match && to_std(sorted_symmetric_difference(a, b, std::less<>(), threads)) == sym;
+    }
+    all_match = all_match && to_std(sorted_intersection(a, tree_b)) == in;
+    all_match = all_match && to_std(sorted_difference(a, tree_b)) == diff;
+    all_match = all_match && to_std(sorted_union(tree_b, a)) == un;
+  }
+  CHECK(all_match);
+}
@@ -1,8 +1,13 @@
 #include "test.hpp"
 
 #include "small-vector/small_vector.hpp"
+#include "string/string.hpp"
 
+#include <cstddef>
+#include <list>
+#include <ranges>
 #include <string>
+#include <vector>
 
 TEST_CASE("SmallVector: inline growth and accessors") {
   SmallVector<int, 4> xs;
@@ -61,7 +66,8 @@ struct MoveOnlyNoAssign {
   explicit MoveOnlyNoAssign(int v) : value(v) {}
   MoveOnlyNoAssign(const MoveOnlyNoAssign&) = delete;
   MoveOnlyNoAssign& operator=(const MoveOnlyNoAssign&) = delete;
-  MoveOnlyNoAssign(MoveOnlyNoAssign&&) noexcept = default;
+  // User-provided, so the type is not trivially relocatable and stays on the element-wise path.
+  MoveOnlyNoAssign(MoveOnlyNoAssign&& other) noexcept : value(other.value) {}
   MoveOnlyNoAssign& operator=(MoveOnlyNoAssign&&) = delete;
 };
 } // namespace
@@ -79,3 +85,62 @@ TEST_CASE("SmallVector: insert/erase without assignment") {
   CHECK_EQ(xs.size(), 2u);
   CHECK_EQ(xs[1].value, 3);
 }
+
+TEST_CASE("SmallVector: trivially relocatable elements") {
+  static_assert(is_trivially_relocatable_v<SmallVector<int, 0>>);
+  static_assert(!is_trivially_relocatable_v<SmallVector<int, 4>>);
+
+  SmallVector<string, 2> xs;
+  xs.push_back("short");
+  xs.insert(xs.begin(), string("a string too long for the inline buffer"));
+  SmallVector<string, 2> moved = std::move(xs);
+  CHECK(moved.using_inline_storage());
+  CHECK(xs.empty());
+
+  moved.insert(moved.begin() + 1, moved[1]);
+  moved.push_back("tail");
+  moved.erase(moved.begin());
+  REQUIRE_EQ(moved.size(), 3u);
+  CHECK_EQ(moved[0].view(), "short");
+  CHECK_EQ(moved[1].view(), "short");
+  CHECK_EQ(moved[2].view(), "tail");
+}
+
+TEST_CASE("SmallVector: resize variants") {
+  SmallVector<int, 4> xs{7};
+  xs.resize(3);
+  CHECK_EQ(xs[2], 0);
+  xs.resize_uninitialized(6);
+  CHECK(!xs.using_inline_storage());
+  xs[5] = 5;
+  xs.resize(2, default_init);
+  CHECK_EQ(xs.size(), 2u);
+  CHECK_EQ(xs[0], 7);
+
+  xs.resize_and_overwrite(10, [](int* p, std::size_t n) {
+    for (std::size_t i = 2; i < n; ++i)
+      p[i] = static_cast<int>(i);
+    return n;
+  });
+  CHECK_EQ(xs.size(), 10u);
+  CHECK_EQ(xs[9], 9);
+}
+
+TEST_CASE("SmallVector: range insertion") {
+  SmallVector<int, 4> xs{1, 5};
+  const std::vector<int> mid{2, 3, 4};
+  xs.insert_range(xs.begin() + 1, mid);
+  CHECK_EQ(xs.size(), 5u);
+  CHECK(!xs.using_inline_storage());
+  for (int i = 0; i < 5; ++i)
+    CHECK_EQ(xs[static_cast<std::size_t>(i)], i + 1);
+
+  SmallVector<std::string, 4> names{"a"};
+  const std::list<std::string> more{"b", "c"};
+  names.append_range(more);
+  CHECK(names.using_inline_storage());
+  CHECK_EQ(names[2], "c");
+  names.assign_range(mid | std::views::transform([](int v) { return std::to_string(v); }));
+  CHECK_EQ(names.size(), 3u);
+  CHECK_EQ(names[0], "2");
+}
@@ -3,7 +3,9 @@
 #include "stable-vector/stable_vector.hpp"
 
 #include <cstddef>
+#include <list>
 #include <string>
+#include <vector>
 
 TEST_CASE("StableVector: push_back/insert keeps element addresses stable") {
   StableVector<int> xs;
@@ -46,3 +48,20 @@ TEST_CASE("StableVector: copy is deep") {
   CHECK(&ys[0] != &xs[0]);
   CHECK(&ys[1] != &xs[1]);
 }
+
+TEST_CASE("StableVector: range insertion keeps addresses") {
+  StableVector<std::string> xs{"a", "d"};
+  const std::string* d = &xs[1];
+  const std::vector<std::string> mid{"b", "c"};
+  xs.insert_range(xs.begin() + 1, mid);
+  CHECK_EQ(xs.size(), 4u);
+  CHECK_EQ(xs[2], "c");
+  CHECK_EQ(&xs[3], d);
+
+  const std::list<std::string> tail{"e"};
+  xs.append_range(tail);
+  CHECK_EQ(xs.back(), "e");
+  xs.assign_range(mid);
+  CHECK_EQ(xs.size(), 2u);
+  CHECK_EQ(xs[0], "b");
+}
@@ -2,6 +2,10 @@
 
 #include "string/string.hpp"
 
+#include <list>
+#include <ranges>
+#include <string_view>
+
 TEST_CASE("string: construction, append, c_str") {
   string s("hi");
   CHECK_EQ(s.size(), 2u);
@@ -23,3 +27,48 @@ TEST_CASE("string: copy/move") {
   string c = std::move(a);
   CHECK_EQ(c.view(), "abc");
 }
+
+TEST_CASE("string: resize and resize_and_overwrite") {
+  string s("ab");
+  s.resize(4);
+  CHECK_EQ(s.size(), 4u);
+  CHECK_EQ(s[3], '\0');
+  s.resize(1);
+  CHECK_EQ(s.view(), "a");
+
+  s.resize_uninitialized(30);
+  for (std::size_t i = 1; i < s.size(); ++i)
+    s[i] = 'x';
+  CHECK_EQ(s.c_str()[30], '\0');
+
+  s.resize_and_overwrite(40, [](char* p, std::size_t n) {
+    p[0] = 'b';
+    p[n - 1] = 'z';
+    return n;
+  });
+  CHECK_EQ(s.size(), 40u);
+  CHECK_EQ(s.front(), 'b');
+  CHECK_EQ(s.back(), 'z');
+
+  s.resize_and_overwrite(3, [](char*, std::size_t) { return 2; });
+  CHECK_EQ(s.view(), "bx");
+  CHECK_EQ(s.c_str()[2], '\0');
+}
+
+TEST_CASE("string: range insertion") {
+  string s("ad");
+  const std::string_view bc = "bc";
+  auto it = s.insert_range(s.begin() + 1, bc);
+  CHECK_EQ(*it, 'b');
+  CHECK_EQ(s.view(), "abcd");
+
+  const std::list<char> tail{'e', 'f'};
+  s.append_range(tail);
+  CHECK_EQ(s.view(), "abcdef");
+  s.append_range(std::views::iota(0, 20) | std::views::transform([](int) { return 'g'; }));
+  CHECK_EQ(s.size(), 26u);
+  CHECK_EQ(std::string_view(s.c_str()).size(), 26u);
+
+  s.assign_range(std::string_view("xyz"));
+  CHECK_EQ(s.view(), "xyz");
+}
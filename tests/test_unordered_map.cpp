@@ -1,8 +1,14 @@
 #include "test.hpp"
 
 #include "unordered-map/unordered_map.hpp"
+#include "vector/vector.hpp"
 
+#include <cstddef>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 TEST_CASE("unordered_map: insert/at/operator[]") {
   unordered_map<std::string, int> m;
@@ -26,3 +32,328 @@ TEST_CASE("unordered_map: erase") {
   CHECK_EQ(m.size(), 99u);
   CHECK_THROWS(m.at(42));
 }
+
+TEST_CASE("unordered_map: iteration visits every element once") {
+  unordered_map<int, int> m;
+  for (int i = 0; i < 1000; ++i)
+    m.emplace(i, i);
+
+  long long sum = 0;
+  std::size_t seen = 0;
+  for (const auto& kv : m) {
+    sum += kv.second;
+    ++seen;
+  }
+  CHECK_EQ(seen, 1000u);
+  CHECK_EQ(sum, 999LL * 1000 / 2);
+  CHECK(m.load_factor() <= m.max_load_factor());
+}
+
+TEST_CASE("unordered_map: erase/reinsert churn keeps lookups correct") {
+  unordered_map<int, int> m(16);
+  for (int round = 0; round < 50; ++round) {
+    for (int i = 0; i < 64; ++i)
+      m[round * 64 + i] = i;
+    for (int i = 0; i < 64; ++i)
+      m.erase(round * 64 + i);
+    CHECK(m.empty());
+  }
+  for (int i = 0; i < 200; ++i)
+    m.emplace(i, -i);
+  for (int i = 0; i < 200; ++i)
+    CHECK_EQ(m.at(i), -i);
+  CHECK(m.find(500) == m.end());
+}
+
+TEST_CASE("unordered_map: copy, move, rehash") {
+  unordered_map<std::string, int> m;
+  for (int i = 0; i < 100; ++i)
+    m.emplace("key" + std::to_string(i), i);
+
+  unordered_map<std::string, int> copy(m);
+  m.rehash(1024);
+  CHECK(m.bucket_count() >= 1024u);
+
+  unordered_map<std::string, int> moved(std::move(m));
+  CHECK_EQ(copy.size(), 100u);
+  CHECK_EQ(moved.size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    CHECK_EQ(copy.at("key" + std::to_string(i)), i);
+    CHECK_EQ(moved.at("key" + std::to_string(i)), i);
+  }
+
+  m = copy;
+  m["extra"] = 1;
+  CHECK_EQ(m.size(), 101u);
+  CHECK_EQ(copy.size(), 100u);
+}
+
+namespace {
+
+template <typename Policy> void check_policy_round_trip() {
+  unordered_map<int, int, std::hash<int>, std::equal_to<int>, Policy> m(3);
+  for (int i = 0; i < 5000; ++i)
+    m.emplace(i * 64, i);
+  CHECK_EQ(m.size(), 5000u);
+  CHECK_EQ(Policy::round_bucket_count(m.bucket_count()), m.bucket_count());
+  for (int i = 0; i < 5000; ++i)
+    CHECK_EQ(m.at(i * 64), i);
+  CHECK(m.find(1) == m.end());
+}
+
+} // namespace
+
+TEST_CASE("unordered_map: bucket policies") {
+  check_policy_round_trip<power_of_two_bucket_policy>();
+  check_policy_round_trip<prime_bucket_policy>();
+  check_policy_round_trip<modulo_bucket_policy>();
+
+  CHECK_EQ(power_of_two_bucket_policy::round_bucket_count(100), 128u);
+  CHECK_EQ(prime_bucket_policy::round_bucket_count(100), 163u);
+
+  prime_bucket_policy p;
+  p.prepare(prime_bucket_policy::round_bucket_count(1000));
+  for (std::size_t h : {std::size_t{0}, std::size_t{1}, std::size_t{1672}, std::size_t{0xFFFFFFFF},
+                        std::size_t{123456789}}) {
+    CHECK_EQ(p.index(h), h % 1361);
+  }
+}
+
+namespace {
+
+struct CountingStringHash {
+  static inline int calls = 0;
+  std::size_t operator()(const std::string& s) const {
+    ++calls;
+    return std::hash<std::string>{}(s);
+  }
+};
+
+struct CountingIntHash {
+  static inline int calls = 0;
+  std::size_t operator()(int v) const {
+    ++calls;
+    return static_cast<std::size_t>(v);
+  }
+};
+
+} // namespace
+
+TEST_CASE("unordered_map: cached hashes skip rehash hashing") {
+  unordered_map<std::string, int, CountingStringHash> m;
+  CountingStringHash::calls = 0;
+  for (int i = 0; i < 500; ++i)
+    m.emplace("key" + std::to_string(i), i);
+  CHECK_EQ(CountingStringHash::calls, 500);
+
+  m.rehash(m.bucket_count() * 4);
+  unordered_map<std::string, int, CountingStringHash> copy(m);
+  CHECK_EQ(CountingStringHash::calls, 500);
+  CHECK_EQ(copy.at("key42"), 42);
+
+  unordered_map<int, int, CountingIntHash> ints;
+  for (int i = 0; i < 10; ++i)
+    ints.emplace(i, i);
+  CountingIntHash::calls = 0;
+  ints.rehash(1024);
+  CHECK_EQ(CountingIntHash::calls, 10);
+}
+
+struct TransparentStringHash {
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+TEST_CASE("unordered_map: transparent lookup with string_view") {
+  unordered_map<std::string, int, TransparentStringHash, std::equal_to<>> m;
+  m.insert({"a-key-longer-than-the-small-string-buffer", 1});
+  m.insert({"b", 2});
+
+  const std::string_view key = "a-key-longer-than-the-small-string-buffer";
+  auto it = m.find(key);
+  REQUIRE(it != m.end());
+  CHECK_EQ(it->second, 1);
+  CHECK(m.contains(std::string_view("b")));
+  CHECK_EQ(m.count(std::string_view("c")), 0u);
+
+  m.erase(key);
+  CHECK(!m.contains(key));
+  CHECK_EQ(m.size(), 1u);
+}
+
+TEST_CASE("unordered_map: incremental rehash") {
+  unordered_map<std::string, int> m;
+  m.incremental_rehash(true);
+  CHECK(m.incremental_rehash());
+
+  // Insert (erasing every seventh key along the way) until a migration is pending with enough
+  // elements that both tables hold some of them.
+  std::vector<bool> present;
+  int next = 0;
+  while (next < 1000 || !m.rehash_in_progress()) {
+    m.emplace("key" + std::to_string(next), next);
+    present.push_back(true);
+    if (next % 7 == 0) {
+      m.erase("key" + std::to_string(next / 2));
+      present[static_cast<std::size_t>(next / 2)] = false;
+    }
+    ++next;
+    REQUIRE(next < 100000);
+  }
+
+  const auto& view = m;
+  std::size_t expected = 0;
+  for (int i = 0; i < next; ++i) {
+    const bool live = present[static_cast<std::size_t>(i)];
+    CHECK_EQ(view.contains("key" + std::to_string(i)), live);
+    expected += live ? 1 : 0;
+  }
+  CHECK_EQ(m.size(), expected);
+
+  std::size_t visited = 0;
+  for (const auto& kv : view) {
+    CHECK_EQ(kv.first, "key" + std::to_string(kv.second));
+    ++visited;
+  }
+  CHECK_EQ(visited, expected);
+
+  unordered_map<std::string, int> copy(m);
+  CHECK_EQ(copy.size(), expected);
+
+  m.incremental_rehash(false);
+  CHECK(!m.rehash_in_progress());
+  CHECK_EQ(m.size(), expected);
+  for (int i = 0; i < next; ++i)
+    CHECK_EQ(m.contains("key" + std::to_string(i)), present[static_cast<std::size_t>(i)]);
+}
+
+TEST_CASE("unordered_map: insert_range and find_batch") {
+  std::vector<std::pair<std::string, int>> input;
+  for (int i = 0; i < 500; ++i)
+    input.emplace_back("key" + std::to_string(i), i);
+  input.emplace_back("key7", 700); // A later duplicate overwrites, as with insert.
+
+  unordered_map<std::string, int> m;
+  m.emplace("key0", -1);
+  m.insert_range(input.begin(), input.end());
+  CHECK_EQ(m.size(), 500u);
+  CHECK_EQ(m.at("key0"), 0);
+  CHECK_EQ(m.at("key7"), 700);
+  CHECK_EQ(m.at("key499"), 499);
+
+  Vector<std::string> keys;
+  for (int i = 0; i < 40; ++i)
+    keys.push_back("key" + std::to_string(i * 20)); // Last 15 are misses.
+  Vector<unordered_map<std::string, int>::const_iterator> out;
+  out.resize(keys.size());
+  std::as_const(m).find_batch(keys, out);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (i * 20 < 500) {
+      REQUIRE(out[i] != m.cend());
+      CHECK_EQ(out[i]->first, keys[i]);
+    } else {
+      CHECK(out[i] == m.cend());
+    }
+  }
+
+  Vector<unordered_map<std::string, int>::iterator> hits;
+  hits.resize(2);
+  CHECK_THROWS_AS(m.find_batch(keys, hits), std::length_error);
+  m.find_batch(Span<const std::string>(keys.data(), 2), hits);
+  hits[1]->second = 42;
+  CHECK_EQ(m.at("key20"), 42);
+}
+
+namespace {
+struct ConstantHash {
+  std::size_t operator()(int) const noexcept {
+    return 0;
+  }
+};
+} // namespace
+
+TEST_CASE("unordered_map: stats") {
+  unordered_map<int, int> m;
+  hash_table_stats s = m.stats();
+  CHECK_EQ(s.size, 0u);
+  CHECK_EQ(s.empty_bucket_ratio, 1.0);
+  CHECK_EQ(s.max_chain_length, 0u);
+  CHECK_EQ(s.rehash_count, 0u);
+
+  for (int i = 0; i < 1000; ++i)
+    m.emplace(i, i);
+  s = m.stats();
+  CHECK_EQ(s.size, 1000u);
+  CHECK_EQ(s.bucket_count, m.bucket_count());
+  CHECK_EQ(s.node_count, 0u);
+  CHECK(s.bytes_allocated >= s.bucket_count * sizeof(std::pair<int, int>));
+  CHECK(s.rehash_count >= 5);
+  std::size_t counted = 0;
+  for (std::size_t n : s.chain_length_histogram)
+    counted += n;
+  CHECK_EQ(counted, 1000u);
+  CHECK(s.p99_chain_length >= 1);
+  CHECK(s.max_chain_length >= s.p99_chain_length);
+
+  unordered_map<int, int> reserved;
+  reserved.reserve(1000);
+  for (int i = 0; i < 1000; ++i)
+    reserved.emplace(i, i);
+  CHECK_EQ(reserved.stats().rehash_count, 1u);
+
+  // Every key shares one probe start, so the tail grows with the table.
+  unordered_map<int, int, ConstantHash> clustered;
+  for (int i = 0; i < 200; ++i)
+    clustered.emplace(i, i);
+  const hash_table_stats bad = clustered.stats();
+  CHECK(bad.max_chain_length >= 200 / 16);
+  CHECK(bad.max_chain_length > s.max_chain_length);
+
+  CHECK(clustered.contains(199));
+  const hash_table_stats probed = clustered.stats();
+  if constexpr (hash_probe_counter::kEnabled) {
+    CHECK(probed.lookups > 0);
+    CHECK(probed.probes_per_lookup() >= 1.0);
+  } else {
+    CHECK_EQ(probed.lookups, 0u);
+    CHECK_EQ(probed.probes, 0u);
+  }
+}
+
+TEST_CASE("unordered_map: node handles") {
+  unordered_map<int, std::string> a;
+  for (int i = 0; i < 500; ++i)
+    a.insert({i, std::to_string(i)});
+
+  auto nh = a.extract(42);
+  REQUIRE_FALSE(nh.empty());
+  CHECK_EQ(nh.key(), 42);
+  CHECK_EQ(nh.mapped(), "42");
+  CHECK_EQ(a.size(), 499u);
+  CHECK(a.extract(42).empty());
+
+  unordered_map<int, std::string> b;
+  b.insert({7, "seven"});
+  auto inserted = b.insert(std::move(nh));
+  CHECK(inserted.inserted);
+  CHECK_EQ(inserted.position->second, "42");
+
+  // Unlike insert(pair_type), a clash leaves the existing element alone.
+  auto clash = b.insert(a.extract(a.find(7)));
+  CHECK_FALSE(clash.inserted);
+  CHECK_EQ(clash.node.mapped(), "7");
+  CHECK_EQ(b.at(7), "seven");
+
+  a.insert({7, "7"});
+  b.merge(a);
+  CHECK_EQ(a.size(), 1u);
+  CHECK_EQ(a.at(7), "7");
+  CHECK_EQ(b.size(), 500u);
+  bool all_found = true;
+  for (int i = 0; i < 500; ++i)
+    all_found = all_found && b.contains(i);
+  CHECK(all_found);
+}
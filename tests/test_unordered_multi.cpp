@@ -2,6 +2,10 @@
 
 #include "unordered-multimap/unordered_multimap.hpp"
 #include "unordered-multiset/unordered_multiset.hpp"
+#include "vector/vector.hpp"
+
+#include <string>
+#include <utility>
 
 TEST_CASE("unordered_multimap: duplicates and equal_range") {
   unordered_multimap<int, int> m;
@@ -29,3 +33,154 @@ TEST_CASE("unordered_multiset: duplicates") {
   CHECK_EQ(s.erase(1), 2u);
   CHECK_EQ(s.count(1), 0u);
 }
+
+TEST_CASE("unordered_multimap: prime bucket policy") {
+  unordered_multimap<int, int, std::hash<int>, std::equal_to<int>, prime_bucket_policy> m(10);
+  for (int i = 0; i < 300; ++i) {
+    m.insert({i % 50, i});
+  }
+  CHECK_EQ(m.bucket_count(), prime_bucket_policy::round_bucket_count(m.bucket_count()));
+  CHECK_EQ(m.count(7), 6u);
+  CHECK_EQ(m.erase(7), 6u);
+  CHECK_EQ(m.size(), 294u);
+}
+
+namespace {
+
+struct CountingHash {
+  static inline int calls = 0;
+  std::size_t operator()(const std::string& s) const {
+    ++calls;
+    return std::hash<std::string>{}(s);
+  }
+};
+
+} // namespace
+
+TEST_CASE("unordered_multimap: cached hashes survive rehash") {
+  unordered_multimap<std::string, int, CountingHash> m;
+  for (int i = 0; i < 200; ++i)
+    m.insert({"k" + std::to_string(i % 20), i});
+  CountingHash::calls = 0;
+  m.rehash(1024);
+  CHECK_EQ(CountingHash::calls, 0);
+  CHECK_EQ(m.count("k3"), 10u);
+  CHECK_EQ(CountingHash::calls, 1);
+}
+
+TEST_CASE("unordered_multimap/multiset: insert_range and find_batch") {
+  Vector<std::pair<int, int>> input;
+  for (int i = 0; i < 300; ++i)
+    input.push_back({i % 100, i});
+
+  unordered_multimap<int, int> m;
+  m.insert_range(input.begin(), input.end());
+  CHECK_EQ(m.size(), 300u);
+  CHECK_EQ(m.count(5), 3u);
+  CHECK(m.find(1000) == m.end());
+  CHECK(!m.contains(1000));
+
+  Vector<int> keys;
+  for (int i = 0; i < 50; ++i)
+    keys.push_back(i * 4);
+  Vector<unordered_multimap<int, int>::iterator> out;
+  out.resize(keys.size());
+  m.find_batch(keys, out);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (keys[i] < 100) {
+      REQUIRE(out[i] != m.end());
+      CHECK_EQ(out[i]->first, keys[i]);
+    } else {
+      CHECK(out[i] == m.end());
+    }
+  }
+
+  unordered_multiset<int> s;
+  s.insert_range(keys.begin(), keys.end());
+  s.insert_range(keys.begin(), keys.end());
+  CHECK_EQ(s.count(8), 2u);
+  Vector<unordered_multiset<int>::const_iterator> found;
+  found.resize(keys.size());
+  s.find_batch(keys, found);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    CHECK(found[i] != s.cend());
+}
+
+TEST_CASE("unordered_multimap: stats") {
+  unordered_multimap<int, int> m;
+  for (int i = 0; i < 1000; ++i)
+    m.insert({i % 250, i});
+  const hash_table_stats s = m.stats();
+  CHECK_EQ(s.size, 1000u);
+  CHECK_EQ(s.node_count, 1000u);
+  CHECK_EQ(s.bucket_count, m.bucket_count());
+  CHECK(s.rehash_count >= 1);
+  CHECK(s.bytes_allocated > 1000 * sizeof(std::pair<const int, int>));
+
+  // Buckets are weighted by chain length: the histogram accounts for every element.
+  std::size_t buckets = 0;
+  std::size_t elements = 0;
+  for (std::size_t k = 0; k < s.chain_length_histogram.size(); ++k) {
+    buckets += s.chain_length_histogram[k];
+    elements += k * s.chain_length_histogram[k];
+  }
+  CHECK_EQ(buckets, s.bucket_count);
+  CHECK_EQ(elements, 1000u);
+  CHECK(s.max_chain_length >= 4); // Each key appears four times in one chain.
+  CHECK(s.empty_bucket_ratio > 0.0);
+  CHECK(s.empty_bucket_ratio < 1.0);
+
+  unordered_multiset<int> ms;
+  ms.insert(1);
+  ms.insert(1);
+  CHECK_EQ(ms.stats().max_chain_length, 2u);
+}
+
+TEST_CASE("unordered_multimap/multiset: node handles relink chain nodes") {
+  unordered_multimap<int, std::string> a;
+  for (int i = 0; i < 600; ++i)
+    a.insert({i % 60, std::to_string(i)});
+  const std::string* addr = &a.find(3)->second;
+
+  auto nh = a.extract(3);
+  CHECK_EQ(nh.key(), 3);
+  CHECK_EQ(&nh.mapped(), addr);
+  CHECK_EQ(a.count(3), 9u);
+
+  unordered_multimap<int, std::string> b;
+  auto it = b.insert(std::move(nh));
+  CHECK_EQ(&it->second, addr);
+
+  // merge moves every node, growing b's buckets first; nodes keep their addresses throughout.
+  addr = &a.find(17)->second;
+  b.merge(a);
+  CHECK(a.empty());
+  CHECK_EQ(b.size(), 600u);
+  CHECK_EQ(b.count(3), 10u);
+  bool found_addr = false;
+  for (auto [first, last] = b.equal_range(17); first != last; ++first)
+    found_addr = found_addr || &first->second == addr;
+  CHECK(found_addr);
+
+  auto by_pos = b.extract(b.find(20));
+  CHECK_EQ(by_pos.key(), 20);
+  CHECK_EQ(b.size(), 599u);
+  std::size_t visited = 0;
+  for (const auto& kv : b) {
+    static_cast<void>(kv);
+    ++visited;
+  }
+  CHECK_EQ(visited, 599u);
+
+  unordered_multiset<int> s;
+  unordered_multiset<int> t;
+  s.insert(1);
+  s.insert(1);
+  t.insert(1);
+  t.merge(s);
+  CHECK_EQ(t.count(1), 3u);
+  auto sh = t.extract(1);
+  CHECK_EQ(sh.value(), 1);
+  s.insert(std::move(sh));
+  CHECK_EQ(s.count(1), 1u);
+}
@@ -1,6 +1,7 @@
 #include "test.hpp"
 
 #include "unordered-set/unordered_set.hpp"
+#include "vector/vector.hpp"
 
 TEST_CASE("unordered_set: insert/contains/erase") {
   unordered_set<int> s;
@@ -21,3 +22,49 @@ TEST_CASE("unordered_set: insert/contains/erase") {
   CHECK(!s.contains(1));
   CHECK(!s.erase(1));
 }
+
+TEST_CASE("unordered_set: insert_range and find_batch") {
+  Vector<int> input;
+  for (int i = 0; i < 100; ++i)
+    input.push_back(i % 60);
+
+  unordered_set<int> s;
+  s.insert_range(input.begin(), input.end());
+  CHECK_EQ(s.size(), 60u);
+
+  Vector<int> keys;
+  for (int i = 0; i < 30; ++i)
+    keys.push_back(i * 3);
+  Vector<unordered_set<int>::const_iterator> out;
+  out.resize(keys.size());
+  s.find_batch(keys, out);
+  for (std::size_t i = 0; i < keys.size(); ++i)
+    CHECK_EQ(out[i] != s.cend(), keys[i] < 60);
+}
+
+TEST_CASE("unordered_set: stats") {
+  unordered_set<int> s;
+  for (int i = 0; i < 100; ++i)
+    s.insert(i);
+  const hash_table_stats stats = s.stats();
+  CHECK_EQ(stats.size, 100u);
+  CHECK(stats.bucket_count >= 100);
+  CHECK(stats.max_chain_length >= 1);
+}
+
+TEST_CASE("unordered_set: node handles") {
+  unordered_set<int> a;
+  unordered_set<int> b;
+  for (int i = 0; i < 100; ++i)
+    a.insert(i);
+  b.insert(5);
+
+  auto nh = a.extract(50);
+  CHECK_EQ(nh.value(), 50);
+  CHECK(b.insert(std::move(nh)).inserted);
+  CHECK_FALSE(b.insert(a.extract(a.find(5))).inserted);
+
+  b.merge(a);
+  CHECK(a.empty());
+  CHECK_EQ(b.size(), 100u);
+}
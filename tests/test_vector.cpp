@@ -1,8 +1,21 @@
 #include "test.hpp"
 
+#include "string/string.hpp"
+#include "unique-ptr/unique_ptr.hpp"
+#include "vector/expandable_allocator.hpp"
+#include "vector/huge_page_allocator.hpp"
 #include "vector/vector.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 TEST_CASE("Vector: push_back/size/index") {
   Vector<int> xs;
@@ -80,7 +93,8 @@ struct MoveOnlyNoAssign {
   explicit MoveOnlyNoAssign(int v) : value(v) {}
   MoveOnlyNoAssign(const MoveOnlyNoAssign&) = delete;
   MoveOnlyNoAssign& operator=(const MoveOnlyNoAssign&) = delete;
-  MoveOnlyNoAssign(MoveOnlyNoAssign&&) noexcept = default;
+  // User-provided, so the type is not trivially relocatable and stays on the element-wise path.
+  MoveOnlyNoAssign(MoveOnlyNoAssign&& other) noexcept : value(other.value) {}
   MoveOnlyNoAssign& operator=(MoveOnlyNoAssign&&) = delete;
 };
 } // namespace
@@ -108,3 +122,258 @@ TEST_CASE("Vector: insert/erase without assignment") {
 TEST_CASE("Vector: at throws") {
   CHECK_THROWS((Vector<int>{1, 2, 3}.at(99)));
 }
+
+namespace {
+// Every third label is too long for the short-string buffer.
+std::string label(int i) {
+  return i % 3 == 0 ? std::string(40, static_cast<char>('a' + i % 26)) : std::to_string(i);
+}
+} // namespace
+
+TEST_CASE("Vector: trivially relocatable elements") {
+  static_assert(is_trivially_relocatable_v<string>);
+  static_assert(is_trivially_relocatable_v<unique_ptr<int>>);
+  static_assert(is_trivially_relocatable_v<std::pair<const int, string>>);
+  static_assert(is_trivially_relocatable_v<Vector<std::string>>);
+  static_assert(!is_trivially_relocatable_v<std::string>);
+
+  Vector<string> xs;
+  std::vector<std::string> model;
+  for (int i = 0; i < 40; ++i) {
+    xs.push_back(string(label(i)));
+    model.push_back(label(i));
+  }
+  for (int i = 40; i < 60; ++i) {
+    xs.insert(xs.begin() + i / 2, string(label(i)));
+    model.insert(model.begin() + i / 2, label(i));
+  }
+  // The inserted value is an element the insert shifts.
+  xs.insert(xs.begin(), xs[5]);
+  model.insert(model.begin(), std::string(model[5]));
+  xs.erase(xs.begin() + 10, xs.begin() + 25);
+  model.erase(model.begin() + 10, model.begin() + 25);
+
+  REQUIRE_EQ(xs.size(), model.size());
+  for (std::size_t i = 0; i < model.size(); ++i)
+    CHECK_EQ(xs[i].view(), model[i]);
+
+  Vector<unique_ptr<int>> owners;
+  for (int i = 0; i < 10; ++i)
+    owners.insert(owners.begin(), unique_ptr<int>(new int(i)));
+  owners.erase(owners.begin() + 2, owners.begin() + 5);
+  CHECK_EQ(owners.size(), 7u);
+  CHECK_EQ(*owners[0], 9);
+  CHECK_EQ(*owners[2], 4);
+  CHECK_EQ(*owners.back(), 0);
+}
+
+namespace {
+// Stateful allocator that counts its live blocks; copies share the count, and allocators with
+// different counts compare unequal.
+template <typename T> struct counting_allocator {
+  using value_type = T;
+
+  int* live;
+
+  explicit counting_allocator(int* counter) : live(counter) {}
+  template <typename U> counting_allocator(const counting_allocator<U>& other) : live(other.live) {}
+
+  T* allocate(std::size_t n) {
+    ++*live;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) noexcept {
+    --*live;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.live == b.live;
+  }
+};
+} // namespace
+
+TEST_CASE("Vector: allocator parameter") {
+  int live_a = 0;
+  int live_b = 0;
+  {
+    using counted = Vector<std::string, counting_allocator<std::string>>;
+    counted xs{counting_allocator<std::string>(&live_a)};
+    for (int i = 0; i < 20; ++i)
+      xs.push_back(label(i));
+    CHECK_EQ(live_a, 1);
+
+    counted copy = xs;
+    CHECK(copy.get_allocator() == xs.get_allocator());
+    CHECK_EQ(live_a, 2);
+
+    // Unequal allocators that do not propagate: elements move, buffers stay with their owners.
+    counted ys{counting_allocator<std::string>(&live_b)};
+    ys = std::move(copy);
+    CHECK_EQ(ys.size(), 20u);
+    CHECK_EQ(ys[19], label(19));
+    CHECK_EQ(live_b, 1);
+
+    ys = xs;
+    CHECK(ys.get_allocator() == counting_allocator<std::string>(&live_b));
+    CHECK_EQ(ys[3], label(3));
+    CHECK_EQ(live_b, 1);
+  }
+  CHECK_EQ(live_a, 0);
+  CHECK_EQ(live_b, 0);
+}
+
+TEST_CASE("Vector: expandable_allocator grows in place") {
+  static_assert(reallocating_allocator<expandable_allocator<int>, int>);
+
+  // Crosses from malloc'd blocks to mapped ones and keeps growing them.
+  Vector<int, expandable_allocator<int>> xs;
+  const int n = 3 * static_cast<int>(expandable_allocator<int>::kMapBytes / sizeof(int));
+  for (int i = 0; i < n; ++i)
+    xs.push_back(i);
+  REQUIRE_EQ(xs.size(), static_cast<std::size_t>(n));
+  bool intact = true;
+  for (int i = 0; i < n; ++i)
+    intact = intact && xs[static_cast<std::size_t>(i)] == i;
+  CHECK(intact);
+
+  xs.insert(xs.begin() + 1, -1);
+  xs.erase(xs.begin() + 2, xs.begin() + 10);
+  CHECK_EQ(xs[1], -1);
+  CHECK_EQ(xs[2], 9);
+  CHECK_EQ(xs.back(), n - 1);
+
+  Vector<string, expandable_allocator<string>> names;
+  for (int i = 0; i < 100; ++i)
+    names.insert(names.begin(), string(label(i)));
+  CHECK_EQ(names.front().view(), label(99));
+  CHECK_EQ(names.back().view(), label(0));
+  auto moved = std::move(names);
+  CHECK_EQ(moved.size(), 100u);
+
+  // Shrinking to zero, from a malloc'd block and from a mapped one, leaves a block that
+  // deallocate(q, 0) accepts.
+  expandable_allocator<int> alloc;
+  for (std::size_t old_n : {std::size_t{16}, expandable_allocator<int>::kMapBytes}) {
+    int* p = alloc.allocate(old_n);
+    p[0] = 1;
+    int* q = alloc.reallocate(p, old_n, 0);
+    CHECK(q != nullptr);
+    alloc.deallocate(q, 0);
+  }
+}
+
+TEST_CASE("Vector: default-init resize and resize_and_overwrite") {
+  Vector<int> xs{1, 2};
+  xs.resize(5, default_init);
+  CHECK_EQ(xs.size(), 5u);
+  CHECK_EQ(xs[1], 2);
+  xs.resize_uninitialized(8);
+  for (std::size_t i = 2; i < 8; ++i)
+    xs[i] = static_cast<int>(i);
+  CHECK_EQ(xs[7], 7);
+  xs.resize(3, default_init);
+  CHECK_EQ(xs.size(), 3u);
+
+  xs.resize_and_overwrite(6, [](int* p, std::size_t n) {
+    for (std::size_t i = 3; i < n; ++i)
+      p[i] = 10 * static_cast<int>(i);
+    return n - 1;
+  });
+  CHECK_EQ(xs.size(), 5u);
+  CHECK_EQ(xs[0], 1);
+  CHECK_EQ(xs[4], 40);
+  CHECK_THROWS_AS(xs.resize_and_overwrite(2, [](int*, std::size_t n) { return n + 1; }),
+                  std::length_error);
+  CHECK_EQ(xs.size(), 5u);
+
+  // Class types are still constructed.
+  Vector<std::string> names;
+  names.resize(2, default_init);
+  CHECK(names[1].empty());
+}
+
+TEST_CASE("Vector: append_range, insert_range and assign_range") {
+  Vector<int> xs{1, 2, 3};
+  const std::vector<int> more{4, 5, 6, 7};
+  xs.append_range(more);
+  CHECK_EQ(xs.size(), 7u);
+  CHECK_EQ(xs[6], 7);
+
+  // Grows once, straight to the size needed.
+  const std::list<int> mid{10, 11, 12, 13, 14, 15, 16};
+  auto it = xs.insert_range(xs.begin() + 1, mid);
+  CHECK_EQ(it - xs.begin(), 1);
+  CHECK_EQ(xs.size(), 14u);
+  CHECK_EQ(xs.capacity(), 14u);
+  CHECK_EQ(xs[0], 1);
+  CHECK_EQ(xs[7], 16);
+  CHECK_EQ(xs[8], 2);
+  CHECK_EQ(xs[13], 7);
+
+  // Input-only ranges are staged, then inserted with one shift.
+  std::istringstream in("20 21 22");
+  xs.insert_range(xs.begin(), std::views::istream<int>(in));
+  CHECK_EQ(xs.size(), 17u);
+  CHECK_EQ(xs[2], 22);
+  CHECK_EQ(xs[3], 1);
+
+  xs.append_range(xs);
+  CHECK_EQ(xs.size(), 34u);
+  CHECK_EQ(xs[17], 20);
+  CHECK_EQ(xs[33], 7);
+
+  xs.assign_range(std::views::iota(0, 5));
+  CHECK_EQ(xs.size(), 5u);
+  CHECK_EQ(xs[4], 4);
+  CHECK_THROWS(xs.insert_range(xs.end() + 1, more));
+
+  Vector<std::string> names{"a", "d"};
+  names.reserve(8);
+  const std::vector<std::string> bc{"b", "c"};
+  names.insert_range(names.begin() + 1, bc);
+  CHECK_EQ(names[1], "b");
+  CHECK_EQ(names[3], "d");
+
+  Vector<MoveOnlyNoAssign> items;
+  items.emplace_back(1);
+  items.emplace_back(4);
+  items.reserve(8);
+  auto make_items = [](int v) { return MoveOnlyNoAssign(v); };
+  items.insert_range(items.begin() + 1, std::views::iota(2, 4) | std::views::transform(make_items));
+  CHECK_EQ(items.size(), 4u);
+  CHECK_EQ(items[1].value, 2);
+  CHECK_EQ(items[3].value, 4);
+}
+
+TEST_CASE("Vector: huge_page_allocator and first_touch_parallel") {
+  using alloc = huge_page_allocator<std::uint64_t>;
+  const std::size_t n = 3 * alloc::kHugePageBytes / sizeof(std::uint64_t) + 5;
+  Vector<std::uint64_t, alloc> xs;
+  xs.resize_uninitialized(n);
+  if (STL_HUGE_PAGES)
+    CHECK_EQ(reinterpret_cast<std::uintptr_t>(xs.data()) % alloc::kHugePageBytes, 0u);
+  first_touch_parallel(xs.data(), n, 3, [](std::size_t i) { return std::uint64_t{i} * 3; });
+  bool all_set = true;
+  for (std::size_t i = 0; i < n; ++i)
+    all_set = all_set && xs[i] == i * 3;
+  CHECK(all_set);
+
+  // Runs start on page boundaries (or are empty) and cover the array without gaps.
+  const std::size_t per_page = alloc::kHugePageBytes / sizeof(std::uint64_t);
+  std::size_t next = 0;
+  for (std::size_t t = 0; t < 3; ++t) {
+    const auto [first, last] = first_touch_range<std::uint64_t>(n, 3, t);
+    CHECK_EQ(first, next);
+    CHECK((first % per_page == 0 || first == n));
+    next = last;
+  }
+  CHECK_EQ(next, n);
+
+  // Small vectors start on operator new and move to a mapping as they grow.
+  Vector<int, huge_page_allocator<int>> ys{1, 2, 3};
+  for (int i = 4; i <= 1'000'000; ++i)
+    ys.push_back(i);
+  CHECK_EQ(ys[0], 1);
+  CHECK_EQ(ys.back(), 1'000'000);
+}
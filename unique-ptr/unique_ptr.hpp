@@ -4,6 +4,8 @@
 #include <type_traits>
 #include <utility>
 
+#include "utility/relocate.hpp"
+
 template <typename T> class unique_ptr {
 public:
   using pointer = T*;
@@ -68,3 +70,6 @@ public:
 private:
   pointer ptr_;
 };
+
+// A single pointer with a stateless deleter.
+template <typename T> struct is_trivially_relocatable<unique_ptr<T>> : std::true_type {};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Bucket-index policies shared by the unordered containers.
+//
+// A policy turns a raw `Hash{}(key)` value into a bucket index in two steps:
+//   - `mix(hash)` finalizes the hash (identity for policies that already spread bits well);
+//   - `index(mixed)` reduces a mixed hash into [0, bucket_count).
+// `round_bucket_count(n)` picks the smallest legal bucket count >= n, and `prepare(count)` caches
+// whatever per-size state `index` needs. Tables call `prepare` every time they resize.
+
+// Plain `hash % bucket_count`. Works with any hash and any bucket count but pays an integer
+// division on every lookup.
+class modulo_bucket_policy {
+public:
+  static std::size_t round_bucket_count(std::size_t n) noexcept {
+    return n == 0 ? 1 : n;
+  }
+
+  void prepare(std::size_t bucket_count) noexcept {
+    bucket_count_ = bucket_count;
+  }
+
+  constexpr std::size_t mix(std::size_t hash) const noexcept {
+    return hash;
+  }
+
+  std::size_t index(std::size_t mixed) const noexcept {
+    return mixed % bucket_count_;
+  }
+
+private:
+  std::size_t bucket_count_ = 1;
+};
+
+// Power-of-two bucket counts indexed with a mask. Masking keeps only the low bits, which is
+// unsafe for weak hashes such as the identity `std::hash<int>`, so `mix` runs an xor-shift /
+// Fibonacci-multiply finalizer that folds every input bit into the low bits first.
+class power_of_two_bucket_policy {
+public:
+  static std::size_t round_bucket_count(std::size_t n) noexcept {
+    return std::bit_ceil(std::max<std::size_t>(n, 1));
+  }
+
+  void prepare(std::size_t bucket_count) noexcept {
+    mask_ = bucket_count - 1;
+  }
+
+  constexpr std::size_t mix(std::size_t hash) const noexcept {
+    if constexpr (sizeof(std::size_t) == 8) {
+      std::uint64_t h = hash;
+      h ^= h >> 32;
+      h *= 0x9E3779B97F4A7C15ULL;
+      h ^= h >> 32;
+      return static_cast<std::size_t>(h);
+    } else {
+      std::uint32_t h = static_cast<std::uint32_t>(hash);
+      h ^= h >> 16;
+      h *= 0x9E3779B9U;
+      h ^= h >> 16;
+      return h;
+    }
+  }
+
+  std::size_t index(std::size_t mixed) const noexcept {
+    return mixed & mask_;
+  }
+
+private:
+  std::size_t mask_ = 0;
+};
+
+// Prime bucket counts (roughly doubling) indexed with Lemire's fastmod: a 64-bit reciprocal
+// computed once per resize replaces the division with two multiplications. Prime moduli spread
+// even poorly distributed hashes, so no finalizer is applied.
+class prime_bucket_policy {
+public:
+  static std::size_t round_bucket_count(std::size_t n) {
+    const auto* it = std::lower_bound(std::begin(kPrimes), std::end(kPrimes), n);
+    if (it == std::end(kPrimes))
+      throw std::length_error("prime_bucket_policy: bucket count too large");
+    return static_cast<std::size_t>(*it);
+  }
+
+  void prepare(std::size_t bucket_count) noexcept {
+    divisor_ = static_cast<std::uint32_t>(bucket_count);
+    magic_ = ~std::uint64_t{0} / divisor_ + 1;
+  }
+
+  constexpr std::size_t mix(std::size_t hash) const noexcept {
+    return hash;
+  }
+
+  std::size_t index(std::size_t mixed) const noexcept {
+    auto folded = static_cast<std::uint64_t>(mixed);
+    folded = (folded ^ (folded >> 32)) & 0xFFFFFFFFULL;
+    return static_cast<std::size_t>(mulhi(magic_ * folded, divisor_));
+  }
+
+private:
+  static constexpr std::uint32_t kPrimes[] = {
+      2,         5,         11,        17,        37,        79,         163,
+      331,       673,       1361,      2729,      5471,      10949,      21911,
+      43853,     87719,     175447,    350899,    701819,    1403641,    2807303,
+      5614657,   11229331,  22458671,  44917381,  89834777,  179669557,  359339171,
+      718678369, 1437356741, 2874713497U, 4294967291U};
+
+  std::uint64_t magic_ = 1;
+  std::uint32_t divisor_ = 1;
+
+  static std::uint64_t mulhi(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;
+    return static_cast<std::uint64_t>((static_cast<u128>(a) * b) >> 64);
+#else
+    const std::uint64_t a_lo = a & 0xFFFFFFFFULL;
+    const std::uint64_t a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xFFFFFFFFULL;
+    const std::uint64_t b_hi = b >> 32;
+    const std::uint64_t lo_lo = a_lo * b_lo;
+    const std::uint64_t hi_lo = a_hi * b_lo;
+    const std::uint64_t lo_hi = a_lo * b_hi;
+    const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+  }
+};
+
+// Whether hash tables store each element's full hash next to it. Cached hashes make rehash skip
+// `Hash{}` entirely and let probes reject mismatches before calling `KeyEqual`. Keys that are
+// cheaper to hash than to store another word for (arithmetic, enum, pointer) opt out by default;
+// specialize for other key/hash pairs to override.
+template <typename K, typename Hash>
+struct cache_hash_code
+    : std::bool_constant<!(std::is_arithmetic_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>)> {
+};
+
+template <typename K, typename Hash>
+inline constexpr bool cache_hash_code_v = cache_hash_code<K, Hash>::value;
+
+// Element storage for hash tables: the value plus, when `CacheHash` is set, its hash.
+template <typename T, bool CacheHash> struct hash_slot {
+  template <typename... Args>
+  explicit hash_slot(std::size_t h, Args&&... args) : value(std::forward<Args>(args)...), hash(h) {}
+
+  T value;
+  std::size_t hash;
+};
+
+template <typename T> struct hash_slot<T, false> {
+  template <typename... Args>
+  explicit hash_slot(std::size_t, Args&&... args) : value(std::forward<Args>(args)...) {}
+
+  T value;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "vector/vector.hpp"
+
+// Snapshot of a hash table's memory use and shape, returned by `stats()` on the unordered
+// containers. Computing one walks the whole table, so it is meant for diagnostics, not hot paths.
+//
+// "Chain length" follows the table's layout. For chained tables (unordered_multimap/multiset),
+// histogram[k] counts buckets holding k elements, and max/p99 are taken over non-empty buckets.
+// For open addressing (unordered_map/set), histogram[k] counts elements found on the k-th group
+// probed from their home position (k >= 1), and max/p99 are taken over elements. A well-behaved
+// hash keeps both close to 1; a long tail means clustering or a weak `Hash`.
+struct hash_table_stats {
+  std::size_t size = 0;
+  std::size_t bucket_count = 0;
+  // Heap bytes owned by the table itself: bucket/slot arrays, control bytes and chain nodes.
+  // Memory owned by the elements (string buffers and so on) is not included.
+  std::size_t bytes_allocated = 0;
+  // Separately allocated nodes; always 0 for open addressing.
+  std::size_t node_count = 0;
+  double load_factor = 0.0;
+  double empty_bucket_ratio = 0.0;
+  Vector<std::size_t> chain_length_histogram;
+  std::size_t max_chain_length = 0;
+  std::size_t p99_chain_length = 0;
+  // Table rebuilds since construction (growth, rehash(), reserve(), max_load_factor()).
+  std::size_t rehash_count = 0;
+  // Keyed lookups and the probes they made (groups or chain nodes examined). Both stay 0 unless
+  // the library is built with STL_HASH_PROBE_STATS.
+  std::size_t lookups = 0;
+  std::size_t probes = 0;
+
+  double probes_per_lookup() const noexcept {
+    return lookups == 0 ? 0.0 : static_cast<double>(probes) / static_cast<double>(lookups);
+  }
+};
+
+// Fills max/p99 from `chain_length_histogram`, counting only entries at index >= `first`.
+inline void finish_chain_stats(hash_table_stats& stats, std::size_t first) {
+  const auto& hist = stats.chain_length_histogram;
+  std::size_t population = 0;
+  for (std::size_t k = first; k < hist.size(); ++k)
+    population += hist[k];
+  if (population == 0)
+    return;
+
+  const std::size_t p99_rank = population - population / 100;
+  std::size_t seen = 0;
+  for (std::size_t k = first; k < hist.size(); ++k) {
+    if (hist[k] == 0)
+      continue;
+    if (seen < p99_rank && seen + hist[k] >= p99_rank)
+      stats.p99_chain_length = k;
+    seen += hist[k];
+    stats.max_chain_length = k;
+  }
+}
+
+// Per-container lookup counters behind STL_HASH_PROBE_STATS. When the macro is off this is an
+// empty class whose calls compile away, so containers pay nothing for carrying one. Counting is
+// done from const lookups that may run concurrently, hence the relaxed atomic increments.
+#if defined(STL_HASH_PROBE_STATS)
+class hash_probe_counter {
+public:
+  static constexpr bool kEnabled = true;
+
+  hash_probe_counter() = default;
+  // Counters describe the lookups made on one container object; copies start from zero.
+  hash_probe_counter(const hash_probe_counter&) noexcept {}
+  hash_probe_counter& operator=(const hash_probe_counter&) noexcept {
+    return *this;
+  }
+
+  void record(std::size_t probes) const noexcept {
+    std::atomic_ref<std::size_t>(lookups_).fetch_add(1, std::memory_order_relaxed);
+    std::atomic_ref<std::size_t>(probes_).fetch_add(probes, std::memory_order_relaxed);
+  }
+
+  void fill(hash_table_stats& stats) const noexcept {
+    stats.lookups = std::atomic_ref<std::size_t>(lookups_).load(std::memory_order_relaxed);
+    stats.probes = std::atomic_ref<std::size_t>(probes_).load(std::memory_order_relaxed);
+  }
+
+private:
+  alignas(std::atomic_ref<std::size_t>::required_alignment) mutable std::size_t lookups_ = 0;
+  alignas(std::atomic_ref<std::size_t>::required_alignment) mutable std::size_t probes_ = 0;
+};
+#else
+class hash_probe_counter {
+public:
+  static constexpr bool kEnabled = false;
+
+  void record(std::size_t) const noexcept {}
+  void fill(hash_table_stats&) const noexcept {}
+};
+#endif
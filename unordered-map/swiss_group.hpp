@@ -0,0 +1,98 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STL_SWISS_SSE2 1
+#include <emmintrin.h>
+#else
+#define STL_SWISS_SSE2 0
+#endif
+
+// Control bytes for open-addressing hash tables. A full slot stores the low 7 bits of its hash
+// (0..127); the two special states have the high bit set so a single movemask separates them.
+using swiss_ctrl_t = std::int8_t;
+
+inline constexpr swiss_ctrl_t kSwissEmpty = -128;  // 0b10000000
+inline constexpr swiss_ctrl_t kSwissDeleted = -2;  // 0b11111110
+
+inline constexpr bool swiss_is_full(swiss_ctrl_t c) noexcept {
+  return c >= 0;
+}
+
+// A window of 16 control bytes probed in parallel. Every match_* returns a 16-bit mask with
+// bit i set when byte i satisfies the predicate. Uses SSE2 when available and a portable SWAR
+// (SIMD-within-a-register) fallback over two 64-bit words otherwise.
+class SwissGroup {
+public:
+  static constexpr std::size_t kWidth = 16;
+
+  explicit SwissGroup(const swiss_ctrl_t* ctrl) noexcept {
+#if STL_SWISS_SSE2
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+    std::memcpy(&lo_, ctrl, sizeof(lo_));
+    std::memcpy(&hi_, ctrl + 8, sizeof(hi_));
+    if constexpr (std::endian::native == std::endian::big) {
+      lo_ = std::byteswap(lo_);
+      hi_ = std::byteswap(hi_);
+    }
+#endif
+  }
+
+  // May report false positives in the SWAR path; callers always confirm with a key compare.
+  std::uint16_t match(std::uint8_t h2) const noexcept {
+#if STL_SWISS_SSE2
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(h2));
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(needle, ctrl_)));
+#else
+    return pack(match_word(lo_, h2), match_word(hi_, h2));
+#endif
+  }
+
+  std::uint16_t match_empty() const noexcept {
+#if STL_SWISS_SSE2
+    const __m128i empty = _mm_set1_epi8(kSwissEmpty);
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(empty, ctrl_)));
+#else
+    // kSwissEmpty is the only state with bit 7 set and bit 1 clear.
+    return pack(lo_ & ~(lo_ << 6) & kMsbs, hi_ & ~(hi_ << 6) & kMsbs);
+#endif
+  }
+
+  std::uint16_t match_empty_or_deleted() const noexcept {
+#if STL_SWISS_SSE2
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(ctrl_));
+#else
+    return pack(lo_ & kMsbs, hi_ & kMsbs);
+#endif
+  }
+
+private:
+#if STL_SWISS_SSE2
+  __m128i ctrl_;
+#else
+  static constexpr std::uint64_t kLsbs = 0x0101010101010101ULL;
+  static constexpr std::uint64_t kMsbs = 0x8080808080808080ULL;
+
+  std::uint64_t lo_;
+  std::uint64_t hi_;
+
+  static std::uint64_t match_word(std::uint64_t word, std::uint8_t h2) noexcept {
+    const std::uint64_t x = word ^ (kLsbs * h2);
+    return (x - kLsbs) & ~x & kMsbs;
+  }
+
+  // Gathers the high bit of each byte (bits 7, 15, ..., 63) into the low 8 bits.
+  static std::uint16_t compact(std::uint64_t msbs) noexcept {
+    return static_cast<std::uint16_t>(((msbs >> 7) * 0x0102040810204080ULL) >> 56);
+  }
+
+  static std::uint16_t pack(std::uint64_t lo, std::uint64_t hi) noexcept {
+    return static_cast<std::uint16_t>(compact(lo) | (compact(hi) << 8));
+  }
+#endif
+};
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -8,27 +12,134 @@
 #include <type_traits>
 #include <utility>
 
-#include "forward-list/forward_list.hpp"
+#include "unordered-map/hash_policy.hpp"
+#include "unordered-map/hash_stats.hpp"
+#include "span/span.hpp"
+#include "unordered-map/swiss_group.hpp"
+#include "utility/node_handle.hpp"
+#include "utility/prefetch.hpp"
+#include "utility/transparent.hpp"
 #include "vector/vector.hpp"
 
+// Open-addressing ("Swiss table") hash map. Slots are stored inline in one array next to a
+// control-byte array holding a 7-bit hash tag per slot, so a lookup probes 16 tags at a time and
+// touches at most one slot per true candidate. Unless `cache_hash_code` opts the key out, each
+// slot also keeps the full hash so rehash never calls `Hash` again. `BucketPolicy` (see
+// hash_policy.hpp) chooses where a probe starts and which slot counts are legal.
+//
+// Growth normally moves every element in one call. `incremental_rehash(true)` instead keeps the
+// old table alive after growing and migrates a fixed number of its slots on each insert, erase
+// and non-const lookup (Redis-style), so no single operation pays for the whole rehash.
 template <typename K, typename V, typename Hash = std::hash<K>,
-          typename KeyEqual = std::equal_to<K>>
+          typename KeyEqual = std::equal_to<K>,
+          typename BucketPolicy = power_of_two_bucket_policy>
 class unordered_map {
 public:
   using key_type = K;
   using mapped_type = V;
   using pair_type = std::pair<K, V>;
   using size_type = std::size_t;
+  using bucket_policy = BucketPolicy;
 
-  template <typename T_value, typename T_list_iterator> class base_iterator;
+  template <typename T_value> class base_iterator;
 
-  using iterator = base_iterator<pair_type, typename ForwardList<pair_type>::iterator>;
-  using const_iterator =
-      base_iterator<const pair_type, typename ForwardList<pair_type>::const_iterator>;
+  using iterator = base_iterator<pair_type>;
+  using const_iterator = base_iterator<const pair_type>;
+  // Elements live inline in the slot array, so a handle carries the element itself.
+  using node_type = value_handle<pair_type>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
 
   unordered_map() : unordered_map(16) {}
-  explicit unordered_map(size_type bucket_count) : buckets_{}, size_(0), max_load_factor_(1.0f) {
-    buckets_.resize(bucket_count == 0 ? 1 : bucket_count);
+  explicit unordered_map(size_type bucket_count)
+      : ctrl_(nullptr), slots_(nullptr), capacity_(0), size_(0), growth_left_(0),
+        max_load_factor_(kMaxLoadFactor) {
+    allocate_storage(std::max(bucket_count, kMinCapacity));
+  }
+
+  unordered_map(const unordered_map& other)
+      : unordered_map(std::max(other.capacity_, other.capacity_for(other.size_))) {
+    max_load_factor_ = other.max_load_factor_;
+    incremental_rehash_ = other.incremental_rehash_;
+    growth_left_ = growth_limit(capacity_);
+    for (size_type j = 0; j < other.end_index(); ++j) {
+      if (!other.full_at(j))
+        continue;
+      const slot_type& slot = other.slot_at(j);
+      const std::size_t hash = other.slot_hash(slot);
+      const size_type i = find_first_non_full(hash);
+      std::construct_at(slots_ + i, hash, slot.value);
+      commit_insert(i, hash);
+    }
+  }
+
+  unordered_map(unordered_map&& other) noexcept
+      : ctrl_(std::exchange(other.ctrl_, nullptr)), slots_(std::exchange(other.slots_, nullptr)),
+        capacity_(std::exchange(other.capacity_, 0)), size_(std::exchange(other.size_, 0)),
+        growth_left_(std::exchange(other.growth_left_, 0)),
+        max_load_factor_(other.max_load_factor_), policy_(other.policy_),
+        old_ctrl_(std::exchange(other.old_ctrl_, nullptr)),
+        old_slots_(std::exchange(other.old_slots_, nullptr)),
+        old_capacity_(std::exchange(other.old_capacity_, 0)),
+        old_size_(std::exchange(other.old_size_, 0)),
+        migrate_pos_(std::exchange(other.migrate_pos_, 0)), old_policy_(other.old_policy_),
+        incremental_rehash_(other.incremental_rehash_),
+        rehash_count_(std::exchange(other.rehash_count_, 0)) {}
+
+  unordered_map& operator=(const unordered_map& other) {
+    if (this == &other)
+      return *this;
+    unordered_map tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  unordered_map& operator=(unordered_map&& other) noexcept {
+    if (this == &other)
+      return *this;
+    destroy_slots();
+    deallocate_storage(ctrl_, slots_, capacity_);
+    release_old_storage();
+    ctrl_ = std::exchange(other.ctrl_, nullptr);
+    slots_ = std::exchange(other.slots_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    size_ = std::exchange(other.size_, 0);
+    growth_left_ = std::exchange(other.growth_left_, 0);
+    max_load_factor_ = other.max_load_factor_;
+    policy_ = other.policy_;
+    old_ctrl_ = std::exchange(other.old_ctrl_, nullptr);
+    old_slots_ = std::exchange(other.old_slots_, nullptr);
+    old_capacity_ = std::exchange(other.old_capacity_, 0);
+    old_size_ = std::exchange(other.old_size_, 0);
+    migrate_pos_ = std::exchange(other.migrate_pos_, 0);
+    old_policy_ = other.old_policy_;
+    incremental_rehash_ = other.incremental_rehash_;
+    rehash_count_ = std::exchange(other.rehash_count_, 0);
+    return *this;
+  }
+
+  ~unordered_map() {
+    destroy_slots();
+    deallocate_storage(ctrl_, slots_, capacity_);
+    release_old_storage();
+  }
+
+  void swap(unordered_map& other) noexcept {
+    using std::swap;
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(capacity_, other.capacity_);
+    swap(size_, other.size_);
+    swap(growth_left_, other.growth_left_);
+    swap(max_load_factor_, other.max_load_factor_);
+    swap(policy_, other.policy_);
+    swap(old_ctrl_, other.old_ctrl_);
+    swap(old_slots_, other.old_slots_);
+    swap(old_capacity_, other.old_capacity_);
+    swap(old_size_, other.old_size_);
+    swap(migrate_pos_, other.migrate_pos_);
+    swap(old_policy_, other.old_policy_);
+    swap(incremental_rehash_, other.incremental_rehash_);
+    swap(rehash_count_, other.rehash_count_);
   }
 
   bool empty() const noexcept {
@@ -37,8 +148,9 @@ public:
   size_type size() const noexcept {
     return size_;
   }
+  // Number of slots; every slot is its own "bucket" in an open-addressing table.
   size_type bucket_count() const noexcept {
-    return buckets_.size();
+    return capacity_;
   }
 
   float load_factor() const noexcept {
@@ -50,36 +162,49 @@ public:
   float max_load_factor() const noexcept {
     return max_load_factor_;
   }
-  void max_load_factor(float f) noexcept {
-    max_load_factor_ = (f <= 0.0f) ? 1.0f : f;
+  // Open addressing needs free slots to terminate probes, so values are clamped to 0.875.
+  void max_load_factor(float f) {
+    max_load_factor_ = (f <= 0.0f || f > kMaxLoadFactor) ? kMaxLoadFactor : f;
+    if (capacity_ != 0)
+      resize(std::max(capacity_, capacity_for(size_)));
+  }
+
+  // While enabled, growth only allocates the new table; the old one is drained kRehashStep slots
+  // at a time and lookups consult both until it is empty. Any non-const call, including `find`,
+  // may then move elements. Disabling finishes a pending migration.
+  void incremental_rehash(bool enabled) {
+    if (!enabled)
+      finish_migration();
+    incremental_rehash_ = enabled;
+  }
+  bool incremental_rehash() const noexcept {
+    return incremental_rehash_;
+  }
+  bool rehash_in_progress() const noexcept {
+    return old_ctrl_ != nullptr;
   }
 
+  // Walks every slot to report memory use and probe lengths; see hash_stats.hpp. Elements still in
+  // the old table of an incremental rehash are measured from their home in that table.
+  hash_table_stats stats() const;
+
   void clear() noexcept {
-    for (auto& b : buckets_)
-      b.clear();
+    destroy_slots();
+    release_old_storage();
+    if (capacity_ != 0)
+      std::memset(ctrl_, kSwissEmpty, capacity_ + kGroupWidth - 1);
     size_ = 0;
+    growth_left_ = growth_limit(capacity_);
   }
 
   void reserve(size_type n) {
-    const auto needed = static_cast<size_type>(static_cast<float>(n) / max_load_factor_) + 1;
+    const auto needed = capacity_for(n);
     if (needed > bucket_count())
       rehash(needed);
   }
 
   void rehash(size_type bucket_count) {
-    if (bucket_count < 1)
-      bucket_count = 1;
-    Vector<ForwardList<pair_type>> next;
-    next.resize(bucket_count);
-
-    for (auto& bucket : buckets_) {
-      for (auto& kv : bucket) {
-        const size_type idx = Hash{}(kv.first) % bucket_count;
-        next[idx].push_front(std::move(kv));
-      }
-    }
-
-    buckets_ = std::move(next);
+    resize(std::max({bucket_count, capacity_for(size_), kMinCapacity}));
   }
 
   void insert(pair_type pair) {
@@ -89,11 +214,91 @@ public:
     insert_or_assign({std::move(key), std::move(value)});
   }
 
+  // Same result as inserting each element in turn (later duplicates overwrite earlier ones), but
+  // reserves once up front and works in blocks of kBatchSize: a block is hashed and its probe
+  // starts prefetched before any of it is inserted, so the cache misses overlap.
+  template <std::forward_iterator It> void insert_range(It first, It last) {
+    insert_range_impl<false>(first, last);
+  }
+
   iterator find(const K& key);
   const_iterator find(const K& key) const;
+  bool contains(const K& key) const {
+    return find_index(key, hash_of(key)) != end_index();
+  }
+  size_type count(const K& key) const {
+    return contains(key) ? 1 : 0;
+  }
 
   void erase(const K& key);
 
+  // Node handles, as for std::unordered_map. extract() moves an element out into a handle and
+  // frees its slot; insert() puts it back here or in another map, keeping the handle if the key is
+  // already present (it does not overwrite, unlike insert(pair_type)). merge() moves over each
+  // element of `source` whose key is absent here, reusing its cached hash and growing at most once.
+  node_type extract(const K& key);
+  node_type extract(const_iterator pos) {
+    return extract_at(pos.index_);
+  }
+  node_type extract(iterator pos) {
+    return extract_at(pos.index_);
+  }
+  insert_return_type insert(node_type&& nh);
+  void merge(unordered_map& source);
+  void merge(unordered_map&& source) {
+    merge(source);
+  }
+
+  // Erases every element for which `pred(const pair_type&)` is true and returns how many were
+  // erased. Erasing never moves the remaining elements, so the scan sees each one exactly once.
+  template <typename Pred> size_type erase_if(Pred pred) {
+    size_type erased = 0;
+    for (size_type i = 0; i < end_index(); ++i) {
+      if (full_at(i) && pred(std::as_const(slot_at(i).value))) {
+        erase_at(i);
+        ++erased;
+      }
+    }
+    return erased;
+  }
+
+  // Heterogeneous lookup, enabled when both Hash and KeyEqual are transparent. `Hash` must give
+  // equal results for a key and any probe value that compares equal to it.
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  iterator find(const Q& key) {
+    advance_migration();
+    return iterator(this, find_index(key, hash_of(key)));
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  const_iterator find(const Q& key) const {
+    return const_iterator(this, find_index(key, hash_of(key)));
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool contains(const Q& key) const {
+    return find_index(key, hash_of(key)) != end_index();
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type count(const Q& key) const {
+    return contains(key) ? 1 : 0;
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  void erase(const Q& key) {
+    advance_migration();
+    const size_type i = find_index(key, hash_of(key));
+    if (i != end_index())
+      erase_at(i);
+  }
+
+  // Stores find(keys[i]) in out[i] for every key. Keys are hashed kBatchSize at a time and their
+  // first probe group prefetched before any is probed, so the cache misses of a block overlap.
+  void find_batch(Span<const K> keys, Span<iterator> out);
+  void find_batch(Span<const K> keys, Span<const_iterator> out) const;
+
   V& at(const K& key);
   const V& at(const K& key) const;
 
@@ -123,121 +328,640 @@ public:
   }
 
 private:
-  Vector<ForwardList<pair_type>> buckets_;
+  template <typename, typename, typename, typename> friend class unordered_set;
+
+  static constexpr size_type kGroupWidth = SwissGroup::kWidth;
+  static constexpr size_type kBatchSize = 16;
+  static constexpr size_type kMinCapacity = kGroupWidth;
+  static constexpr float kMaxLoadFactor = 0.875f;
+  static constexpr bool kCacheHash = cache_hash_code_v<K, Hash>;
+  // Old-table slots migrated per operation during an incremental rehash. Growth leaves room for at
+  // least half the growth limit in new inserts, so at normal load factors the old table drains
+  // long before the new one fills; if it does not, the next growth finishes the migration first.
+  static constexpr size_type kRehashStep = 4 * kGroupWidth;
+
+  using slot_type = hash_slot<pair_type, kCacheHash>;
+
+  // ctrl_ holds capacity_ control bytes followed by kGroupWidth - 1 clones of the first bytes, so
+  // a group load starting at any slot index never needs to wrap.
+  swiss_ctrl_t* ctrl_;
+  slot_type* slots_;
+  size_type capacity_;
   size_type size_;
+  size_type growth_left_;
   float max_load_factor_;
+  BucketPolicy policy_{};
+
+  // Incremental-rehash state. While old_ctrl_ is set, old_size_ live elements remain in the old
+  // table at indices >= migrate_pos_, and growth_left_ >= old_size_ holds so they always fit.
+  // Indices in [capacity_, capacity_ + old_capacity_) address the old table.
+  swiss_ctrl_t* old_ctrl_ = nullptr;
+  slot_type* old_slots_ = nullptr;
+  size_type old_capacity_ = 0;
+  size_type old_size_ = 0;
+  size_type migrate_pos_ = 0;
+  BucketPolicy old_policy_{};
+  bool incremental_rehash_ = false;
+
+  size_type rehash_count_ = 0;
+  [[no_unique_address]] hash_probe_counter probe_counter_;
+
+  template <typename Q> std::size_t hash_of(const Q& key) const {
+    return policy_.mix(Hash{}(key));
+  }
+
+  std::size_t slot_hash(const slot_type& slot) const {
+    if constexpr (kCacheHash)
+      return slot.hash;
+    else
+      return hash_of(slot.value.first);
+  }
+
+  // The tag comes from the top bits of a multiply so it stays independent of the low bits the
+  // policy uses for the probe start, even when the policy does not mix (identity hashes).
+  static std::uint8_t h2(std::size_t hash) noexcept {
+    if constexpr (sizeof(std::size_t) == 8)
+      return static_cast<std::uint8_t>((hash * 0x9E3779B97F4A7C15ULL) >> 57);
+    else
+      return static_cast<std::uint8_t>((hash * 0x9E3779B9U) >> 25);
+  }
+
+  size_type probe_start(std::size_t hash) const noexcept {
+    return policy_.index(hash);
+  }
+
+  static size_type wrap(size_type i, size_type capacity) noexcept {
+    return i >= capacity ? i - capacity : i;
+  }
+  size_type wrap(size_type i) const noexcept {
+    return wrap(i, capacity_);
+  }
+
+  size_type end_index() const noexcept {
+    return capacity_ + old_capacity_;
+  }
+  bool full_at(size_type i) const noexcept {
+    return swiss_is_full(i < capacity_ ? ctrl_[i] : old_ctrl_[i - capacity_]);
+  }
+  slot_type& slot_at(size_type i) noexcept {
+    return i < capacity_ ? slots_[i] : old_slots_[i - capacity_];
+  }
+  const slot_type& slot_at(size_type i) const noexcept {
+    return i < capacity_ ? slots_[i] : old_slots_[i - capacity_];
+  }
 
-  size_type bucket_of(const K& key) const {
-    return Hash{}(key) % bucket_count();
+  size_type growth_limit(size_type capacity) const noexcept {
+    if (capacity == 0)
+      return 0;
+    const auto limit = static_cast<size_type>(static_cast<float>(capacity) * max_load_factor_);
+    return std::min(limit, capacity - 1);
   }
 
-  void maybe_rehash_for_insert() {
-    const float projected = static_cast<float>(size_ + 1) / static_cast<float>(bucket_count());
-    if (projected > max_load_factor_)
-      rehash(bucket_count() * 2);
+  size_type capacity_for(size_type n) const noexcept {
+    return std::max(static_cast<size_type>(static_cast<float>(n) / max_load_factor_) + 1,
+                    kMinCapacity);
   }
 
+  static void set_ctrl(swiss_ctrl_t* ctrl, size_type capacity, size_type i,
+                       swiss_ctrl_t c) noexcept {
+    ctrl[i] = c;
+    if (i < kGroupWidth - 1)
+      ctrl[capacity + i] = c;
+  }
+  void set_ctrl(size_type i, swiss_ctrl_t c) noexcept {
+    set_ctrl(ctrl_, capacity_, i, c);
+  }
+
+  void advance_migration() {
+    if (old_ctrl_ != nullptr)
+      migrate_step();
+  }
+  void finish_migration() {
+    while (old_ctrl_ != nullptr)
+      migrate_step();
+  }
+
+  template <typename Q> size_type find_index(const Q& key, std::size_t hash) const;
+  template <typename Q>
+  size_type probe_table(const swiss_ctrl_t* ctrl, const slot_type* slots, size_type capacity,
+                        size_type pos, const Q& key, std::size_t hash, size_type& groups) const;
+  size_type find_first_non_full(std::size_t hash) const noexcept;
+  size_type prepare_insert(std::size_t hash);
+  void commit_insert(size_type i, std::size_t hash) noexcept;
+  void erase_at(size_type i) noexcept;
+  node_type extract_at(size_type i);
+  void resize(size_type new_capacity);
+  void grow(size_type new_capacity);
+  void migrate_step();
+  void release_old_storage() noexcept;
+
+  void allocate_storage(size_type capacity);
+  static void deallocate_storage(swiss_ctrl_t* ctrl, slot_type* slots,
+                                 size_type capacity) noexcept;
+  void destroy_slots() noexcept;
+
   V& try_emplace_default(const K& key);
   void insert_or_assign(pair_type pair);
+
+  // KeysOnly ranges hold bare keys (unordered_set) and insert them with a default V.
+  template <bool KeysOnly, typename T> static decltype(auto) key_of(const T& element) noexcept {
+    if constexpr (KeysOnly)
+      return (element);
+    else
+      return (element.first);
+  }
+  template <bool KeysOnly, typename It> void insert_range_impl(It first, It last);
+  void probe_block(const K* keys, size_type n, size_type* out) const;
 };
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-typename unordered_map<K, V, Hash, KeyEqual>::iterator
-unordered_map<K, V, Hash, KeyEqual>::find(const K& key) {
-  const size_type bucket = bucket_of(key);
-  auto& list = buckets_[bucket];
-  for (auto it = list.begin(); it != list.end(); ++it) {
-    if (KeyEqual{}(it->first, key))
-      return iterator(this, bucket, it);
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::iterator
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find(const K& key) {
+  advance_migration();
+  return iterator(this, find_index(key, hash_of(key)));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::const_iterator
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find(const K& key) const {
+  return const_iterator(this, find_index(key, hash_of(key)));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::erase(const K& key) {
+  advance_migration();
+  const size_type i = find_index(key, hash_of(key));
+  if (i != end_index())
+    erase_at(i);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find_batch(Span<const K> keys,
+                                                                   Span<iterator> out) {
+  if (out.size() < keys.size())
+    throw std::length_error("unordered_map::find_batch output too small");
+  size_type found[kBatchSize];
+  for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+    const size_type n = std::min(kBatchSize, keys.size() - base);
+    probe_block(keys.data() + base, n, found);
+    for (size_type j = 0; j < n; ++j)
+      out[base + j] = iterator(this, found[j]);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find_batch(
+    Span<const K> keys, Span<const_iterator> out) const {
+  if (out.size() < keys.size())
+    throw std::length_error("unordered_map::find_batch output too small");
+  size_type found[kBatchSize];
+  for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+    const size_type n = std::min(kBatchSize, keys.size() - base);
+    probe_block(keys.data() + base, n, found);
+    for (size_type j = 0; j < n; ++j)
+      out[base + j] = const_iterator(this, found[j]);
   }
-  return end();
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-typename unordered_map<K, V, Hash, KeyEqual>::const_iterator
-unordered_map<K, V, Hash, KeyEqual>::find(const K& key) const {
-  const size_type bucket = bucket_of(key);
-  const auto& list = buckets_[bucket];
-  for (auto it = list.begin(); it != list.end(); ++it) {
-    if (KeyEqual{}(it->first, key))
-      return const_iterator(this, bucket, it);
+// Two passes over at most kBatchSize keys: hash and prefetch everything, then probe. Only the
+// current table is prefetched; keys still in a migrating old table are probed cold.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::probe_block(const K* keys, size_type n,
+                                                                    size_type* out) const {
+  std::size_t hashes[kBatchSize];
+  for (size_type j = 0; j < n; ++j) {
+    hashes[j] = hash_of(keys[j]);
+    const size_type pos = probe_start(hashes[j]);
+    prefetch_read(ctrl_ + pos);
+    prefetch_read(slots_ + pos);
   }
-  return cend();
+  for (size_type j = 0; j < n; ++j)
+    out[j] = find_index(keys[j], hashes[j]);
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-void unordered_map<K, V, Hash, KeyEqual>::erase(const K& key) {
-  const size_type bucket = bucket_of(key);
-  auto& list = buckets_[bucket];
-
-  auto before = list.before_begin();
-  for (auto it = list.begin(); it != list.end(); ++it) {
-    if (KeyEqual{}(it->first, key)) {
-      list.erase_after(before);
-      --size_;
-      return;
+// Reserving first means no block triggers a growth, so the probe starts prefetched for a block
+// are still valid when its elements are placed.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+template <bool KeysOnly, typename It>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::insert_range_impl(It first, It last) {
+  const auto n = static_cast<size_type>(std::distance(first, last));
+  if (n == 0)
+    return;
+  finish_migration();
+  reserve(size_ + n);
+
+  std::size_t hashes[kBatchSize];
+  while (first != last) {
+    It block = first;
+    size_type m = 0;
+    for (; m < kBatchSize && first != last; ++m, ++first) {
+      hashes[m] = hash_of(key_of<KeysOnly>(*first));
+      const size_type pos = probe_start(hashes[m]);
+      prefetch_read(ctrl_ + pos);
+      prefetch_read(slots_ + pos);
+    }
+    for (size_type j = 0; j < m; ++j, ++block) {
+      decltype(auto) element = *block;
+      const size_type found = find_index(key_of<KeysOnly>(element), hashes[j]);
+      if (found != end_index()) {
+        if constexpr (!KeysOnly)
+          slot_at(found).value.second = std::forward<decltype(element)>(element).second;
+        continue;
+      }
+      const size_type i = prepare_insert(hashes[j]);
+      if constexpr (KeysOnly)
+        std::construct_at(slots_ + i, hashes[j], std::forward<decltype(element)>(element), V{});
+      else
+        std::construct_at(slots_ + i, hashes[j], std::forward<decltype(element)>(element));
+      commit_insert(i, hashes[j]);
     }
-    ++before;
   }
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-V& unordered_map<K, V, Hash, KeyEqual>::at(const K& key) {
-  const size_type bucket = bucket_of(key);
-  auto& list = buckets_[bucket];
-  for (auto& kv : list) {
-    if (KeyEqual{}(kv.first, key))
-      return kv.second;
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+V& unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::at(const K& key) {
+  advance_migration();
+  const size_type i = find_index(key, hash_of(key));
+  if (i == end_index())
+    throw std::out_of_range("unordered_map::at missing key");
+  return slot_at(i).value.second;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+const V& unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::at(const K& key) const {
+  const size_type i = find_index(key, hash_of(key));
+  if (i == end_index())
+    throw std::out_of_range("unordered_map::at missing key");
+  return slot_at(i).value.second;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+V& unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::try_emplace_default(const K& key) {
+  advance_migration();
+  const std::size_t hash = hash_of(key);
+  const size_type found = find_index(key, hash);
+  if (found != end_index())
+    return slot_at(found).value.second;
+
+  const size_type i = prepare_insert(hash);
+  std::construct_at(slots_ + i, hash, key, V{});
+  commit_insert(i, hash);
+  return slots_[i].value.second;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::insert_or_assign(pair_type pair) {
+  advance_migration();
+  const std::size_t hash = hash_of(pair.first);
+  const size_type found = find_index(pair.first, hash);
+  if (found != end_index()) {
+    slot_at(found).value.second = std::move(pair.second);
+    return;
   }
-  throw std::out_of_range("unordered_map::at missing key");
+
+  const size_type i = prepare_insert(hash);
+  std::construct_at(slots_ + i, hash, std::move(pair));
+  commit_insert(i, hash);
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-const V& unordered_map<K, V, Hash, KeyEqual>::at(const K& key) const {
-  const size_type bucket = bucket_of(key);
-  const auto& list = buckets_[bucket];
-  for (const auto& kv : list) {
-    if (KeyEqual{}(kv.first, key))
-      return kv.second;
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::node_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::extract(const K& key) {
+  advance_migration();
+  return extract_at(find_index(key, hash_of(key)));
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::node_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::extract_at(size_type i) {
+  if (i == end_index())
+    return node_type();
+  node_type nh(std::in_place, std::move(slot_at(i).value));
+  erase_at(i);
+  return nh;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::insert_return_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::insert(node_type&& nh) {
+  if (nh.empty())
+    return {end(), false, node_type()};
+  advance_migration();
+  const K& key = nh.element().first;
+  const std::size_t hash = hash_of(key);
+  const size_type found = find_index(key, hash);
+  if (found != end_index())
+    return {iterator(this, found), false, std::move(nh)};
+
+  const size_type i = prepare_insert(hash);
+  std::construct_at(slots_ + i, hash, nh.take());
+  commit_insert(i, hash);
+  return {iterator(this, i), true, node_type()};
+}
+
+// Erasing never moves other elements, so `source` can be walked by index while it drains.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::merge(unordered_map& source) {
+  if (&source == this || source.size_ == 0)
+    return;
+  reserve(size_ + source.size_);
+  for (size_type i = 0; i < source.end_index(); ++i) {
+    if (!source.full_at(i))
+      continue;
+    auto& slot = source.slot_at(i);
+    const std::size_t hash = source.slot_hash(slot);
+    if (find_index(slot.value.first, hash) != end_index())
+      continue;
+    const size_type j = prepare_insert(hash);
+    std::construct_at(slots_ + j, hash, std::move(slot.value));
+    commit_insert(j, hash);
+    source.erase_at(i);
   }
-  throw std::out_of_range("unordered_map::at missing key");
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-V& unordered_map<K, V, Hash, KeyEqual>::try_emplace_default(const K& key) {
-  const size_type bucket = bucket_of(key);
-  auto& list = buckets_[bucket];
-  for (auto& kv : list) {
-    if (KeyEqual{}(kv.first, key))
-      return kv.second;
-  }
-  maybe_rehash_for_insert();
-  const size_type next_bucket = bucket_of(key);
-  buckets_[next_bucket].push_front({key, V{}});
-  ++size_;
-  return buckets_[next_bucket].front().second;
+// Returns end_index() when the key is absent. During a migration the new table is probed first;
+// a key lives in exactly one of the two tables.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+template <typename Q>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::size_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find_index(const Q& key,
+                                                              std::size_t hash) const {
+  if (size_ == 0)
+    return end_index();
+  size_type groups = 0;
+  const size_type i =
+      probe_table(ctrl_, slots_, capacity_, probe_start(hash), key, hash, groups);
+  if (i != capacity_ || old_ctrl_ == nullptr) {
+    probe_counter_.record(groups);
+    return i == capacity_ ? end_index() : i;
+  }
+  const size_type j = probe_table(old_ctrl_, old_slots_, old_capacity_, old_policy_.index(hash),
+                                  key, hash, groups);
+  probe_counter_.record(groups);
+  return j == old_capacity_ ? end_index() : capacity_ + j;
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-void unordered_map<K, V, Hash, KeyEqual>::insert_or_assign(pair_type pair) {
-  const size_type bucket = bucket_of(pair.first);
-  auto& list = buckets_[bucket];
-  for (auto& kv : list) {
-    if (KeyEqual{}(kv.first, pair.first)) {
-      kv.second = std::move(pair.second);
-      return;
+// Returns `capacity` when the key is absent. A probe ends at the first group holding an empty
+// slot: insertion would have stopped there, so the key cannot live further along. `groups` is
+// incremented once per group examined.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+template <typename Q>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::size_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::probe_table(const swiss_ctrl_t* ctrl,
+                                                               const slot_type* slots,
+                                                               size_type capacity, size_type pos,
+                                                               const Q& key, std::size_t hash,
+                                                               size_type& groups) const {
+  const std::uint8_t tag = h2(hash);
+  for (size_type probed = 0; probed <= capacity; probed += kGroupWidth) {
+    ++groups;
+    const SwissGroup group(ctrl + pos);
+    for (auto m = group.match(tag); m != 0; m &= static_cast<std::uint16_t>(m - 1)) {
+      const size_type i = wrap(pos + static_cast<size_type>(std::countr_zero(m)), capacity);
+      if constexpr (kCacheHash) {
+        if (slots[i].hash != hash)
+          continue;
+      }
+      if (KeyEqual{}(slots[i].value.first, key))
+        return i;
     }
+    if (group.match_empty() != 0)
+      break;
+    pos = wrap(pos + kGroupWidth, capacity);
+  }
+  return capacity;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+hash_table_stats unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::stats() const {
+  hash_table_stats s;
+  s.size = size_;
+  s.bucket_count = capacity_;
+  s.load_factor = static_cast<double>(load_factor());
+  s.rehash_count = rehash_count_;
+  for (const size_type capacity : {capacity_, old_capacity_}) {
+    if (capacity != 0)
+      s.bytes_allocated += (capacity + kGroupWidth - 1) * sizeof(swiss_ctrl_t) +
+                           capacity * sizeof(slot_type);
   }
 
-  maybe_rehash_for_insert();
-  const size_type next_bucket = bucket_of(pair.first);
-  buckets_[next_bucket].push_front(std::move(pair));
+  // An element at distance d from its probe start is found on group d / kGroupWidth + 1.
+  size_type empty = 0;
+  auto& hist = s.chain_length_histogram;
+  for (size_type i = 0; i < end_index(); ++i) {
+    if (!full_at(i)) {
+      if (i < capacity_ && ctrl_[i] == kSwissEmpty)
+        ++empty;
+      continue;
+    }
+    const std::size_t hash = slot_hash(slot_at(i));
+    const bool in_new = i < capacity_;
+    const size_type capacity = in_new ? capacity_ : old_capacity_;
+    const size_type pos = in_new ? i : i - capacity_;
+    const size_type start = in_new ? probe_start(hash) : old_policy_.index(hash);
+    const size_type groups = wrap(pos + capacity - start, capacity) / kGroupWidth + 1;
+    if (hist.size() <= groups)
+      hist.resize(groups + 1);
+    ++hist[groups];
+  }
+  if (capacity_ != 0)
+    s.empty_bucket_ratio = static_cast<double>(empty) / static_cast<double>(capacity_);
+  finish_chain_stats(s, 1);
+  probe_counter_.fill(s);
+  return s;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::size_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::find_first_non_full(
+    std::size_t hash) const noexcept {
+  size_type pos = probe_start(hash);
+  while (true) {
+    const auto m = SwissGroup(ctrl_ + pos).match_empty_or_deleted();
+    if (m != 0)
+      return wrap(pos + static_cast<size_type>(std::countr_zero(m)));
+    pos = wrap(pos + kGroupWidth);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+typename unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::size_type
+unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::prepare_insert(std::size_t hash) {
+  if (growth_left_ <= old_size_) {
+    finish_migration();
+    if (capacity_ == 0)
+      resize(kMinCapacity);
+    else if (size_ * 2 <= growth_limit(capacity_))
+      grow(capacity_); // Mostly tombstones: rebuild in place instead of growing.
+    else
+      grow(capacity_ * 2);
+  }
+  return find_first_non_full(hash);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::commit_insert(size_type i,
+                                                                      std::size_t hash) noexcept {
+  if (ctrl_[i] == kSwissEmpty)
+    --growth_left_;
+  set_ctrl(i, static_cast<swiss_ctrl_t>(h2(hash)));
   ++size_;
 }
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
-template <typename T_value, typename T_list_iterator>
-class unordered_map<K, V, Hash, KeyEqual>::base_iterator {
+// A slot can go straight back to empty when every 16-wide window covering it still has an empty
+// slot, because no probe sequence could have walked past it. Otherwise leave a tombstone.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::erase_at(size_type i) noexcept {
+  if (i >= capacity_) {
+    // The old table is discarded once drained, so a tombstone is all it needs.
+    i -= capacity_;
+    std::destroy_at(old_slots_ + i);
+    set_ctrl(old_ctrl_, old_capacity_, i, kSwissDeleted);
+    --old_size_;
+    --size_;
+    return;
+  }
+
+  std::destroy_at(slots_ + i);
+  --size_;
+
+  const size_type before = i >= kGroupWidth ? i - kGroupWidth : i + capacity_ - kGroupWidth;
+  const auto empty_after = SwissGroup(ctrl_ + i).match_empty();
+  const auto empty_before = SwissGroup(ctrl_ + before).match_empty();
+  const bool was_never_full =
+      empty_before != 0 && empty_after != 0 &&
+      static_cast<size_type>(std::countr_zero(empty_after) + std::countl_zero(empty_before)) <
+          kGroupWidth;
+
+  if (was_never_full) {
+    set_ctrl(i, kSwissEmpty);
+    ++growth_left_;
+  } else {
+    set_ctrl(i, kSwissDeleted);
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::resize(size_type new_capacity) {
+  finish_migration();
+  swiss_ctrl_t* old_ctrl = ctrl_;
+  slot_type* old_slots = slots_;
+  const size_type old_capacity = capacity_;
+
+  allocate_storage(new_capacity);
+  if (old_capacity != 0)
+    ++rehash_count_;
+  growth_left_ -= size_;
+  for (size_type i = 0; i < old_capacity; ++i) {
+    if (!swiss_is_full(old_ctrl[i]))
+      continue;
+    const std::size_t hash = slot_hash(old_slots[i]);
+    const size_type j = find_first_non_full(hash);
+    set_ctrl(j, static_cast<swiss_ctrl_t>(h2(hash)));
+    std::construct_at(slots_ + j, hash, std::move(old_slots[i].value));
+    std::destroy_at(old_slots + i);
+  }
+  deallocate_storage(old_ctrl, old_slots, old_capacity);
+}
+
+// Growth triggered by an insert. In incremental mode the current table becomes the old table and
+// is drained by migrate_step(); elements stay where they are until then.
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::grow(size_type new_capacity) {
+  if (!incremental_rehash_ || size_ == 0) {
+    resize(new_capacity);
+    return;
+  }
+
+  swiss_ctrl_t* ctrl = ctrl_;
+  slot_type* slots = slots_;
+  const size_type capacity = capacity_;
+  const BucketPolicy policy = policy_;
+  allocate_storage(new_capacity);
+  ++rehash_count_;
+  old_ctrl_ = ctrl;
+  old_slots_ = slots;
+  old_capacity_ = capacity;
+  old_policy_ = policy;
+  old_size_ = size_;
+  migrate_pos_ = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::migrate_step() {
+  const size_type stop = std::min(old_capacity_, migrate_pos_ + kRehashStep);
+  for (; migrate_pos_ < stop && old_size_ != 0; ++migrate_pos_) {
+    if (!swiss_is_full(old_ctrl_[migrate_pos_]))
+      continue;
+    slot_type& slot = old_slots_[migrate_pos_];
+    const std::size_t hash = slot_hash(slot);
+    const size_type j = find_first_non_full(hash);
+    if (ctrl_[j] == kSwissEmpty)
+      --growth_left_;
+    set_ctrl(j, static_cast<swiss_ctrl_t>(h2(hash)));
+    std::construct_at(slots_ + j, hash, std::move(slot.value));
+    std::destroy_at(std::addressof(slot));
+    set_ctrl(old_ctrl_, old_capacity_, migrate_pos_, kSwissDeleted);
+    --old_size_;
+  }
+  if (old_size_ == 0)
+    release_old_storage();
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::release_old_storage() noexcept {
+  deallocate_storage(old_ctrl_, old_slots_, old_capacity_);
+  old_ctrl_ = nullptr;
+  old_slots_ = nullptr;
+  old_capacity_ = 0;
+  old_size_ = 0;
+  migrate_pos_ = 0;
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::allocate_storage(size_type capacity) {
+  capacity = BucketPolicy::round_bucket_count(std::max(capacity, kMinCapacity));
+  swiss_ctrl_t* ctrl = std::allocator<swiss_ctrl_t>{}.allocate(capacity + kGroupWidth - 1);
+  try {
+    slots_ = std::allocator<slot_type>{}.allocate(capacity);
+  } catch (...) {
+    std::allocator<swiss_ctrl_t>{}.deallocate(ctrl, capacity + kGroupWidth - 1);
+    throw;
+  }
+  ctrl_ = ctrl;
+  capacity_ = capacity;
+  policy_.prepare(capacity_);
+  std::memset(ctrl_, kSwissEmpty, capacity_ + kGroupWidth - 1);
+  growth_left_ = growth_limit(capacity_);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::deallocate_storage(swiss_ctrl_t* ctrl,
+                                                             slot_type* slots,
+                                                             size_type capacity) noexcept {
+  if (!ctrl)
+    return;
+  std::allocator<swiss_ctrl_t>{}.deallocate(ctrl, capacity + kGroupWidth - 1);
+  std::allocator<slot_type>{}.deallocate(slots, capacity);
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+void unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::destroy_slots() noexcept {
+  if constexpr (!std::is_trivially_destructible_v<slot_type>) {
+    for (size_type i = 0; i < capacity_; ++i) {
+      if (swiss_is_full(ctrl_[i]))
+        std::destroy_at(slots_ + i);
+    }
+    for (size_type i = 0; i < old_capacity_; ++i) {
+      if (swiss_is_full(old_ctrl_[i]))
+        std::destroy_at(old_slots_ + i);
+    }
+  }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
+template <typename T_value>
+class unordered_map<K, V, Hash, KeyEqual, BucketPolicy>::base_iterator {
 public:
   using value_type = T_value;
   using pointer = T_value*;
@@ -245,27 +969,25 @@ public:
   using difference_type = std::ptrdiff_t;
   using iterator_category = std::forward_iterator_tag;
 
+  base_iterator() noexcept : map_(nullptr), index_(0) {}
+
   static base_iterator
   begin(std::conditional_t<std::is_const_v<T_value>, const unordered_map*, unordered_map*> map) {
-    base_iterator it(map, 0, {});
-    it.skip_empty_buckets();
+    base_iterator it(map, 0);
+    it.skip_empty_slots();
     return it;
   }
 
   static base_iterator
   end(std::conditional_t<std::is_const_v<T_value>, const unordered_map*, unordered_map*> map) {
-    return base_iterator(map, map->bucket_count(), {});
+    return base_iterator(map, map->end_index());
   }
 
   base_iterator& operator++() {
-    if (bucket_ == map_->bucket_count())
+    if (index_ == map_->end_index())
       return *this;
-
-    ++it_;
-    if (it_ == bucket_list().end()) {
-      ++bucket_;
-      skip_empty_buckets();
-    }
+    ++index_;
+    skip_empty_slots();
     return *this;
   }
 
@@ -276,15 +998,14 @@ public:
   }
 
   reference operator*() const {
-    return *it_;
+    return map_->slot_at(index_).value;
   }
   pointer operator->() const {
-    return std::addressof(*it_);
+    return std::addressof(map_->slot_at(index_).value);
   }
 
   bool operator==(const base_iterator& other) const {
-    return map_ == other.map_ && bucket_ == other.bucket_ &&
-           (bucket_ == map_->bucket_count() || it_ == other.it_);
+    return map_ == other.map_ && index_ == other.index_;
   }
 
   bool operator!=(const base_iterator& other) const {
@@ -292,29 +1013,20 @@ public:
   }
 
 private:
+  friend class unordered_map;
+
   using map_ptr =
       std::conditional_t<std::is_const_v<T_value>, const unordered_map*, unordered_map*>;
 
   map_ptr map_;
-  size_type bucket_;
-  T_list_iterator it_;
+  size_type index_;
 
 public:
-  base_iterator(map_ptr map, size_type bucket, T_list_iterator it)
-      : map_(map), bucket_(bucket), it_(std::move(it)) {}
+  base_iterator(map_ptr map, size_type index) : map_(map), index_(index) {}
 
 private:
-  auto& bucket_list() const {
-    return map_->buckets_[bucket_];
-  }
-
-  void skip_empty_buckets() {
-    while (bucket_ < map_->bucket_count() && map_->buckets_[bucket_].empty())
-      ++bucket_;
-    if (bucket_ >= map_->bucket_count()) {
-      bucket_ = map_->bucket_count();
-      return;
-    }
-    it_ = map_->buckets_[bucket_].begin();
+  void skip_empty_slots() {
+    while (index_ < map_->end_index() && !map_->full_at(index_))
+      ++index_;
   }
 };
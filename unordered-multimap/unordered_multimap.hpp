@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <iterator>
@@ -9,28 +10,58 @@
 #include <utility>
 
 #include "forward-list/forward_list.hpp"
+#include "span/span.hpp"
+#include "unordered-map/hash_policy.hpp"
+#include "unordered-map/hash_stats.hpp"
+#include "utility/node_handle.hpp"
+#include "utility/prefetch.hpp"
+#include "utility/transparent.hpp"
 #include "vector/vector.hpp"
 
 template <typename K, typename V, typename Hash = std::hash<K>,
-          typename KeyEqual = std::equal_to<K>>
+          typename KeyEqual = std::equal_to<K>,
+          typename BucketPolicy = power_of_two_bucket_policy>
 class unordered_multimap {
 public:
   using key_type = K;
   using mapped_type = V;
   using value_type = std::pair<const K, V>;
   using size_type = std::size_t;
+  using bucket_policy = BucketPolicy;
 
+private:
+  // Chain nodes keep the element's (mixed) hash unless `cache_hash_code` opts the key out.
+  static constexpr bool kCacheHash = cache_hash_code_v<K, Hash>;
+  using slot_type = hash_slot<value_type, kCacheHash>;
+  using bucket_type = ForwardList<slot_type>;
+  using node_pointer = typename bucket_type::node_pointer;
+
+  // A detached chain node keeps its slot, cached hash included.
+  struct node_traits {
+    using pointer = node_pointer;
+    using element_type = value_type;
+
+    static value_type& element(node_pointer node) noexcept {
+      return bucket_type::node_value(node).value;
+    }
+    static void destroy(node_pointer node) noexcept {
+      bucket_type::destroy_node(node);
+    }
+  };
+
+public:
   template <typename T_value, typename T_list_iterator> class base_iterator;
 
-  using iterator = base_iterator<value_type, typename ForwardList<value_type>::iterator>;
-  using const_iterator =
-      base_iterator<const value_type, typename ForwardList<value_type>::const_iterator>;
+  using iterator = base_iterator<value_type, typename bucket_type::iterator>;
+  using const_iterator = base_iterator<const value_type, typename bucket_type::const_iterator>;
+  using node_type = node_handle<node_traits>;
 
   unordered_multimap() : unordered_multimap(16) {}
 
   explicit unordered_multimap(size_type bucket_count)
       : buckets_{}, size_(0), max_load_factor_(1.0f) {
-    buckets_.resize(bucket_count == 0 ? 1 : bucket_count);
+    buckets_.resize(BucketPolicy::round_bucket_count(bucket_count));
+    policy_.prepare(buckets_.size());
   }
 
   bool empty() const noexcept {
@@ -69,20 +100,45 @@ public:
   }
 
   void rehash(size_type new_bucket_count) {
-    if (new_bucket_count < 1)
-      new_bucket_count = 1;
-    Vector<ForwardList<value_type>> next;
+    new_bucket_count = BucketPolicy::round_bucket_count(new_bucket_count);
+    Vector<bucket_type> next;
     next.resize(new_bucket_count);
-    size_ = 0;
+    BucketPolicy next_policy{};
+    next_policy.prepare(new_bucket_count);
 
+    // Nodes are relinked into the new buckets, not reallocated.
     for (auto& bucket : buckets_) {
-      for (auto& kv : bucket) {
-        insert_into(next, std::move(kv));
-      }
-      bucket.clear();
+      while (!bucket.empty())
+        link_into(next, next_policy, bucket.unlink_after(bucket.before_begin()));
     }
 
     buckets_ = std::move(next);
+    policy_ = next_policy;
+    ++rehash_count_;
+  }
+
+  // Walks every bucket to report memory use and chain lengths; see hash_stats.hpp.
+  hash_table_stats stats() const {
+    hash_table_stats s;
+    s.size = size_;
+    s.bucket_count = bucket_count();
+    s.node_count = size_;
+    s.bytes_allocated =
+        buckets_.capacity() * sizeof(bucket_type) + size_ * bucket_type::node_size;
+    s.load_factor = static_cast<double>(load_factor());
+    s.rehash_count = rehash_count_;
+    auto& hist = s.chain_length_histogram;
+    for (const auto& bucket : buckets_) {
+      const auto length = static_cast<size_type>(std::distance(bucket.begin(), bucket.end()));
+      if (hist.size() <= length)
+        hist.resize(length + 1);
+      ++hist[length];
+    }
+    if (!buckets_.empty())
+      s.empty_bucket_ratio = static_cast<double>(hist[0]) / static_cast<double>(bucket_count());
+    finish_chain_stats(s, 1);
+    probe_counter_.fill(s);
+    return s;
   }
 
   iterator begin() {
@@ -105,69 +161,266 @@ public:
   }
 
   iterator find(const K& key) {
-    const size_type b = bucket_of(key);
-    return iterator::from_bucket(this, b, find_in_bucket(b, key));
+    return find_impl(key);
   }
   const_iterator find(const K& key) const {
-    const size_type b = bucket_of(key);
-    return const_iterator::from_bucket(this, b, find_in_bucket(b, key));
+    return find_impl(key);
+  }
+  bool contains(const K& key) const {
+    return find_impl(key) != cend();
   }
-
   size_type count(const K& key) const {
-    const size_type b = bucket_of(key);
-    const auto& list = buckets_[b];
+    return count_impl(key);
+  }
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    return equal_range_impl(key);
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+    return equal_range_impl(key);
+  }
+
+  iterator insert(value_type value) {
+    maybe_rehash_for_insert();
+    const std::size_t hash = hash_of(value.first);
+    insert_into(buckets_, policy_, hash, std::move(value));
+    return find(value.first);
+  }
+
+  template <typename... Args> iterator emplace(Args&&... args) {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  // Same result as inserting each element in turn, but rehashes at most once and works in blocks
+  // of kBatchSize: a block's buckets and chain heads are prefetched before any of it is linked.
+  template <std::forward_iterator It> void insert_range(It first, It last) {
+    insert_range_impl<false>(first, last);
+  }
+
+  // Stores find(keys[i]) in out[i] for every key. Each block of kBatchSize keys is hashed and its
+  // buckets prefetched, then its chain heads prefetched, before any chain is searched.
+  void find_batch(Span<const K> keys, Span<iterator> out) {
+    check_batch_output(keys.size(), out.size());
+    size_type buckets[kBatchSize];
+    std::size_t hashes[kBatchSize];
+    for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+      const size_type n = std::min(kBatchSize, keys.size() - base);
+      prefetch_block(keys.data() + base, n, buckets, hashes);
+      prefetch_chains(buckets, n);
+      for (size_type j = 0; j < n; ++j)
+        out[base + j] = find_hashed(buckets[j], keys[base + j], hashes[j]);
+    }
+  }
+  void find_batch(Span<const K> keys, Span<const_iterator> out) const {
+    check_batch_output(keys.size(), out.size());
+    size_type buckets[kBatchSize];
+    std::size_t hashes[kBatchSize];
+    for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+      const size_type n = std::min(kBatchSize, keys.size() - base);
+      prefetch_block(keys.data() + base, n, buckets, hashes);
+      prefetch_chains(buckets, n);
+      for (size_type j = 0; j < n; ++j)
+        out[base + j] = find_hashed(buckets[j], keys[base + j], hashes[j]);
+    }
+  }
+
+  size_type erase(const K& key) {
+    return erase_impl(key);
+  }
+
+  // Node handles, as for std::unordered_multimap. extract() unlinks a chain node, insert() links
+  // it into this or another multimap, and merge() relinks every node of `source`. Nodes keep their
+  // cached hash, and nothing is allocated or copied apart from growing the bucket array.
+  node_type extract(const K& key) {
+    const std::size_t hash = hash_of(key);
+    auto& list = buckets_[policy_.index(hash)];
+    for (auto before = list.before_begin(), it = list.begin(); it != list.end(); ++before, ++it) {
+      if (matches(*it, key, hash)) {
+        --size_;
+        return node_type(list.unlink_after(before));
+      }
+    }
+    return node_type();
+  }
+  node_type extract(const_iterator pos) {
+    return pos == cend() ? node_type() : extract_at(pos.bucket_, pos.it_);
+  }
+  node_type extract(iterator pos) {
+    return pos == end() ? node_type() : extract_at(pos.bucket_, pos.it_);
+  }
+
+  iterator insert(node_type&& nh) {
+    if (nh.empty())
+      return end();
+    maybe_rehash_for_insert();
+    const std::size_t hash = slot_hash(bucket_type::node_value(nh.get()));
+    const auto it = link_into(buckets_, policy_, nh.release());
+    ++size_;
+    return iterator::from_bucket(this, policy_.index(hash), it);
+  }
+
+  void merge(unordered_multimap& source) {
+    if (&source == this || source.size_ == 0)
+      return;
+    reserve(size_ + source.size_);
+    for (auto& bucket : source.buckets_) {
+      while (!bucket.empty()) {
+        link_into(buckets_, policy_, bucket.unlink_after(bucket.before_begin()));
+        ++size_;
+      }
+    }
+    source.size_ = 0;
+  }
+  void merge(unordered_multimap&& source) {
+    merge(source);
+  }
+
+  // Heterogeneous lookup, enabled when both Hash and KeyEqual are transparent.
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  iterator find(const Q& key) {
+    return find_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  const_iterator find(const Q& key) const {
+    return find_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool contains(const Q& key) const {
+    return find_impl(key) != cend();
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type count(const Q& key) const {
+    return count_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  std::pair<iterator, iterator> equal_range(const Q& key) {
+    return equal_range_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  std::pair<const_iterator, const_iterator> equal_range(const Q& key) const {
+    return equal_range_impl(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type erase(const Q& key) {
+    return erase_impl(key);
+  }
+
+private:
+  template <typename, typename, typename, typename> friend class unordered_multiset;
+
+  static constexpr size_type kBatchSize = 16;
+
+  Vector<bucket_type> buckets_;
+  size_type size_;
+  float max_load_factor_;
+  BucketPolicy policy_{};
+  size_type rehash_count_ = 0;
+  [[no_unique_address]] hash_probe_counter probe_counter_;
+
+  template <typename Q> std::size_t hash_of(const Q& key) const {
+    return policy_.mix(Hash{}(key));
+  }
+
+  std::size_t slot_hash(const slot_type& slot) const {
+    if constexpr (kCacheHash)
+      return slot.hash;
+    else
+      return hash_of(slot.value.first);
+  }
+
+  // With cached hashes, a cheap integer compare rejects most non-matching chain entries before
+  // `KeyEqual` runs.
+  template <typename Q> static bool matches(const slot_type& slot, const Q& key, std::size_t hash) {
+    if constexpr (kCacheHash) {
+      if (slot.hash != hash)
+        return false;
+    }
+    return KeyEqual{}(slot.value.first, key);
+  }
+
+  template <typename Q> iterator find_impl(const Q& key) {
+    const std::size_t hash = hash_of(key);
+    return find_hashed(policy_.index(hash), key, hash);
+  }
+  template <typename Q> const_iterator find_impl(const Q& key) const {
+    const std::size_t hash = hash_of(key);
+    return find_hashed(policy_.index(hash), key, hash);
+  }
+
+  // A miss must map to end(): from_bucket would otherwise advance to the next bucket's element.
+  template <typename Q> iterator find_hashed(size_type b, const Q& key, std::size_t hash) {
+    const auto it = find_in_bucket(b, key, hash);
+    if (it == buckets_[b].end())
+      return end();
+    return iterator::from_bucket(this, b, it);
+  }
+  template <typename Q>
+  const_iterator find_hashed(size_type b, const Q& key, std::size_t hash) const {
+    const auto it = find_in_bucket(b, key, hash);
+    if (it == buckets_[b].end())
+      return cend();
+    return const_iterator::from_bucket(this, b, it);
+  }
+
+  template <typename Q> size_type count_impl(const Q& key) const {
+    const std::size_t hash = hash_of(key);
+    const auto& list = buckets_[policy_.index(hash)];
     size_type n = 0;
+    size_type probes = 0;
     for (auto it = list.begin(); it != list.end(); ++it) {
-      if (KeyEqual{}(it->first, key))
+      ++probes;
+      if (matches(*it, key, hash))
         ++n;
       else if (n != 0)
         break;
     }
+    probe_counter_.record(probes);
     return n;
   }
 
-  std::pair<iterator, iterator> equal_range(const K& key) {
-    const size_type b = bucket_of(key);
-    auto it = find_in_bucket(b, key);
+  template <typename Q> std::pair<iterator, iterator> equal_range_impl(const Q& key) {
+    const std::size_t hash = hash_of(key);
+    const size_type b = policy_.index(hash);
+    auto it = find_in_bucket(b, key, hash);
     if (it == buckets_[b].end())
       return {end(), end()};
 
     auto last = it;
-    while (last != buckets_[b].end() && KeyEqual{}(last->first, key))
+    while (last != buckets_[b].end() && matches(*last, key, hash))
       ++last;
     return {iterator::from_bucket(this, b, it), iterator::from_bucket(this, b, last)};
   }
 
-  std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
-    const size_type b = bucket_of(key);
-    auto it = find_in_bucket(b, key);
+  template <typename Q>
+  std::pair<const_iterator, const_iterator> equal_range_impl(const Q& key) const {
+    const std::size_t hash = hash_of(key);
+    const size_type b = policy_.index(hash);
+    auto it = find_in_bucket(b, key, hash);
     if (it == buckets_[b].end())
       return {cend(), cend()};
 
     auto last = it;
-    while (last != buckets_[b].end() && KeyEqual{}(last->first, key))
+    while (last != buckets_[b].end() && matches(*last, key, hash))
       ++last;
     return {const_iterator::from_bucket(this, b, it), const_iterator::from_bucket(this, b, last)};
   }
 
-  iterator insert(value_type value) {
-    maybe_rehash_for_insert();
-    insert_into(buckets_, std::move(value));
-    return find(value.first);
-  }
-
-  template <typename... Args> iterator emplace(Args&&... args) {
-    return insert(value_type(std::forward<Args>(args)...));
-  }
-
-  size_type erase(const K& key) {
-    const size_type b = bucket_of(key);
-    auto& list = buckets_[b];
+  template <typename Q> size_type erase_impl(const Q& key) {
+    const std::size_t hash = hash_of(key);
+    auto& list = buckets_[policy_.index(hash)];
 
     size_type erased = 0;
+    size_type probes = 0;
     auto before = list.before_begin();
     for (auto it = list.begin(); it != list.end();) {
-      if (!KeyEqual{}(it->first, key)) {
+      ++probes;
+      if (!matches(*it, key, hash)) {
         if (erased != 0)
           break;
         ++before;
@@ -178,16 +431,18 @@ public:
       ++erased;
       --size_;
     }
+    probe_counter_.record(probes);
     return erased;
   }
 
-private:
-  Vector<ForwardList<value_type>> buckets_;
-  size_type size_;
-  float max_load_factor_;
-
-  size_type bucket_of(const K& key) const {
-    return Hash{}(key) % bucket_count();
+  // Chains are singly linked, so unlinking walks from the bucket head to the node's predecessor.
+  node_type extract_at(size_type b, typename bucket_type::const_iterator pos) {
+    auto& list = buckets_[b];
+    auto before = list.before_begin();
+    while (typename bucket_type::const_iterator(std::next(before)) != pos)
+      ++before;
+    --size_;
+    return node_type(list.unlink_after(before));
   }
 
   void maybe_rehash_for_insert() {
@@ -196,17 +451,88 @@ private:
       rehash(bucket_count() * 2);
   }
 
-  template <typename Buckets> void insert_into(Buckets& buckets, value_type value) {
-    const size_type b = Hash{}(value.first) % buckets.size();
-    auto& list = buckets[b];
+  static void check_batch_output(size_type keys, size_type out) {
+    if (out < keys)
+      throw std::length_error("unordered_multimap::find_batch output too small");
+  }
+
+  // Computes hash and bucket for `n` keys and prefetches each bucket header.
+  void prefetch_block(const K* keys, size_type n, size_type* buckets,
+                      std::size_t* hashes) const {
+    for (size_type j = 0; j < n; ++j) {
+      hashes[j] = hash_of(keys[j]);
+      buckets[j] = policy_.index(hashes[j]);
+      prefetch_read(std::addressof(buckets_[buckets[j]]));
+    }
+  }
+
+  // Prefetches the first node of each chain; its bucket header should already be in flight.
+  void prefetch_chains(const size_type* buckets, size_type n) const {
+    for (size_type j = 0; j < n; ++j) {
+      const auto& list = buckets_[buckets[j]];
+      if (!list.empty())
+        prefetch_read(std::addressof(*list.begin()));
+    }
+  }
 
+  // KeysOnly ranges hold bare keys (unordered_multiset) and insert them with a default V.
+  template <bool KeysOnly, typename It> void insert_range_impl(It first, It last) {
+    const auto n = static_cast<size_type>(std::distance(first, last));
+    if (n == 0)
+      return;
+    reserve(size_ + n);
+
+    std::size_t hashes[kBatchSize];
+    size_type buckets[kBatchSize];
+    while (first != last) {
+      It block = first;
+      size_type m = 0;
+      for (; m < kBatchSize && first != last; ++m, ++first) {
+        if constexpr (KeysOnly)
+          hashes[m] = hash_of(*first);
+        else
+          hashes[m] = hash_of((*first).first);
+        buckets[m] = policy_.index(hashes[m]);
+        prefetch_read(std::addressof(buckets_[buckets[m]]));
+      }
+      prefetch_chains(buckets, m);
+      for (size_type j = 0; j < m; ++j, ++block) {
+        if constexpr (KeysOnly)
+          insert_into(buckets_, policy_, hashes[j], value_type(*block, V{}));
+        else
+          insert_into(buckets_, policy_, hashes[j], value_type(*block));
+      }
+    }
+  }
+
+  template <typename Buckets>
+  void insert_into(Buckets& buckets, const BucketPolicy& policy, std::size_t hash,
+                   value_type value) {
+    auto& list = buckets[policy.index(hash)];
+    list.emplace_after(insert_position(list, value.first, hash), hash, std::move(value));
+    ++size_;
+  }
+
+  // Links a detached node into `buckets` where insert_into would have put its value. Does not
+  // touch size_, so rehash can use it too.
+  template <typename Buckets>
+  typename bucket_type::iterator link_into(Buckets& buckets, const BucketPolicy& policy,
+                                           node_pointer node) {
+    const slot_type& slot = bucket_type::node_value(node);
+    const std::size_t hash = slot_hash(slot);
+    auto& list = buckets[policy.index(hash)];
+    return list.link_after(insert_position(list, slot.value.first, hash), node);
+  }
+
+  // Equal keys stay adjacent: a new key goes in front of the last element of its run of equals,
+  // or at the front of the chain when it has none.
+  typename bucket_type::iterator insert_position(bucket_type& list, const K& key,
+                                                 std::size_t hash) {
     auto before = list.before_begin();
-    auto it = list.begin();
     auto last_equal = list.before_begin();
     bool found = false;
-
-    for (; it != list.end(); ++it) {
-      if (KeyEqual{}(it->first, value.first)) {
+    for (auto it = list.begin(); it != list.end(); ++it) {
+      if (matches(*it, key, hash)) {
         found = true;
         last_equal = before;
       } else if (found) {
@@ -214,37 +540,44 @@ private:
       }
       ++before;
     }
-
-    if (!found) {
-      list.push_front(std::move(value));
-    } else {
-      list.insert_after(last_equal, std::move(value));
-    }
-    ++size_;
+    return last_equal;
   }
 
-  typename ForwardList<value_type>::iterator find_in_bucket(size_type b, const K& key) {
+  template <typename Q>
+  typename bucket_type::iterator find_in_bucket(size_type b, const Q& key, std::size_t hash) {
     auto& list = buckets_[b];
+    size_type probes = 0;
     for (auto it = list.begin(); it != list.end(); ++it) {
-      if (KeyEqual{}(it->first, key))
+      ++probes;
+      if (matches(*it, key, hash)) {
+        probe_counter_.record(probes);
         return it;
+      }
     }
+    probe_counter_.record(probes);
     return list.end();
   }
 
-  typename ForwardList<value_type>::const_iterator find_in_bucket(size_type b, const K& key) const {
+  template <typename Q>
+  typename bucket_type::const_iterator find_in_bucket(size_type b, const Q& key,
+                                                      std::size_t hash) const {
     const auto& list = buckets_[b];
+    size_type probes = 0;
     for (auto it = list.begin(); it != list.end(); ++it) {
-      if (KeyEqual{}(it->first, key))
+      ++probes;
+      if (matches(*it, key, hash)) {
+        probe_counter_.record(probes);
         return it;
+      }
     }
+    probe_counter_.record(probes);
     return list.end();
   }
 };
 
-template <typename K, typename V, typename Hash, typename KeyEqual>
+template <typename K, typename V, typename Hash, typename KeyEqual, typename BucketPolicy>
 template <typename T_value, typename T_list_iterator>
-class unordered_multimap<K, V, Hash, KeyEqual>::base_iterator {
+class unordered_multimap<K, V, Hash, KeyEqual, BucketPolicy>::base_iterator {
 public:
   using value_type = T_value;
   using pointer = T_value*;
@@ -255,6 +588,8 @@ public:
   using map_ptr =
       std::conditional_t<std::is_const_v<T_value>, const unordered_multimap*, unordered_multimap*>;
 
+  base_iterator() : map_(nullptr), bucket_(0), it_{} {}
+
   static base_iterator begin(map_ptr map) {
     base_iterator it(map, 0, {});
     it.skip_empty_buckets();
@@ -294,10 +629,10 @@ public:
   }
 
   reference operator*() const {
-    return *it_;
+    return it_->value;
   }
   pointer operator->() const {
-    return std::addressof(*it_);
+    return std::addressof(it_->value);
   }
 
   bool operator==(const base_iterator& other) const {
@@ -310,6 +645,8 @@ public:
   }
 
 private:
+  friend class unordered_multimap;
+
   map_ptr map_;
   std::size_t bucket_;
   T_list_iterator it_;
@@ -1,21 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <stdexcept>
 #include <utility>
 
+#include "span/span.hpp"
+#include "utility/node_handle.hpp"
+#include "utility/transparent.hpp"
+#include "unordered-map/hash_stats.hpp"
 #include "utility/unit.hpp"
 #include "unordered-multimap/unordered_multimap.hpp"
 
-template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename BucketPolicy = power_of_two_bucket_policy>
 class unordered_multiset {
 public:
   using key_type = K;
   using value_type = K;
   using size_type = std::size_t;
+  using bucket_policy = BucketPolicy;
 
 private:
-  using mmap_type = unordered_multimap<K, unit, Hash, KeyEqual>;
+  using mmap_type = unordered_multimap<K, unit, Hash, KeyEqual, BucketPolicy>;
+  static constexpr size_type kBatchSize = 16;
   mmap_type map_{};
 
   template <typename It> class base_iterator {
@@ -55,12 +65,15 @@ private:
     }
 
   private:
+    friend class unordered_multiset;
+
     It it_{};
   };
 
 public:
   using iterator = base_iterator<typename mmap_type::iterator>;
   using const_iterator = base_iterator<typename mmap_type::const_iterator>;
+  using node_type = typename mmap_type::node_type;
 
   unordered_multiset() = default;
   explicit unordered_multiset(size_type bucket_count) : map_(bucket_count) {}
@@ -72,6 +85,10 @@ public:
     return map_.size();
   }
 
+  hash_table_stats stats() const {
+    return map_.stats();
+  }
+
   iterator begin() {
     return iterator(map_.begin());
   }
@@ -110,4 +127,59 @@ public:
   size_type erase(const K& key) {
     return map_.erase(key);
   }
+
+  bool contains(const K& key) const {
+    return map_.contains(key);
+  }
+
+  // Node handles; see unordered_multimap::extract. value() reads the key out of a handle.
+  node_type extract(const K& key) {
+    return map_.extract(key);
+  }
+  node_type extract(const_iterator pos) {
+    return map_.extract(pos.it_);
+  }
+  iterator insert(node_type&& nh) {
+    return iterator(map_.insert(std::move(nh)));
+  }
+  void merge(unordered_multiset& source) {
+    map_.merge(source.map_);
+  }
+  void merge(unordered_multiset&& source) {
+    map_.merge(source.map_);
+  }
+
+  // Bulk insert; see unordered_multimap::insert_range.
+  template <std::forward_iterator It> void insert_range(It first, It last) {
+    map_.template insert_range_impl<true>(first, last);
+  }
+
+  // Stores find(keys[i]) in out[i]; see unordered_multimap::find_batch.
+  void find_batch(Span<const K> keys, Span<const_iterator> out) const {
+    if (out.size() < keys.size())
+      throw std::length_error("unordered_multiset::find_batch output too small");
+    typename mmap_type::const_iterator found[kBatchSize];
+    for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+      const size_type n = std::min(kBatchSize, keys.size() - base);
+      map_.find_batch(keys.subspan(base, n), Span<typename mmap_type::const_iterator>(found, n));
+      for (size_type j = 0; j < n; ++j)
+        out[base + j] = const_iterator(found[j]);
+    }
+  }
+
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type count(const Q& key) const {
+    return map_.count(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool contains(const Q& key) const {
+    return map_.contains(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type erase(const Q& key) {
+    return map_.erase(key);
+  }
 };
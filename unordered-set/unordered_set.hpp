@@ -1,21 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <iterator>
+#include <stdexcept>
 #include <utility>
 
+#include "span/span.hpp"
+#include "utility/node_handle.hpp"
+#include "utility/transparent.hpp"
+#include "unordered-map/hash_stats.hpp"
 #include "utility/unit.hpp"
 #include "unordered-map/unordered_map.hpp"
 
-template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename BucketPolicy = power_of_two_bucket_policy>
 class unordered_set {
 public:
   using key_type = K;
   using value_type = K;
   using size_type = std::size_t;
+  using bucket_policy = BucketPolicy;
 
 private:
-  using map_type = unordered_map<K, unit, Hash, KeyEqual>;
+  using map_type = unordered_map<K, unit, Hash, KeyEqual, BucketPolicy>;
+  static constexpr size_type kBatchSize = 16;
   map_type map_{};
 
   template <typename It> class base_iterator {
@@ -55,12 +65,16 @@ private:
     }
 
   private:
+    friend class unordered_set;
+
     It it_{};
   };
 
 public:
   using iterator = base_iterator<typename map_type::iterator>;
   using const_iterator = base_iterator<typename map_type::const_iterator>;
+  using node_type = typename map_type::node_type;
+  using insert_return_type = node_insert_return<iterator, node_type>;
 
   unordered_set() = default;
   explicit unordered_set(size_type bucket_count) : map_(bucket_count) {}
@@ -72,6 +86,10 @@ public:
     return map_.size();
   }
 
+  hash_table_stats stats() const {
+    return map_.stats();
+  }
+
   iterator begin() {
     return iterator(map_.begin());
   }
@@ -121,4 +139,75 @@ public:
     map_.erase(key);
     return map_.size() != before;
   }
+
+  size_type count(const K& key) const {
+    return map_.count(key);
+  }
+
+  // Node handles; see unordered_map::extract. value() reads the key out of a handle.
+  node_type extract(const K& key) {
+    return map_.extract(key);
+  }
+  node_type extract(const_iterator pos) {
+    return map_.extract(pos.it_);
+  }
+  node_type extract(iterator pos) {
+    return map_.extract(pos.it_);
+  }
+  insert_return_type insert(node_type&& nh) {
+    auto result = map_.insert(std::move(nh));
+    return {iterator(result.position), result.inserted, std::move(result.node)};
+  }
+  void merge(unordered_set& source) {
+    map_.merge(source.map_);
+  }
+  void merge(unordered_set&& source) {
+    map_.merge(source.map_);
+  }
+
+  // Bulk insert; see unordered_map::insert_range.
+  template <std::forward_iterator It> void insert_range(It first, It last) {
+    map_.template insert_range_impl<true>(first, last);
+  }
+
+  // Stores find(keys[i]) in out[i]; see unordered_map::find_batch.
+  void find_batch(Span<const K> keys, Span<const_iterator> out) const {
+    if (out.size() < keys.size())
+      throw std::length_error("unordered_set::find_batch output too small");
+    typename map_type::const_iterator found[kBatchSize];
+    for (size_type base = 0; base < keys.size(); base += kBatchSize) {
+      const size_type n = std::min(kBatchSize, keys.size() - base);
+      map_.find_batch(keys.subspan(base, n), Span<typename map_type::const_iterator>(found, n));
+      for (size_type j = 0; j < n; ++j)
+        out[base + j] = const_iterator(found[j]);
+    }
+  }
+
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  iterator find(const Q& key) {
+    return iterator(map_.find(key));
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  const_iterator find(const Q& key) const {
+    return const_iterator(map_.find(key));
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool contains(const Q& key) const {
+    return map_.contains(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  size_type count(const Q& key) const {
+    return map_.count(key);
+  }
+  template <typename Q>
+    requires transparent<Hash> && transparent<KeyEqual>
+  bool erase(const Q& key) {
+    const auto before = map_.size();
+    map_.erase(key);
+    return map_.size() != before;
+  }
 };
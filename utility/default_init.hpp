@@ -0,0 +1,9 @@
+#pragma once
+
+// Tag for `resize(n, default_init)`: new elements are default-initialized rather than
+// value-initialized, so trivially default-constructible ones (ints, chars, plain structs) are
+// left indeterminate instead of zeroed. Meant for buffers that are overwritten straight away.
+struct default_init_t {
+  explicit default_init_t() = default;
+};
+inline constexpr default_init_t default_init{};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Epoch-based reclamation: frees objects that lock-free readers may still be looking at once no
+// reader can be. A reader holds an ebr_guard while it follows shared pointers. A writer first
+// unlinks an object, so no new reader can reach it, then hands it to ebr_retire(), and it is
+// destroyed by a later ebr_collect() that finds every guard held since then released.
+//
+// There is one process-wide epoch. A guard copies it into the thread's record, which sits on its
+// own cache line, so readers write only to their own lines. ebr_collect() advances the epoch
+// once no guard holds an older one, and frees what was retired two epochs back: every guard that
+// could have seen it has been released. Records are reused after their thread exits.
+
+// One per thread that has held a guard. `epoch` is 0 while the thread holds none.
+struct alignas(64) ebr_record {
+  std::atomic<std::uint64_t> epoch{0};
+  std::atomic<bool> claimed{true};
+  ebr_record* next = nullptr;
+};
+
+struct ebr_state {
+  struct retired {
+    void* object;
+    void (*destroy)(void*);
+    std::uint64_t epoch;
+  };
+
+  std::atomic<std::uint64_t> epoch{1};
+  std::atomic<ebr_record*> records{nullptr};
+  std::mutex limbo_mutex;
+  std::vector<retired> limbo;
+
+  // Runs at exit, after every thread that held a guard is gone.
+  ~ebr_state() {
+    for (const auto& r : limbo)
+      r.destroy(r.object);
+    for (ebr_record* rec = records.load(); rec;)
+      delete std::exchange(rec, rec->next);
+  }
+};
+
+inline ebr_state& ebr_global() {
+  static ebr_state state;
+  return state;
+}
+
+// The calling thread's record, claimed on first use (reusing one a finished thread left) and
+// handed back when the thread exits. `depth` counts nested guards.
+struct ebr_thread {
+  ebr_record* record = nullptr;
+  std::size_t depth = 0;
+
+  ebr_thread() {
+    ebr_state& state = ebr_global();
+    for (ebr_record* rec = state.records.load(std::memory_order_acquire); rec; rec = rec->next) {
+      bool free = false;
+      if (!rec->claimed.load(std::memory_order_relaxed) &&
+          rec->claimed.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+        record = rec;
+        return;
+      }
+    }
+    record = new ebr_record;
+    record->next = state.records.load(std::memory_order_relaxed);
+    while (!state.records.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+    }
+  }
+  ~ebr_thread() {
+    record->claimed.store(false, std::memory_order_release);
+  }
+
+  ebr_thread(const ebr_thread&) = delete;
+  ebr_thread& operator=(const ebr_thread&) = delete;
+};
+
+inline ebr_thread& ebr_this_thread() {
+  thread_local ebr_thread thread;
+  return thread;
+}
+
+// Pins the current epoch for the calling thread: nothing retired from now on is freed before
+// the guard goes away. Guards nest; only the outermost one pins.
+class ebr_guard {
+public:
+  ebr_guard() : thread_(ebr_this_thread()) {
+    // Sequentially consistent, like the loads of shared pointers it protects and the writer's
+    // unlink, scan and advance: a reader that still sees an unlinked object then holds an epoch
+    // no newer than the one it was retired in, and the scan that follows the unlink sees it.
+    if (thread_.depth++ == 0)
+      thread_.record->epoch.store(ebr_global().epoch.load());
+  }
+  ~ebr_guard() {
+    if (--thread_.depth == 0)
+      thread_.record->epoch.store(0, std::memory_order_release);
+  }
+
+  ebr_guard(const ebr_guard&) = delete;
+  ebr_guard& operator=(const ebr_guard&) = delete;
+
+private:
+  ebr_thread& thread_;
+};
+
+// Frees what was retired at least two epochs ago, after advancing the epoch if no guard still
+// holds an older one. Retired objects are destroyed outside the lock, on the calling thread.
+inline void ebr_collect() {
+  ebr_state& state = ebr_global();
+  std::uint64_t epoch = state.epoch.load();
+  bool quiet = true;
+  for (ebr_record* rec = state.records.load(std::memory_order_acquire); rec; rec = rec->next) {
+    const std::uint64_t held = rec->epoch.load();
+    quiet = quiet && (held == 0 || held == epoch);
+  }
+  if (quiet && state.epoch.compare_exchange_strong(epoch, epoch + 1))
+    ++epoch;
+
+  std::vector<ebr_state::retired> ready;
+  {
+    std::lock_guard lock(state.limbo_mutex);
+    std::erase_if(state.limbo, [&](const ebr_state::retired& r) {
+      if (r.epoch + 2 > epoch)
+        return false;
+      ready.push_back(r);
+      return true;
+    });
+  }
+  for (const auto& r : ready)
+    r.destroy(r.object);
+}
+
+// Hands over an object already unreachable for new readers; `destroy(object)` runs once no
+// guard that might have reached it is held. Collects as well, so retiring keeps limbo short.
+inline void ebr_retire(void* object, void (*destroy)(void*)) {
+  ebr_state& state = ebr_global();
+  {
+    std::lock_guard lock(state.limbo_mutex);
+    state.limbo.push_back({object, destroy, state.epoch.load()});
+  }
+  ebr_collect();
+}
+
+template <typename T> void ebr_retire(T* object) {
+  ebr_retire(object, [](void* p) { delete static_cast<T*>(p); });
+}
+
+// Objects retired but not yet freed, across the process.
+inline std::size_t ebr_pending() {
+  ebr_state& state = ebr_global();
+  std::lock_guard lock(state.limbo_mutex);
+  return state.limbo.size();
+}
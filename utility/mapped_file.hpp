@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "span/span.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STL_MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define STL_MAPPED_FILE_MMAP 0
+#include <fstream>
+
+#include "vector/vector.hpp"
+#endif
+
+// Read-only view of a whole file. On POSIX systems the file is mmap'ed, so opening costs no
+// reads and pages are faulted in on first touch; elsewhere it falls back to reading the file
+// into memory. The bytes stay valid until the mapped_file is destroyed or moved from.
+class mapped_file {
+public:
+  mapped_file() noexcept = default;
+
+  explicit mapped_file(const std::string& path) {
+#if STL_MAPPED_FILE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("mapped_file: cannot open " + path);
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("mapped_file: cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ != 0) {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("mapped_file: cannot map " + path);
+      }
+      data_ = static_cast<const std::byte*>(p);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+      throw std::runtime_error("mapped_file: cannot open " + path);
+    in.seekg(0, std::ios::end);
+    buffer_.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept {
+    swap(other);
+  }
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+      mapped_file tmp(std::move(other));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  ~mapped_file() {
+#if STL_MAPPED_FILE_MMAP
+    if (data_)
+      ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+  }
+
+  void swap(mapped_file& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+#if !STL_MAPPED_FILE_MMAP
+    buffer_.swap(other.buffer_);
+#endif
+  }
+
+  Span<const std::byte> bytes() const noexcept {
+    return {data_, size_};
+  }
+  std::size_t size() const noexcept {
+    return size_;
+  }
+
+private:
+  const std::byte* data_ = nullptr;
+  std::size_t size_ = 0;
+#if !STL_MAPPED_FILE_MMAP
+  Vector<std::byte> buffer_;
+#endif
+};
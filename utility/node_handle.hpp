@@ -0,0 +1,157 @@
+#pragma once
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "utility/unit.hpp"
+
+// Element access shared by the handles below, following the std node handle API: key() and
+// mapped() for map elements, value() for set elements (sets built on a map of `unit` included).
+// Map keys are stored as `const K`, so unlike std, key() is read-only.
+template <typename Derived, typename Element> class node_handle_access {
+public:
+  decltype(auto) value() const
+    requires(!requires { typename Element::second_type; })
+  {
+    return self().element();
+  }
+  decltype(auto) value() const
+    requires std::is_same_v<typename Element::second_type, unit>
+  {
+    return (std::as_const(self().element().first));
+  }
+
+  decltype(auto) key() const
+    requires(!std::is_same_v<typename Element::second_type, unit>)
+  {
+    return (std::as_const(self().element().first));
+  }
+  decltype(auto) mapped() const
+    requires(!std::is_same_v<typename Element::second_type, unit>)
+  {
+    return (self().element().second);
+  }
+
+private:
+  const Derived& self() const noexcept {
+    return static_cast<const Derived&>(*this);
+  }
+};
+
+// Owns one node detached from a node-based container (C++17 `node_type`). `Traits` supplies
+// `pointer`, `element_type`, `element(pointer)` and `destroy(pointer)`, which destroys the
+// element and returns the node's memory to wherever the container got it from.
+//
+// The pointer constructor, get() and release() are how containers hand nodes in and out.
+template <typename Traits>
+class node_handle : public node_handle_access<node_handle<Traits>, typename Traits::element_type> {
+public:
+  using pointer = typename Traits::pointer;
+
+  constexpr node_handle() noexcept = default;
+  explicit node_handle(pointer node) noexcept : node_(node) {}
+
+  node_handle(node_handle&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {}
+  node_handle& operator=(node_handle&& other) noexcept {
+    if (this != &other) {
+      reset();
+      node_ = std::exchange(other.node_, nullptr);
+    }
+    return *this;
+  }
+
+  ~node_handle() {
+    reset();
+  }
+
+  bool empty() const noexcept {
+    return node_ == nullptr;
+  }
+  explicit operator bool() const noexcept {
+    return node_ != nullptr;
+  }
+
+  pointer get() const noexcept {
+    return node_;
+  }
+  pointer release() noexcept {
+    return std::exchange(node_, nullptr);
+  }
+
+  void swap(node_handle& other) noexcept {
+    std::swap(node_, other.node_);
+  }
+
+private:
+  friend class node_handle_access<node_handle, typename Traits::element_type>;
+
+  pointer node_ = nullptr;
+
+  typename Traits::element_type& element() const noexcept {
+    return Traits::element(node_);
+  }
+
+  void reset() noexcept {
+    if (node_)
+      Traits::destroy(std::exchange(node_, nullptr));
+  }
+};
+
+// The `node_type` of containers that store elements inline (open-addressing tables, BTree). There
+// is no node to keep, so the handle holds the element itself, moved out of the container.
+template <typename Element>
+class value_handle : public node_handle_access<value_handle<Element>, Element> {
+public:
+  constexpr value_handle() noexcept = default;
+  explicit value_handle(std::in_place_t, Element&& element) : element_(std::move(element)) {}
+
+  // Written out because map elements (`pair<const K, V>`) are move-constructible only.
+  value_handle(value_handle&& other) noexcept(std::is_nothrow_move_constructible_v<Element>) {
+    if (other.element_)
+      element_.emplace(other.take());
+  }
+  value_handle& operator=(value_handle&& other) noexcept(
+      std::is_nothrow_move_constructible_v<Element>) {
+    if (this != &other) {
+      element_.reset();
+      if (other.element_)
+        element_.emplace(other.take());
+    }
+    return *this;
+  }
+
+  bool empty() const noexcept {
+    return !element_.has_value();
+  }
+  explicit operator bool() const noexcept {
+    return element_.has_value();
+  }
+
+  // For containers: the element in place, and moving it out to store, leaving the handle empty.
+  Element& element() const noexcept {
+    return *element_;
+  }
+  Element take() {
+    Element element = std::move(*element_);
+    element_.reset();
+    return element;
+  }
+
+  void swap(value_handle& other) noexcept(std::is_nothrow_move_constructible_v<Element>) {
+    value_handle tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+private:
+  mutable std::optional<Element> element_;
+};
+
+// What insert(node_type&&) returns on unique-key containers: where the element is, whether it
+// was inserted, and, when it was not, the handle with the element still in it.
+template <typename Iterator, typename NodeType> struct node_insert_return {
+  Iterator position;
+  bool inserted = false;
+  NodeType node;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#if !defined(__GNUC__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Asks the CPU to start loading the cache line holding `p` for a read that will happen soon.
+// Purely a hint: it never faults, even on an invalid address, and compiles to nothing where
+// unsupported.
+inline void prefetch_read(const void* p) noexcept {
+#if defined(__GNUC__)
+  __builtin_prefetch(p, 0, 3);
+#elif defined(_M_X64) || defined(_M_IX86)
+  _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+  (void)p;
+#endif
+}
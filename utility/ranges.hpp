@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+// C++23's container-compatible-range: what `append_range`, `insert_range` and `assign_range`
+// accept. Any input range whose elements convert to T.
+template <typename R, typename T>
+concept container_compatible_range =
+    std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, T>;
+
+// Ranges whose length is known before iterating them, so a container can grow once up front.
+template <typename R>
+concept sized_or_forward_range = std::ranges::sized_range<R> || std::ranges::forward_range<R>;
+
+// True when copying R's elements into T storage can be a single memcpy.
+template <typename R, typename T>
+inline constexpr bool memcpy_range_v =
+    std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+    std::is_same_v<std::remove_cv_t<std::ranges::range_value_t<R>>, T> &&
+    std::is_trivially_copyable_v<T>;
+
+template <sized_or_forward_range R> std::size_t range_length(R&& rg) {
+  if constexpr (std::ranges::sized_range<R>)
+    return static_cast<std::size_t>(std::ranges::size(rg));
+  else
+    return static_cast<std::size_t>(std::ranges::distance(rg));
+}
+
+// Constructs T objects from rg's elements in the uninitialized storage at `dest` and returns the
+// end of what it built. Contiguous ranges of trivially copyable T are copied with one memcpy.
+// If a constructor throws, the objects already built are destroyed before the exception leaves.
+template <typename T, std::ranges::input_range R> T* uninitialized_copy_range(R&& rg, T* dest) {
+  if constexpr (memcpy_range_v<R, T>) {
+    const std::size_t n = range_length(rg);
+    if (n != 0)
+      std::memcpy(static_cast<void*>(dest), static_cast<const void*>(std::ranges::data(rg)),
+                  n * sizeof(T));
+    return dest + n;
+  } else {
+    T* out = dest;
+    try {
+      for (auto&& v : rg) {
+        std::construct_at(out, std::forward<decltype(v)>(v));
+        ++out;
+      }
+    } catch (...) {
+      std::destroy(dest, out);
+      throw;
+    }
+    return out;
+  }
+}
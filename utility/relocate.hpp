@@ -0,0 +1,45 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// True when moving a T into new storage and destroying the original has the same effect as
+// copying its bytes and never touching the original again. Trivially copyable types qualify;
+// so do types that own resources through plain pointers, provided nothing points into the object
+// itself. Contiguous containers use it to move elements with memcpy/memmove on growth, insert
+// and erase. Opt a type in with
+//
+//   template <> struct is_trivially_relocatable<my_handle> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T> inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+template <typename T> struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+template <typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>>
+    : std::bool_constant<is_trivially_relocatable_v<A> && is_trivially_relocatable_v<B>> {};
+
+// Relocates [first, last) to `dest` as raw bytes: the destination is uninitialized beforehand
+// and the source is treated as uninitialized afterwards, with no destructor run. The ranges may
+// overlap. Returns the end of the destination.
+template <typename T> T* trivially_relocate(T* first, T* last, T* dest) noexcept {
+  static_assert(is_trivially_relocatable_v<T>, "trivially_relocate needs a relocatable T");
+  const std::size_t n = static_cast<std::size_t>(last - first);
+  if (n != 0)
+    std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T));
+  return dest + n;
+}
+
+// An allocator that can resize a block it handed out, realloc-style: the first `old_n` elements
+// survive as bytes, possibly at a new address, and the old pointer is dead afterwards. Only
+// meaningful for trivially relocatable T. On failure it throws and leaves the block as it was.
+template <typename A, typename T>
+concept reallocating_allocator = requires(A& a, T* p, std::size_t n) {
+  { a.reallocate(p, n, n) } -> std::same_as<T*>;
+};
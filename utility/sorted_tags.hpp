@@ -0,0 +1,13 @@
+#pragma once
+
+// Constructor tags asserting that an input range is already sorted by the container's Compare:
+// strictly increasing for `sorted_unique`, non-decreasing for `sorted_equivalent` (as in C++23).
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+struct sorted_equivalent_t {
+  explicit sorted_equivalent_t() = default;
+};
+inline constexpr sorted_equivalent_t sorted_equivalent{};
@@ -0,0 +1,6 @@
+#pragma once
+
+// Satisfied when a comparator or hasher declares `is_transparent`, opting its container into
+// heterogeneous lookup (e.g. `std::string_view` probes against `std::string` keys).
+template <typename T>
+concept transparent = requires { typename T::is_transparent; };
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "utility/relocate.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STL_EXPANDABLE_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define STL_EXPANDABLE_MMAP 0
+#endif
+
+#if STL_EXPANDABLE_MMAP && defined(__linux__)
+#define STL_EXPANDABLE_MREMAP 1
+#else
+#define STL_EXPANDABLE_MREMAP 0
+#endif
+
+// Allocator whose blocks can grow in place, for `Vector<T, expandable_allocator<T>>` with a
+// trivially relocatable T (see reallocating_allocator). Blocks under kMapBytes come from malloc
+// and grow with realloc, which extends them in place when the neighbouring heap memory is free.
+// Larger blocks are anonymous mappings of their own; on Linux they grow with mremap, which moves
+// page table entries rather than bytes, so growing a 4 GB buffer copies nothing and never holds
+// old and new copies at once. Other POSIX systems map, copy and unmap; elsewhere every block
+// comes from malloc.
+template <typename T> class expandable_allocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+
+  // Blocks of at least this many bytes are mapped directly.
+  static constexpr std::size_t kMapBytes = std::size_t{1} << 20;
+
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "expandable_allocator: T is over-aligned for malloc");
+
+  expandable_allocator() noexcept = default;
+  template <typename U> expandable_allocator(const expandable_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    const std::size_t bytes = byte_size(n);
+    // malloc(0) may return null; ask for a byte so a zero-length block is still a valid one.
+    void* p = mapped(bytes) ? map(bytes) : std::malloc(bytes != 0 ? bytes : 1);
+    if (!p)
+      throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    const std::size_t bytes = n * sizeof(T);
+    if (mapped(bytes))
+      unmap(p, bytes);
+    else
+      std::free(p);
+  }
+
+  // Resizes a block from allocate(old_n) to hold new_n elements, keeping the first
+  // min(old_n, new_n) as bytes. Throws std::bad_alloc, leaving `p` intact, on failure. Shrinking
+  // to new_n == 0 frees `p` and returns a fresh zero-length block, as allocate(0) would, since
+  // realloc(p, 0) may free `p` and return null.
+  T* reallocate(T* p, std::size_t old_n, std::size_t new_n) {
+    if (new_n == 0) {
+      T* q = allocate(0);
+      deallocate(p, old_n);
+      return q;
+    }
+    const std::size_t old_bytes = old_n * sizeof(T);
+    const std::size_t new_bytes = byte_size(new_n);
+    if (!mapped(old_bytes) && !mapped(new_bytes)) {
+      void* q = std::realloc(static_cast<void*>(p), new_bytes);
+      if (!q)
+        throw std::bad_alloc();
+      return static_cast<T*>(q);
+    }
+#if STL_EXPANDABLE_MREMAP
+    if (mapped(old_bytes) && mapped(new_bytes)) {
+      void* q = ::mremap(p, page_round(old_bytes), page_round(new_bytes), MREMAP_MAYMOVE);
+      if (q == MAP_FAILED)
+        throw std::bad_alloc();
+      return static_cast<T*>(q);
+    }
+#endif
+    // Crossing between malloc and mapped blocks, or no mremap: copy once.
+    T* q = allocate(new_n);
+    std::memcpy(static_cast<void*>(q), static_cast<const void*>(p),
+                std::min(old_bytes, new_bytes));
+    deallocate(p, old_n);
+    return q;
+  }
+
+  friend bool operator==(const expandable_allocator&, const expandable_allocator&) noexcept {
+    return true;
+  }
+
+private:
+  static std::size_t byte_size(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return n * sizeof(T);
+  }
+
+  static bool mapped(std::size_t bytes) noexcept {
+    return STL_EXPANDABLE_MMAP && bytes >= kMapBytes;
+  }
+
+#if STL_EXPANDABLE_MMAP
+  static std::size_t page_round(std::size_t bytes) noexcept {
+    static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+  }
+
+  static void* map(std::size_t bytes) noexcept {
+    void* p = ::mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+  }
+
+  static void unmap(void* p, std::size_t bytes) noexcept {
+    ::munmap(p, page_round(bytes));
+  }
+#else
+  static void* map(std::size_t) noexcept {
+    return nullptr;
+  }
+  static void unmap(void*, std::size_t) noexcept {}
+#endif
+};
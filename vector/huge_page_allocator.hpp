@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "vector/vector.hpp"
+
+#if defined(__linux__)
+#define STL_HUGE_PAGES 1
+#include <sys/mman.h>
+#else
+#define STL_HUGE_PAGES 0
+#endif
+
+#if STL_HUGE_PAGES && defined(MAP_HUGETLB)
+#define STL_HUGE_PAGES_HUGETLB 1
+#else
+#define STL_HUGE_PAGES_HUGETLB 0
+#endif
+
+// Allocator for big arrays read in random order, where TLB misses dominate: `Vector<float,
+// huge_page_allocator<float>>` or `Deque<T, huge_page_allocator<T>>`. On Linux, blocks of at least
+// kHugePageBytes are anonymous mappings of whole 2 MB pages. Each first tries explicit huge pages
+// (MAP_HUGETLB), which exist only if the administrator reserved some (vm.nr_hugepages). Failing
+// that it maps 2 MB-aligned memory and asks for transparent huge pages with
+// madvise(MADV_HUGEPAGE), honoured when THP is "madvise" or "always". Smaller blocks, and every
+// block elsewhere, come from operator new.
+//
+// Nothing here writes to the pages, so each lands on the NUMA node of the thread that first
+// touches it; see first_touch_parallel.
+template <typename T> class huge_page_allocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+
+  static constexpr std::size_t kHugePageBytes = std::size_t{1} << 21;
+
+  huge_page_allocator() noexcept = default;
+  template <typename U> huge_page_allocator(const huge_page_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    const std::size_t bytes = byte_size(n);
+    if (!mapped(bytes))
+      return std::allocator<T>{}.allocate(n);
+    void* p = map(bytes);
+    if (!p)
+      throw std::bad_alloc();
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    const std::size_t bytes = n * sizeof(T);
+    if (mapped(bytes))
+      unmap(p, bytes);
+    else
+      std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(const huge_page_allocator&, const huge_page_allocator&) noexcept {
+    return true;
+  }
+
+private:
+  static std::size_t byte_size(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return n * sizeof(T);
+  }
+
+  static bool mapped(std::size_t bytes) noexcept {
+    return STL_HUGE_PAGES && bytes >= kHugePageBytes;
+  }
+
+  static std::size_t page_round(std::size_t bytes) noexcept {
+    return (bytes + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+  }
+
+#if STL_HUGE_PAGES
+  static void* map(std::size_t bytes) noexcept {
+    const std::size_t len = page_round(bytes);
+    constexpr int prot = PROT_READ | PROT_WRITE;
+#if STL_HUGE_PAGES_HUGETLB
+#ifdef MAP_HUGE_SHIFT
+    constexpr int huge_2mb = 21 << MAP_HUGE_SHIFT;
+#else
+    constexpr int huge_2mb = 0;
+#endif
+    void* huge = ::mmap(nullptr, len, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | huge_2mb,
+                        -1, 0);
+    if (huge != MAP_FAILED)
+      return huge;
+#endif
+    // Over-map by one huge page and trim both ends, so the block starts on a 2 MB boundary and
+    // every page of it can be backed by a huge page.
+    void* raw = ::mmap(nullptr, len + kHugePageBytes, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+      return nullptr;
+    const auto start = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (start + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+    const std::size_t head = aligned - start;
+    if (head != 0)
+      ::munmap(raw, head);
+    if (head != kHugePageBytes)
+      ::munmap(reinterpret_cast<void*>(aligned + len), kHugePageBytes - head);
+    void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, len, MADV_HUGEPAGE); // Advisory: without THP the block still works.
+#endif
+    return p;
+  }
+
+  static void unmap(void* p, std::size_t bytes) noexcept {
+    ::munmap(p, page_round(bytes));
+  }
+#else
+  static void* map(std::size_t) noexcept {
+    return nullptr;
+  }
+  static void unmap(void*, std::size_t) noexcept {}
+#endif
+};
+
+// The run [first, last) of elements that thread `t` of `threads` owns when first_touch_parallel
+// splits `n` elements of T. Runs are whole huge pages, apart from the last. Later parallel passes
+// that split the array the same way read memory on their own NUMA node.
+template <typename T>
+std::pair<std::size_t, std::size_t> first_touch_range(std::size_t n, std::size_t threads,
+                                                      std::size_t t) noexcept {
+  constexpr std::size_t per_page = std::max<std::size_t>(
+      huge_page_allocator<T>::kHugePageBytes / sizeof(T), 1);
+  threads = std::max<std::size_t>(threads, 1);
+  const std::size_t pages = (n + per_page - 1) / per_page;
+  const std::size_t chunk = (pages + threads - 1) / threads * per_page;
+  const std::size_t first = std::min(n, t * chunk);
+  return {first, std::min(n, first + chunk)};
+}
+
+// Constructs `data[i]` from `fill(i)` for every i < n, using up to `threads` threads (the caller
+// included), each of which fills its first_touch_range. Linux places a page on the NUMA node of
+// the thread that first writes it, so use this on storage that nothing has written yet, e.g.
+// straight after `resize_uninitialized(n)` with huge_page_allocator. `fill` is called
+// concurrently and must not throw.
+template <typename T, typename Fill>
+void first_touch_parallel(T* data, std::size_t n, std::size_t threads, Fill fill) {
+  threads = std::max<std::size_t>(threads, 1);
+  auto work = [&](std::size_t t) {
+    const auto [first, last] = first_touch_range<T>(n, threads, t);
+    for (std::size_t i = first; i < last; ++i)
+      std::construct_at(data + i, fill(i));
+  };
+
+  Vector<std::jthread> pool;
+  pool.reserve(threads - 1);
+  for (std::size_t t = 1; t < threads; ++t)
+    pool.emplace_back(work, t);
+  work(0);
+}
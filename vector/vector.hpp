@@ -4,17 +4,31 @@
 #include <initializer_list>
 #include <iterator>
 #include <iosfwd>
+#include <memory>
 #include <ostream>
 
-template <typename T> class Vector {
+#include "utility/default_init.hpp"
+#include "utility/ranges.hpp"
+#include "utility/relocate.hpp"
+
+// `Allocator` is used through std::allocator_traits and supplies storage only: elements are built
+// with std::construct_at and destroyed with std::destroy_at, never alloc_traits::construct or
+// destroy, so there is no uses-allocator construction. A pmr::polymorphic_allocator or
+// scoped_allocator_adaptor does not pass itself down to the elements. For trivially relocatable
+// T, an allocator that also provides `reallocate(p, old_n, new_n)` (see reallocating_allocator)
+// lets growth extend the buffer in place instead of allocating, copying and freeing.
+template <typename T, typename Allocator = std::allocator<T>> class Vector {
 public:
+  using value_type = T;
+  using allocator_type = Allocator;
   using iterator = T*;
   using const_iterator = const T*;
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
   // Constructors
-  Vector() noexcept;
+  Vector() noexcept(noexcept(Allocator()));
+  explicit Vector(const Allocator& alloc) noexcept;
   explicit Vector(std::size_t initial_capacity);
   Vector(std::initializer_list<T> list);
   Vector(const Vector& other);
@@ -22,13 +36,17 @@ public:
 
   // Assignment
   Vector& operator=(const Vector& other);
-  Vector& operator=(Vector&& other) noexcept;
+  Vector& operator=(Vector&& other) noexcept(
+      std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+      std::allocator_traits<Allocator>::is_always_equal::value);
 
   // Destructor
   ~Vector();
 
   void swap(Vector& other) noexcept;
 
+  allocator_type get_allocator() const noexcept;
+
   // Accessors
   T& operator[](std::size_t pos) noexcept;
   const T& operator[](std::size_t pos) const noexcept;
@@ -46,6 +64,14 @@ public:
 
   template <typename... Args> iterator emplace(const_iterator pos, Args&&... args);
 
+  // C++23 range insertion. Sized and forward ranges grow the buffer at most once and shift the
+  // tail once; contiguous ranges of trivially copyable T are copied with a single memcpy.
+  // insert_range and assign_range need `rg` not to overlap the vector; append_range may read
+  // from it.
+  template <container_compatible_range<T> R> void append_range(R&& rg);
+  template <container_compatible_range<T> R> iterator insert_range(const_iterator pos, R&& rg);
+  template <container_compatible_range<T> R> void assign_range(R&& rg);
+
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
 
@@ -68,6 +94,14 @@ public:
   void clear() noexcept;
   void reserve(std::size_t capacity);
   void resize(std::size_t size);
+  void resize(std::size_t size, default_init_t);
+  // resize(size, default_init) for trivially default-constructible T: new elements are left
+  // uninitialized, with no per-element work at all.
+  void resize_uninitialized(std::size_t size);
+  // As basic_string::resize_and_overwrite (C++23): grows the buffer to `n` elements, calls
+  // `op(data(), n)` to fill it, and keeps the first `op`'s result of them. Elements past the
+  // old size start uninitialized. For trivially default-constructible and destructible T.
+  template <typename Op> void resize_and_overwrite(std::size_t n, Op op);
   std::size_t capacity() const noexcept;
   T* data() noexcept;
   const T* data() const noexcept;
@@ -82,15 +116,27 @@ public:
   bool empty() const noexcept;
 
 private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
   void ensure_capacity_for_one_more();
-  static T* allocate(std::size_t n);
+  std::size_t next_capacity() const noexcept;
+  T* allocate(std::size_t n);
   void deallocate() noexcept;
+  void steal(Vector& other) noexcept;
 
+  [[no_unique_address]] Allocator alloc_;
   std::size_t size_, capacity_;
   T* data_;
 };
 
-template <typename T> std::ostream& operator<<(std::ostream& os, const Vector<T>& vec) {
+// Owns its elements through a plain pointer, so its bytes can move whatever T is, provided the
+// allocator's can; stateless allocators always can.
+template <typename T, typename Allocator>
+struct is_trivially_relocatable<Vector<T, Allocator>>
+    : std::bool_constant<std::is_empty_v<Allocator> || is_trivially_relocatable_v<Allocator>> {};
+
+template <typename T, typename Allocator>
+std::ostream& operator<<(std::ostream& os, const Vector<T, Allocator>& vec) {
   os << '[';
   for (std::size_t i = 0; i < vec.size(); ++i) {
     if (i != 0)
@@ -7,170 +7,236 @@
 #include <type_traits>
 #include <utility>
 
-template <typename T> Vector<T>::Vector() noexcept : size_(0), capacity_(0), data_(nullptr) {}
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector() noexcept(noexcept(Allocator())) : Vector(Allocator()) {}
 
-template <typename T> Vector<T>::Vector(std::size_t initial_capacity) : Vector() {
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector(const Allocator& alloc) noexcept
+    : alloc_(alloc), size_(0), capacity_(0), data_(nullptr) {}
+
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector(std::size_t initial_capacity) : Vector() {
   reserve(initial_capacity);
 }
 
-template <typename T> Vector<T>::Vector(std::initializer_list<T> list) : Vector(list.size()) {
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector(std::initializer_list<T> list) : Vector(list.size()) {
   for (const auto& v : list)
     emplace_back(v);
 }
 
-template <typename T> Vector<T>::Vector(const Vector& other) : Vector(other.size_) {
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector(const Vector& other)
+    : Vector(alloc_traits::select_on_container_copy_construction(other.alloc_)) {
+  reserve(other.size_);
   for (const auto& v : other)
     emplace_back(v);
 }
 
-template <typename T>
-Vector<T>::Vector(Vector&& other) noexcept
-    : size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)),
-      data_(std::exchange(other.data_, nullptr)) {}
+template <typename T, typename Allocator>
+Vector<T, Allocator>::Vector(Vector&& other) noexcept
+    : alloc_(std::move(other.alloc_)), size_(std::exchange(other.size_, 0)),
+      capacity_(std::exchange(other.capacity_, 0)), data_(std::exchange(other.data_, nullptr)) {}
 
-template <typename T> Vector<T>& Vector<T>::operator=(const Vector& other) {
+template <typename T, typename Allocator>
+Vector<T, Allocator>& Vector<T, Allocator>::operator=(const Vector& other) {
   if (this == &other)
     return *this;
-  Vector tmp(other);
-  swap(tmp);
+  // Copy into a buffer from the allocator this vector ends up with, then take it over.
+  constexpr bool propagate = alloc_traits::propagate_on_container_copy_assignment::value;
+  Vector tmp(propagate ? other.alloc_ : alloc_);
+  tmp.reserve(other.size_);
+  for (const auto& v : other)
+    tmp.emplace_back(v);
+  clear();
+  deallocate();
+  if constexpr (propagate)
+    alloc_ = other.alloc_;
+  steal(tmp);
   return *this;
 }
 
-template <typename T> Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
+template <typename T, typename Allocator>
+Vector<T, Allocator>& Vector<T, Allocator>::operator=(Vector&& other) noexcept(
+    alloc_traits::propagate_on_container_move_assignment::value ||
+    alloc_traits::is_always_equal::value) {
   if (this == &other)
     return *this;
   clear();
-  deallocate();
-  size_ = std::exchange(other.size_, 0);
-  capacity_ = std::exchange(other.capacity_, 0);
-  data_ = std::exchange(other.data_, nullptr);
+  constexpr bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+  if (propagate || alloc_traits::is_always_equal::value || alloc_ == other.alloc_) {
+    deallocate();
+    if constexpr (propagate)
+      alloc_ = std::move(other.alloc_);
+    steal(other);
+  } else {
+    // The buffer belongs to an allocator that cannot free it here; move the elements instead.
+    reserve(other.size_);
+    for (auto& v : other)
+      emplace_back(std::move(v));
+    other.clear();
+  }
   return *this;
 }
 
-template <typename T> Vector<T>::~Vector() {
+template <typename T, typename Allocator> Vector<T, Allocator>::~Vector() {
   clear();
   deallocate();
 }
 
-template <typename T> void Vector<T>::swap(Vector& other) noexcept {
+template <typename T, typename Allocator> void Vector<T, Allocator>::swap(Vector& other) noexcept {
   using std::swap;
+  if constexpr (alloc_traits::propagate_on_container_swap::value)
+    swap(alloc_, other.alloc_);
   swap(size_, other.size_);
   swap(capacity_, other.capacity_);
   swap(data_, other.data_);
 }
 
-template <typename T> T& Vector<T>::operator[](std::size_t pos) noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::allocator_type Vector<T, Allocator>::get_allocator() const noexcept {
+  return alloc_;
+}
+
+template <typename T, typename Allocator>
+T& Vector<T, Allocator>::operator[](std::size_t pos) noexcept {
   return data_[pos];
 }
 
-template <typename T> const T& Vector<T>::operator[](std::size_t pos) const noexcept {
+template <typename T, typename Allocator>
+const T& Vector<T, Allocator>::operator[](std::size_t pos) const noexcept {
   return data_[pos];
 }
 
-template <typename T> T& Vector<T>::at(std::size_t pos) {
+template <typename T, typename Allocator> T& Vector<T, Allocator>::at(std::size_t pos) {
   if (pos >= size_)
     throw std::out_of_range("Vector::at out of range");
   return data_[pos];
 }
 
-template <typename T> const T& Vector<T>::at(std::size_t pos) const {
+template <typename T, typename Allocator> const T& Vector<T, Allocator>::at(std::size_t pos) const {
   if (pos >= size_)
     throw std::out_of_range("Vector::at out of range");
   return data_[pos];
 }
 
-template <typename T> std::size_t Vector<T>::size() const noexcept {
+template <typename T, typename Allocator> std::size_t Vector<T, Allocator>::size() const noexcept {
   return size_;
 }
 
-template <typename T> bool Vector<T>::empty() const noexcept {
+template <typename T, typename Allocator> bool Vector<T, Allocator>::empty() const noexcept {
   return size_ == 0;
 }
 
-template <typename T> std::size_t Vector<T>::capacity() const noexcept {
+template <typename T, typename Allocator>
+std::size_t Vector<T, Allocator>::capacity() const noexcept {
   return capacity_;
 }
 
-template <typename T> T* Vector<T>::data() noexcept {
+template <typename T, typename Allocator> T* Vector<T, Allocator>::data() noexcept {
   return data_;
 }
 
-template <typename T> const T* Vector<T>::data() const noexcept {
+template <typename T, typename Allocator> const T* Vector<T, Allocator>::data() const noexcept {
   return data_;
 }
 
-template <typename T> typename Vector<T>::iterator Vector<T>::begin() noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::iterator Vector<T, Allocator>::begin() noexcept {
   return data_;
 }
 
-template <typename T> typename Vector<T>::const_iterator Vector<T>::begin() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_iterator Vector<T, Allocator>::begin() const noexcept {
   return data_;
 }
 
-template <typename T> typename Vector<T>::const_iterator Vector<T>::cbegin() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_iterator Vector<T, Allocator>::cbegin() const noexcept {
   return data_;
 }
 
-template <typename T> typename Vector<T>::iterator Vector<T>::end() noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::iterator Vector<T, Allocator>::end() noexcept {
   return data_ + size_;
 }
 
-template <typename T> typename Vector<T>::const_iterator Vector<T>::end() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_iterator Vector<T, Allocator>::end() const noexcept {
   return data_ + size_;
 }
 
-template <typename T> typename Vector<T>::const_iterator Vector<T>::cend() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_iterator Vector<T, Allocator>::cend() const noexcept {
   return data_ + size_;
 }
 
-template <typename T> typename Vector<T>::reverse_iterator Vector<T>::rbegin() noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::reverse_iterator Vector<T, Allocator>::rbegin() noexcept {
   return reverse_iterator(end());
 }
 
-template <typename T>
-typename Vector<T>::const_reverse_iterator Vector<T>::rbegin() const noexcept {
+template <typename T, typename Allocator>
+typename
+Vector<T, Allocator>::const_reverse_iterator Vector<T, Allocator>::rbegin() const noexcept {
   return const_reverse_iterator(end());
 }
 
-template <typename T>
-typename Vector<T>::const_reverse_iterator Vector<T>::crbegin() const noexcept {
+template <typename T, typename Allocator>
+typename
+Vector<T, Allocator>::const_reverse_iterator Vector<T, Allocator>::crbegin() const noexcept {
   return const_reverse_iterator(end());
 }
 
-template <typename T> typename Vector<T>::reverse_iterator Vector<T>::rend() noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::reverse_iterator Vector<T, Allocator>::rend() noexcept {
   return reverse_iterator(begin());
 }
 
-template <typename T> typename Vector<T>::const_reverse_iterator Vector<T>::rend() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_reverse_iterator Vector<T, Allocator>::rend() const noexcept {
   return const_reverse_iterator(begin());
 }
 
-template <typename T> typename Vector<T>::const_reverse_iterator Vector<T>::crend() const noexcept {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::const_reverse_iterator Vector<T, Allocator>::crend() const noexcept {
   return const_reverse_iterator(begin());
 }
 
-template <typename T> void Vector<T>::clear() noexcept {
+template <typename T, typename Allocator> void Vector<T, Allocator>::clear() noexcept {
   std::destroy_n(data_, size_);
   size_ = 0;
 }
 
-template <typename T> void Vector<T>::reserve(std::size_t new_capacity) {
+template <typename T, typename Allocator>
+void Vector<T, Allocator>::reserve(std::size_t new_capacity) {
   if (new_capacity <= capacity_)
     return;
 
+  if constexpr (is_trivially_relocatable_v<T> && reallocating_allocator<Allocator, T>) {
+    // The allocator may extend the block in place; otherwise it moves the bytes itself.
+    data_ = data_ ? alloc_.reallocate(data_, capacity_, new_capacity) : allocate(new_capacity);
+    capacity_ = new_capacity;
+    return;
+  }
+
   T* new_data = allocate(new_capacity);
-  if constexpr (std::is_nothrow_move_constructible_v<T>) {
-    std::uninitialized_move_n(data_, size_, new_data);
+  if constexpr (is_trivially_relocatable_v<T>) {
+    trivially_relocate(data_, data_ + size_, new_data);
   } else {
-    std::uninitialized_copy_n(data_, size_, new_data);
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_move_n(data_, size_, new_data);
+    } else {
+      std::uninitialized_copy_n(data_, size_, new_data);
+    }
+    std::destroy_n(data_, size_);
   }
-  std::destroy_n(data_, size_);
   deallocate();
   data_ = new_data;
   capacity_ = new_capacity;
 }
 
-template <typename T> void Vector<T>::resize(std::size_t new_size) {
+template <typename T, typename Allocator> void Vector<T, Allocator>::resize(std::size_t new_size) {
   if (new_size < size_) {
     std::destroy_n(data_ + new_size, size_ - new_size);
     size_ = new_size;
@@ -189,46 +255,77 @@ template <typename T> void Vector<T>::resize(std::size_t new_size) {
   }
 }
 
-template <typename T> T& Vector<T>::front() {
+template <typename T, typename Allocator>
+void Vector<T, Allocator>::resize(std::size_t new_size, default_init_t) {
+  if (new_size <= size_) {
+    resize(new_size);
+    return;
+  }
+  reserve(new_size);
+  std::uninitialized_default_construct(data_ + size_, data_ + new_size);
+  size_ = new_size;
+}
+
+template <typename T, typename Allocator>
+void Vector<T, Allocator>::resize_uninitialized(std::size_t new_size) {
+  static_assert(std::is_trivially_default_constructible_v<T>,
+                "Vector::resize_uninitialized requires trivially default constructible T");
+  resize(new_size, default_init);
+}
+
+template <typename T, typename Allocator>
+template <typename Op>
+void Vector<T, Allocator>::resize_and_overwrite(std::size_t n, Op op) {
+  static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                "Vector::resize_and_overwrite requires trivial T");
+  reserve(n);
+  const auto kept = static_cast<std::size_t>(std::move(op)(data_, n));
+  if (kept > n)
+    throw std::length_error("Vector::resize_and_overwrite: op kept more than n elements");
+  size_ = kept;
+}
+
+template <typename T, typename Allocator> T& Vector<T, Allocator>::front() {
   if (empty())
     throw std::out_of_range("Vector::front on empty");
   return data_[0];
 }
 
-template <typename T> const T& Vector<T>::front() const {
+template <typename T, typename Allocator> const T& Vector<T, Allocator>::front() const {
   if (empty())
     throw std::out_of_range("Vector::front on empty");
   return data_[0];
 }
 
-template <typename T> T& Vector<T>::back() {
+template <typename T, typename Allocator> T& Vector<T, Allocator>::back() {
   if (empty())
     throw std::out_of_range("Vector::back on empty");
   return data_[size_ - 1];
 }
 
-template <typename T> const T& Vector<T>::back() const {
+template <typename T, typename Allocator> const T& Vector<T, Allocator>::back() const {
   if (empty())
     throw std::out_of_range("Vector::back on empty");
   return data_[size_ - 1];
 }
 
-template <typename T> void Vector<T>::pop_back() {
+template <typename T, typename Allocator> void Vector<T, Allocator>::pop_back() {
   if (empty())
     throw std::out_of_range("Vector::pop_back on empty");
   std::destroy_at(data_ + (size_ - 1));
   --size_;
 }
 
-template <typename T> void Vector<T>::push_back(const T& element) {
+template <typename T, typename Allocator> void Vector<T, Allocator>::push_back(const T& element) {
   emplace_back(element);
 }
 
-template <typename T> void Vector<T>::push_back(T&& element) {
+template <typename T, typename Allocator> void Vector<T, Allocator>::push_back(T&& element) {
   emplace_back(std::move(element));
 }
 
-template <typename T> template <typename... Args> T& Vector<T>::emplace_back(Args&&... args) {
+template <typename T, typename Allocator>
+template <typename... Args> T& Vector<T, Allocator>::emplace_back(Args&&... args) {
   ensure_capacity_for_one_more();
   T* slot = data_ + size_;
   std::construct_at(slot, std::forward<Args>(args)...);
@@ -236,19 +333,22 @@ template <typename T> template <typename... Args> T& Vector<T>::emplace_back(Arg
   return *slot;
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::insert(const_iterator pos, const T& value) {
+template <typename T, typename Allocator>
+typename
+Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_iterator pos, const T& value) {
   return emplace(pos, value);
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::insert(const_iterator pos, T&& value) {
+template <typename T, typename Allocator>
+typename
+Vector<T, Allocator>::iterator Vector<T, Allocator>::insert(const_iterator pos, T&& value) {
   return emplace(pos, std::move(value));
 }
 
-template <typename T>
+template <typename T, typename Allocator>
 template <typename... Args>
-typename Vector<T>::iterator Vector<T>::emplace(const_iterator pos, Args&&... args) {
+typename
+Vector<T, Allocator>::iterator Vector<T, Allocator>::emplace(const_iterator pos, Args&&... args) {
   const std::size_t index = static_cast<std::size_t>(pos - cbegin());
   if (index > size_)
     throw std::out_of_range("Vector::emplace position out of range");
@@ -258,7 +358,39 @@ typename Vector<T>::iterator Vector<T>::emplace(const_iterator pos, Args&&... ar
     return data_ + index;
   }
 
-  if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    // The new element is built before anything moves, since `args` may refer into the buffer.
+    if (size_ == capacity_ && !reallocating_allocator<Allocator, T>) {
+      const std::size_t new_capacity = next_capacity();
+      T* new_data = allocate(new_capacity);
+      try {
+        std::construct_at(new_data + index, std::forward<Args>(args)...);
+      } catch (...) {
+        alloc_traits::deallocate(alloc_, new_data, new_capacity);
+        throw;
+      }
+      trivially_relocate(data_, data_ + index, new_data);
+      trivially_relocate(data_ + index, data_ + size_, new_data + index + 1);
+      deallocate();
+      data_ = new_data;
+      capacity_ = new_capacity;
+    } else {
+      alignas(T) std::byte staged[sizeof(T)];
+      T* value = std::construct_at(reinterpret_cast<T*>(staged), std::forward<Args>(args)...);
+      if (size_ == capacity_) {
+        try {
+          reserve(next_capacity());
+        } catch (...) {
+          std::destroy_at(value);
+          throw;
+        }
+      }
+      trivially_relocate(data_ + index, data_ + size_, data_ + index + 1);
+      trivially_relocate(value, value + 1, data_ + index);
+    }
+    ++size_;
+    return data_ + index;
+  } else if constexpr (std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>) {
     ensure_capacity_for_one_more();
     const std::size_t old_size = size_;
     if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
@@ -280,13 +412,7 @@ typename Vector<T>::iterator Vector<T>::emplace(const_iterator pos, Args&&... ar
     ++size_;
     return data_ + index;
   } else {
-    const std::size_t required = size_ + 1;
-    std::size_t new_capacity = capacity_;
-    if (new_capacity < required) {
-      new_capacity = capacity_ == 0 ? 1 : (capacity_ == 1 ? 2 : (capacity_ + (capacity_ >> 1)));
-      if (new_capacity < required)
-        new_capacity = required;
-    }
+    const std::size_t new_capacity = size_ < capacity_ ? capacity_ : next_capacity();
 
     T* new_data = allocate(new_capacity);
     std::size_t constructed = 0;
@@ -309,7 +435,7 @@ typename Vector<T>::iterator Vector<T>::emplace(const_iterator pos, Args&&... ar
       constructed += (size_ - index);
     } catch (...) {
       std::destroy_n(new_data, constructed);
-      std::allocator<T>{}.deallocate(new_data, new_capacity);
+      alloc_traits::deallocate(alloc_, new_data, new_capacity);
       throw;
     }
 
@@ -322,15 +448,120 @@ typename Vector<T>::iterator Vector<T>::emplace(const_iterator pos, Args&&... ar
   }
 }
 
-template <typename T> typename Vector<T>::iterator Vector<T>::erase(const_iterator pos) {
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+void Vector<T, Allocator>::append_range(R&& rg) {
+  insert_range(cend(), std::forward<R>(rg));
+}
+
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+typename Vector<T, Allocator>::iterator Vector<T, Allocator>::insert_range(const_iterator pos,
+                                                                           R&& rg) {
+  const std::size_t index = static_cast<std::size_t>(pos - cbegin());
+  if (index > size_)
+    throw std::out_of_range("Vector::insert_range position out of range");
+
+  if constexpr (!sized_or_forward_range<R>) {
+    // The length is unknown until the range is consumed: append directly, or stage the elements
+    // and insert them as a sized range so the tail still moves only once.
+    if (index == size_) {
+      for (auto&& v : rg)
+        emplace_back(std::forward<decltype(v)>(v));
+      return data_ + index;
+    }
+    Vector staged(alloc_);
+    for (auto&& v : rg)
+      staged.emplace_back(std::forward<decltype(v)>(v));
+    return insert_range(pos, std::ranges::subrange(std::make_move_iterator(staged.begin()),
+                                                   std::make_move_iterator(staged.end())));
+  } else {
+    const std::size_t n = range_length(rg);
+    if (n == 0)
+      return data_ + index;
+
+    // data_ is only null when capacity_ is 0; testing it spares GCC a false -Wnonnull on memmove.
+    if (data_ && n <= capacity_ - size_) {
+      if constexpr (is_trivially_relocatable_v<T>) {
+        trivially_relocate(data_ + index, data_ + size_, data_ + index + n);
+        try {
+          uninitialized_copy_range(rg, data_ + index);
+        } catch (...) {
+          trivially_relocate(data_ + index + n, data_ + size_ + n, data_ + index);
+          throw;
+        }
+        size_ += n;
+        return data_ + index;
+      } else if constexpr (std::is_move_constructible_v<T> && std::is_move_assignable_v<T>) {
+        const std::size_t old_size = size_;
+        uninitialized_copy_range(rg, data_ + size_);
+        size_ += n;
+        std::rotate(data_ + index, data_ + old_size, data_ + size_);
+        return data_ + index;
+      }
+    }
+
+    // A new buffer, with the new elements built first: append_range's `rg` may read the old one.
+    const std::size_t new_capacity =
+        n <= capacity_ - size_ ? capacity_ : std::max(next_capacity(), size_ + n);
+    T* new_data = allocate(new_capacity);
+    try {
+      uninitialized_copy_range(rg, new_data + index);
+    } catch (...) {
+      alloc_traits::deallocate(alloc_, new_data, new_capacity);
+      throw;
+    }
+    if constexpr (is_trivially_relocatable_v<T>) {
+      trivially_relocate(data_, data_ + index, new_data);
+      trivially_relocate(data_ + index, data_ + size_, new_data + index + n);
+    } else {
+      auto transfer = [](T* first, std::size_t count, T* dest) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+          std::uninitialized_move_n(first, count, dest);
+        else
+          std::uninitialized_copy_n(first, count, dest);
+      };
+      try {
+        transfer(data_, index, new_data);
+        try {
+          transfer(data_ + index, size_ - index, new_data + index + n);
+        } catch (...) {
+          std::destroy_n(new_data, index);
+          throw;
+        }
+      } catch (...) {
+        std::destroy_n(new_data + index, n);
+        alloc_traits::deallocate(alloc_, new_data, new_capacity);
+        throw;
+      }
+      std::destroy_n(data_, size_);
+    }
+    deallocate();
+    data_ = new_data;
+    capacity_ = new_capacity;
+    size_ += n;
+    return data_ + index;
+  }
+}
+
+template <typename T, typename Allocator>
+template <container_compatible_range<T> R>
+void Vector<T, Allocator>::assign_range(R&& rg) {
+  clear();
+  append_range(std::forward<R>(rg));
+}
+
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::iterator Vector<T, Allocator>::erase(const_iterator pos) {
   const std::size_t index = static_cast<std::size_t>(pos - cbegin());
   if (index >= size_)
     throw std::out_of_range("Vector::erase position out of range");
   return erase(cbegin() + index, cbegin() + index + 1);
 }
 
-template <typename T>
-typename Vector<T>::iterator Vector<T>::erase(const_iterator first, const_iterator last) {
+template <typename T, typename Allocator>
+typename Vector<T, Allocator>::iterator
+Vector<T, Allocator>::erase(const_iterator first, const_iterator last) {
   const std::size_t first_index = static_cast<std::size_t>(first - cbegin());
   const std::size_t last_index = static_cast<std::size_t>(last - cbegin());
   if (first_index > last_index)
@@ -343,7 +574,12 @@ typename Vector<T>::iterator Vector<T>::erase(const_iterator first, const_iterat
     return data_ + first_index;
 
   constexpr bool can_shift_in_place = std::is_move_assignable_v<T> || std::is_copy_assignable_v<T>;
-  if constexpr (can_shift_in_place) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    std::destroy_n(data_ + first_index, count);
+    trivially_relocate(data_ + last_index, data_ + size_, data_ + first_index);
+    size_ -= count;
+    return data_ + first_index;
+  } else if constexpr (can_shift_in_place) {
     if constexpr (std::is_nothrow_move_assignable_v<T> || !std::is_copy_assignable_v<T>) {
       std::move(data_ + last_index, data_ + size_, data_ + first_index);
     } else {
@@ -372,7 +608,7 @@ typename Vector<T>::iterator Vector<T>::erase(const_iterator first, const_iterat
       constructed += (size_ - last_index);
     } catch (...) {
       std::destroy_n(new_data, constructed);
-      std::allocator<T>{}.deallocate(new_data, capacity_);
+      alloc_traits::deallocate(alloc_, new_data, capacity_);
       throw;
     }
 
@@ -384,22 +620,32 @@ typename Vector<T>::iterator Vector<T>::erase(const_iterator first, const_iterat
   }
 }
 
-template <typename T> void Vector<T>::ensure_capacity_for_one_more() {
+template <typename T, typename Allocator>
+void Vector<T, Allocator>::ensure_capacity_for_one_more() {
   if (size_ < capacity_)
     return;
-  const std::size_t next =
-      capacity_ == 0 ? 1 : (capacity_ == 1 ? 2 : (capacity_ + (capacity_ >> 1)));
-  reserve(next);
+  reserve(next_capacity());
 }
 
-template <typename T> T* Vector<T>::allocate(std::size_t n) {
-  return std::allocator<T>{}.allocate(n);
+template <typename T, typename Allocator>
+std::size_t Vector<T, Allocator>::next_capacity() const noexcept {
+  return capacity_ == 0 ? 1 : (capacity_ == 1 ? 2 : (capacity_ + (capacity_ >> 1)));
 }
 
-template <typename T> void Vector<T>::deallocate() noexcept {
+template <typename T, typename Allocator> T* Vector<T, Allocator>::allocate(std::size_t n) {
+  return alloc_traits::allocate(alloc_, n);
+}
+
+template <typename T, typename Allocator> void Vector<T, Allocator>::deallocate() noexcept {
   if (!data_)
     return;
-  std::allocator<T>{}.deallocate(data_, capacity_);
+  alloc_traits::deallocate(alloc_, data_, capacity_);
   data_ = nullptr;
   capacity_ = 0;
 }
+
+template <typename T, typename Allocator> void Vector<T, Allocator>::steal(Vector& other) noexcept {
+  size_ = std::exchange(other.size_, 0);
+  capacity_ = std::exchange(other.capacity_, 0);
+  data_ = std::exchange(other.data_, nullptr);
+}